@@ -0,0 +1,350 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "benchmarkHarness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <unordered_map>
+
+static std::atomic<unsigned long long> allocationCount(0);
+static std::atomic<unsigned long long> allocatedBytes(0);
+
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+AllocationCounters AllocationCounters::now() {
+    return {allocationCount.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+BenchmarkState::BenchmarkState(double minTime) : minTime(minTime) {}
+
+void BenchmarkState::stopCounters() {
+    elapsed += Clock::now() - start;
+    AllocationCounters current = AllocationCounters::now();
+    allocations.allocations += current.allocations - allocationsStart.allocations;
+    allocations.bytes += current.bytes - allocationsStart.bytes;
+}
+
+/**
+ * Starts the timed loop on the first call, and on every other call counts the iteration that just ended
+ * @return True if the loop should run another iteration, false once the minimum time has elapsed
+ */
+bool BenchmarkState::keepRunning() {
+    if (!skipped.empty()) return false;
+    if (!started) {
+        started = true;
+        allocationsStart = AllocationCounters::now();
+        start = Clock::now();
+        return true;
+    }
+    iterations++;
+    if (paused) resumeTiming();
+    if (elapsed + (Clock::now() - start) < minTime) return true;
+    stopCounters();
+    return false;
+}
+
+/**
+ * Stops measuring time and allocations until resumeTiming is called, for setup done inside the timed loop
+ */
+void BenchmarkState::pauseTiming() {
+    if (paused || !started) return;
+    stopCounters();
+    paused = true;
+}
+
+void BenchmarkState::resumeTiming() {
+    if (!paused) return;
+    paused = false;
+    allocationsStart = AllocationCounters::now();
+    start = Clock::now();
+}
+
+/**
+ * Reports how many items (queries, rows, ...) the whole timed loop processed, to compute the throughput
+ * @param itemsProcessed - Total number of items, over every iteration
+ */
+void BenchmarkState::setItemsProcessed(unsigned long long itemsProcessed) {
+    items = itemsProcessed;
+}
+
+/**
+ * Marks the benchmark as not applicable, for instance because its input would make it run for too long
+ * @param reason - Reason shown in the report
+ */
+void BenchmarkState::skip(const std::string &reason) {
+    skipped = reason;
+}
+
+BenchmarkResult BenchmarkState::result(const std::string &name) const {
+    BenchmarkResult result;
+    result.name = name;
+    result.skipped = skipped;
+    result.iterations = iterations;
+    if (!skipped.empty() || iterations == 0) return result;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    result.nanosecondsPerIteration = seconds * 1e9 / (double) iterations;
+    result.itemsPerSecond = items == 0 || seconds == 0 ? 0 : (double) items / seconds;
+    result.allocationsPerIteration = (double) allocations.allocations / (double) iterations;
+    result.bytesPerIteration = (double) allocations.bytes / (double) iterations;
+    return result;
+}
+
+void BenchmarkRunner::add(const std::string &name, std::function<void(BenchmarkState &)> body) {
+    benchmarks.push_back({name, std::move(body)});
+}
+
+/**
+ * Runs, in registration order, every benchmark whose name contains the filter
+ * @param filter - Substring the names must contain, empty to run every benchmark
+ * @param minTime - Minimum time of each benchmark's timed loop, in seconds
+ * @param progress - Stream where the name of each benchmark is written as it starts
+ * @return Vector with the result of each benchmark run
+ */
+std::vector<BenchmarkResult> BenchmarkRunner::run(const std::string &filter, double minTime, std::ostream &progress) {
+    std::vector<BenchmarkResult> results;
+    for (const Benchmark &benchmark: benchmarks) {
+        if (benchmark.name.find(filter) == std::string::npos) continue;
+        progress << benchmark.name << std::endl;
+        BenchmarkState state(minTime);
+        benchmark.body(state);
+        results.push_back(state.result(benchmark.name));
+    }
+    return results;
+}
+
+/**
+ * Runs, in registration order, the benchmarks that have a baseline
+ * @param baseline - Results of the baseline, whose names select the benchmarks
+ * @param minTime - Minimum time of each benchmark's timed loop, in seconds
+ * @param progress - Stream where the name of each benchmark is written as it starts
+ * @return Vector with the result of each benchmark run
+ */
+std::vector<BenchmarkResult> BenchmarkRunner::run(const std::vector<BenchmarkResult> &baseline, double minTime,
+                                                  std::ostream &progress) {
+    std::vector<BenchmarkResult> results;
+    for (const Benchmark &benchmark: benchmarks) {
+        auto inBaseline = [&benchmark](const BenchmarkResult &result) { return result.name == benchmark.name; };
+        if (std::none_of(baseline.begin(), baseline.end(), inBaseline)) continue;
+        progress << benchmark.name << std::endl;
+        BenchmarkState state(minTime);
+        benchmark.body(state);
+        results.push_back(state.result(benchmark.name));
+    }
+    return results;
+}
+
+/**
+ * Runs again the benchmarks that are slower than their baseline beyond the latency tolerance, keeping the fastest of
+ * their runs, so that a transient slowdown of the machine isn't taken for a regression. Their allocations don't depend
+ * on the machine, so they aren't retried for those
+ * @param results - Results of the first run, updated with the faster ones
+ * @param baseline - Results the benchmarks are compared with
+ * @param tolerance - Tolerated slowdown
+ * @param minTime - Minimum time of each benchmark's timed loop, in seconds
+ * @param attempts - Largest number of times a benchmark is run again
+ * @param progress - Stream where the name of each benchmark is written as it starts
+ */
+void BenchmarkRunner::retrySlower(std::vector<BenchmarkResult> &results, const std::vector<BenchmarkResult> &baseline,
+                                  const RegressionTolerance &tolerance, double minTime, unsigned int attempts,
+                                  std::ostream &progress) {
+    std::unordered_map<std::string, const BenchmarkResult *> expected;
+    for (const BenchmarkResult &result: baseline) expected[result.name] = &result;
+    for (unsigned int attempt = 0; attempt < attempts; attempt++) {
+        std::vector<BenchmarkResult> slowerResults;
+        for (const BenchmarkResult &result: results) {
+            auto it = expected.find(result.name);
+            if (it != expected.end() && tolerance.slower(result, *it->second)) slowerResults.push_back(result);
+        }
+        if (slowerResults.empty()) return;
+        progress << "Retrying " << slowerResults.size() << " benchmark(s) slower than their baseline" << std::endl;
+        for (const BenchmarkResult &retried: run(slowerResults, minTime, progress)) {
+            if (!retried.skipped.empty()) continue;
+            for (BenchmarkResult &result: results)
+                if (result.name == retried.name && retried.nanosecondsPerIteration < result.nanosecondsPerIteration)
+                    result = retried;
+        }
+    }
+}
+
+static std::string humanTime(double nanoseconds) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1);
+    if (nanoseconds < 1e3) text << nanoseconds << " ns";
+    else if (nanoseconds < 1e6) text << nanoseconds / 1e3 << " us";
+    else if (nanoseconds < 1e9) text << nanoseconds / 1e6 << " ms";
+    else text << nanoseconds / 1e9 << " s";
+    return text.str();
+}
+
+void BenchmarkRunner::printTable(const std::vector<BenchmarkResult> &results, std::ostream &out) {
+    size_t nameWidth = 9;
+    for (const BenchmarkResult &result: results) nameWidth = std::max(nameWidth, result.name.size());
+    out << std::left << std::setw((int) nameWidth + 2) << "Benchmark" << std::right << std::setw(12) << "Time"
+        << std::setw(12) << "Iterations" << std::setw(14) << "Items/s" << std::setw(14) << "Allocs/iter"
+        << std::setw(14) << "Bytes/iter" << std::endl;
+    out << std::string(nameWidth + 2 + 12 + 12 + 14 + 14 + 14, '-') << std::endl;
+    for (const BenchmarkResult &result: results) {
+        out << std::left << std::setw((int) nameWidth + 2) << result.name << std::right;
+        if (!result.skipped.empty()) {
+            out << "skipped: " << result.skipped << std::endl;
+            continue;
+        }
+        out << std::setw(12) << humanTime(result.nanosecondsPerIteration) << std::setw(12) << result.iterations
+            << std::fixed << std::setprecision(0) << std::setw(14) << result.itemsPerSecond << std::setw(14)
+            << result.allocationsPerIteration << std::setw(14) << result.bytesPerIteration << std::defaultfloat
+            << std::endl;
+    }
+}
+
+void BenchmarkRunner::printCsv(const std::vector<BenchmarkResult> &results, std::ostream &out) {
+    out << "name,iterations,ns_per_iteration,items_per_second,allocations_per_iteration,bytes_per_iteration,skipped"
+        << std::endl;
+    for (const BenchmarkResult &result: results) {
+        out << result.name << ',' << result.iterations << ',' << std::fixed << std::setprecision(1)
+            << result.nanosecondsPerIteration << ',' << result.itemsPerSecond << ',' << result.allocationsPerIteration
+            << ',' << result.bytesPerIteration << std::defaultfloat << ',' << result.skipped << std::endl;
+    }
+}
+
+/**
+ * Reads results in the format written by printCsv
+ * @param in - Stream with the CSV, header included
+ * @param results - Vector where the results are appended
+ * @return True if every line was valid, false otherwise
+ */
+bool BenchmarkRunner::readCsv(std::istream &in, std::vector<BenchmarkResult> &results) {
+    std::string line;
+    if (!std::getline(in, line)) return false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        std::vector<std::string> fields;
+        size_t start = 0;
+        for (int i = 0; i < 6; i++) { //The skip reason, last, may contain commas
+            size_t end = line.find(',', start);
+            if (end == std::string::npos) return false;
+            fields.push_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+        BenchmarkResult result;
+        result.name = fields[0];
+        result.skipped = line.substr(start);
+        if (!parseNumber(fields[1], result.iterations) || !parseNumber(fields[2], result.nanosecondsPerIteration) ||
+            !parseNumber(fields[3], result.itemsPerSecond) || !parseNumber(fields[4], result.allocationsPerIteration) ||
+            !parseNumber(fields[5], result.bytesPerIteration))
+            return false;
+        results.push_back(result);
+    }
+    return true;
+}
+
+/**
+ * Checks if a result is slower than its baseline beyond the latency tolerance
+ * @param result - Result of the current build
+ * @param baseline - Result it is compared with
+ * @return True if both ran and the result is too slow, false otherwise
+ */
+bool RegressionTolerance::slower(const BenchmarkResult &result, const BenchmarkResult &baseline) const {
+    if (!result.skipped.empty() || !baseline.skipped.empty()) return false;
+    return result.nanosecondsPerIteration > baseline.nanosecondsPerIteration * (1 + latency);
+}
+
+/**
+ * Compares results with their baseline, printing a line per benchmark. A benchmark regresses if it is slower than its
+ * baseline by more than the latency tolerance, or if it allocates more (blocks or bytes, per iteration) by more than
+ * the allocation tolerance. Benchmarks of the baseline that didn't run, or that were skipped while their baseline
+ * wasn't, count as regressions too
+ * Time Complexity: O(n + m), n and m being the number of results and of baselines
+ * @param results - Results of the current build
+ * @param baseline - Results the current build is compared with
+ * @param tolerance - Tolerated slowdown and growth of allocations
+ * @param out - Stream where the comparison is written
+ * @return True if no benchmark regressed, false otherwise
+ */
+bool BenchmarkRunner::compare(const std::vector<BenchmarkResult> &results, const std::vector<BenchmarkResult> &baseline,
+                              const RegressionTolerance &tolerance, std::ostream &out) {
+    std::unordered_map<std::string, const BenchmarkResult *> current;
+    for (const BenchmarkResult &result: results) current[result.name] = &result;
+    size_t nameWidth = 9;
+    for (const BenchmarkResult &expected: baseline) nameWidth = std::max(nameWidth, expected.name.size());
+
+    out << std::left << std::setw((int) nameWidth + 2) << "Benchmark" << std::right << std::setw(12) << "Baseline"
+        << std::setw(12) << "Time" << std::setw(9) << "Change" << std::setw(14) << "Allocs/iter" << std::setw(9)
+        << "Change" << "  Status" << std::endl;
+    unsigned int regressions = 0;
+    for (const BenchmarkResult &expected: baseline) {
+        out << std::left << std::setw((int) nameWidth + 2) << expected.name << std::right;
+        auto it = current.find(expected.name);
+        if (it == current.end() || (!it->second->skipped.empty() && expected.skipped.empty())) {
+            out << "  REGRESSION: " << (it == current.end() ? "didn't run" : "skipped: " + it->second->skipped)
+                << std::endl;
+            regressions++;
+            continue;
+        }
+        const BenchmarkResult &result = *it->second;
+        if (!expected.skipped.empty()) {
+            out << "  skipped in the baseline" << std::endl;
+            continue;
+        }
+
+        auto change = [](double now, double before) {
+            std::ostringstream text;
+            text << std::showpos << std::fixed << std::setprecision(1);
+            if (before > 0) text << (now / before - 1) * 100 << '%';
+            else text << (now > 0 ? "+inf" : "+0.0%");
+            return text.str();
+        };
+        //Small absolute slack, so that a baseline of 0 allocations doesn't fail on rounding
+        bool slower = tolerance.slower(result, expected);
+        bool moreAllocations =
+                result.allocationsPerIteration > expected.allocationsPerIteration * (1 + tolerance.allocations) + 0.5 ||
+                result.bytesPerIteration > expected.bytesPerIteration * (1 + tolerance.allocations) + 64;
+        out << std::setw(12) << humanTime(expected.nanosecondsPerIteration) << std::setw(12)
+            << humanTime(result.nanosecondsPerIteration) << std::setw(9)
+            << change(result.nanosecondsPerIteration, expected.nanosecondsPerIteration) << std::setw(14)
+            << std::fixed << std::setprecision(1) << result.allocationsPerIteration << std::defaultfloat << std::setw(9)
+            << change(result.allocationsPerIteration, expected.allocationsPerIteration) << "  ";
+        if (slower || moreAllocations) {
+            out << "REGRESSION:" << (slower ? " latency" : "") << (moreAllocations ? " allocations" : "");
+            regressions++;
+        } else {
+            out << "ok";
+        }
+        out << std::endl;
+    }
+    out << regressions << " regression(s) in " << baseline.size() << " benchmark(s), tolerating " << std::fixed
+        << std::setprecision(0) << tolerance.latency * 100 << "% in latency and " << tolerance.allocations * 100
+        << "% in allocations" << std::defaultfloat << std::endl;
+    return regressions == 0;
+}
@@ -0,0 +1,138 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_BENCHMARKHARNESS_H
+#define RAILWAYMANAGEMENT_BENCHMARKHARNESS_H
+
+#include <charconv>
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Parses a number from the whole of a text, such as a command line value or a CSV field
+ * @param text - Text to parse
+ * @param number - Set to the parsed number
+ * @return True if the whole text is a number of the type, false otherwise
+ */
+template<typename T>
+bool parseNumber(std::string_view text, T &number) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    return !text.empty() && error == std::errc() && end == text.data() + text.size();
+}
+
+/**
+ * Number of heap allocations and of bytes allocated by the whole process so far, counted by the replacement global
+ * operator new of the benchmark executable
+ */
+struct AllocationCounters {
+    unsigned long long allocations = 0;
+    unsigned long long bytes = 0;
+
+    static AllocationCounters now();
+};
+
+/**
+ * Measurement of a benchmark, per iteration of its timed loop
+ */
+struct BenchmarkResult {
+    std::string name;
+    unsigned long long iterations = 0;
+    double nanosecondsPerIteration = 0;
+    double itemsPerSecond = 0; // 0 if the benchmark doesn't report items
+    double allocationsPerIteration = 0;
+    double bytesPerIteration = 0;
+    std::string skipped; // reason why the benchmark didn't run, empty if it ran
+};
+
+/**
+ * Largest slowdown and largest growth of allocations (in number and in bytes) per iteration that a benchmark may show
+ * against its baseline before it counts as a regression, as fractions of the baseline
+ */
+struct RegressionTolerance {
+    double latency = 0.25;
+    double allocations = 0.05;
+
+    bool slower(const BenchmarkResult &result, const BenchmarkResult &baseline) const;
+};
+
+/**
+ * Controls the timed loop of a benchmark, in the spirit of Google Benchmark:
+ *   while (state.keepRunning()) { ...code being measured... }
+ * The loop runs at least once and until the minimum time has elapsed. Everything before the loop is setup and isn't
+ * measured, and pauseTiming/resumeTiming exclude per-iteration setup. Time and allocations are measured together
+ */
+class BenchmarkState {
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    std::chrono::duration<double> minTime;
+    unsigned long long iterations = 0;
+    unsigned long long items = 0;
+    bool started = false;
+    bool paused = false;
+    Clock::time_point start;
+    Clock::duration elapsed{0};
+    AllocationCounters allocationsStart;
+    AllocationCounters allocations;
+    std::string skipped;
+
+    void stopCounters();
+
+  public:
+    explicit BenchmarkState(double minTime);
+
+    bool keepRunning();
+
+    void pauseTiming();
+
+    void resumeTiming();
+
+    void setItemsProcessed(unsigned long long itemsProcessed);
+
+    void skip(const std::string &reason);
+
+    [[nodiscard]] BenchmarkResult result(const std::string &name) const;
+};
+
+/**
+ * Registry and runner of the benchmarks of an executable
+ */
+class BenchmarkRunner {
+  private:
+    struct Benchmark {
+        std::string name;
+        std::function<void(BenchmarkState &)> body;
+    };
+
+    std::vector<Benchmark> benchmarks;
+
+  public:
+    void add(const std::string &name, std::function<void(BenchmarkState &)> body);
+
+    std::vector<BenchmarkResult> run(const std::string &filter, double minTime, std::ostream &progress);
+
+    std::vector<BenchmarkResult> run(const std::vector<BenchmarkResult> &baseline, double minTime,
+                                     std::ostream &progress);
+
+    void retrySlower(std::vector<BenchmarkResult> &results, const std::vector<BenchmarkResult> &baseline,
+                     const RegressionTolerance &tolerance, double minTime, unsigned int attempts,
+                     std::ostream &progress);
+
+    static void printTable(const std::vector<BenchmarkResult> &results, std::ostream &out);
+
+    static void printCsv(const std::vector<BenchmarkResult> &results, std::ostream &out);
+
+    static bool readCsv(std::istream &in, std::vector<BenchmarkResult> &results);
+
+    static bool compare(const std::vector<BenchmarkResult> &results, const std::vector<BenchmarkResult> &baseline,
+                        const RegressionTolerance &tolerance, std::ostream &out);
+};
+
+
+#endif //RAILWAYMANAGEMENT_BENCHMARKHARNESS_H
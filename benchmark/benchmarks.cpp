@@ -0,0 +1,393 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "benchmarkHarness.h"
+#include "railwayManagement.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+/**
+ * A network the benchmarks run on, loaded on first use and shared by all of them
+ */
+struct Fixture {
+    std::string name;
+    std::string stationsFilePath;
+    std::string networkFilePath;
+    std::string source; // stations of the point-to-point queries
+    std::string target;
+    std::string minCostSource; // pair for min-cost queries, empty if they aren't run on this network
+    std::string minCostTarget;
+    std::unique_ptr<RailwayNetwork> network;
+
+    RailwayNetwork &get() {
+        if (network == nullptr) {
+            network = std::make_unique<RailwayNetwork>(stationsFilePath, networkFilePath);
+            network->setSnapshotFilePath("");
+            std::ostringstream report;
+            network->load(report);
+        }
+        return *network;
+    }
+
+    unsigned int numStations() {
+        return get().getGraph().getNumVertex();
+    }
+};
+
+static std::ostream &nowhere() {
+    static std::ostringstream sink;
+    sink.str("");
+    return sink;
+}
+
+/**
+ * Registers every benchmark of a network
+ * @param runner - Runner where the benchmarks are added
+ * @param fixture - Network the benchmarks run on
+ * @param maxQuadraticStations - Largest network on which benchmarks that run a max flow per station are run
+ */
+static void addBenchmarks(BenchmarkRunner &runner, Fixture &fixture, unsigned int maxQuadraticStations) {
+    const std::string prefix = fixture.name + "/";
+
+    runner.add(prefix + "load/csv", [&fixture](BenchmarkState &state) {
+        unsigned long long rows = 0;
+        while (state.keepRunning()) {
+            RailwayNetwork network(fixture.stationsFilePath, fixture.networkFilePath);
+            network.setSnapshotFilePath("");
+            network.load(nowhere());
+            rows += network.getGraph().getNumVertex() + network.getGraph().getTotalEdges();
+        }
+        state.setItemsProcessed(rows);
+    });
+
+    runner.add(prefix + "load/snapshot", [&fixture](BenchmarkState &state) {
+        std::filesystem::path snapshot = std::filesystem::temp_directory_path() / ("railway-benchmark-" +
+                                                                                  fixture.name + ".snapshot");
+        std::filesystem::remove(snapshot);
+        {
+            RailwayNetwork network(fixture.stationsFilePath, fixture.networkFilePath);
+            network.setSnapshotFilePath(snapshot.string());
+            network.load(nowhere());
+        }
+        unsigned long long rows = 0;
+        while (state.keepRunning()) {
+            RailwayNetwork network(fixture.stationsFilePath, fixture.networkFilePath);
+            network.setSnapshotFilePath(snapshot.string());
+            network.load(nowhere());
+            rows += network.getGraph().getNumVertex() + network.getGraph().getTotalEdges();
+        }
+        state.setItemsProcessed(rows);
+        std::filesystem::remove(snapshot);
+    });
+
+    runner.add(prefix + "edmondsKarp", [&fixture](BenchmarkState &state) {
+        RailwayNetwork &network = fixture.get();
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            network.getGraph().edmondsKarp({fixture.source}, fixture.target, network.getResidualGraph());
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "edmondsKarp/multiSource", [&fixture](BenchmarkState &state) {
+        RailwayNetwork &network = fixture.get();
+        std::list<std::string> superSource = network.getGraph().superSourceCreator(fixture.target);
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            network.getGraph().edmondsKarp(superSource, fixture.target, network.getResidualGraph());
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "incomingFlux", [&fixture](BenchmarkState &state) {
+        RailwayNetwork &network = fixture.get();
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            (void) network.getGraph().incomingFlux(fixture.target, network.getResidualGraph());
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "minCostMaxFlow", [&fixture](BenchmarkState &state) {
+        if (fixture.minCostSource.empty()) return state.skip("no min-cost pair for this network");
+        RailwayNetwork &network = fixture.get();
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            network.getGraph().minCostMaxFlow(fixture.minCostSource, fixture.minCostTarget,
+                                              network.getResidualGraph());
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "calculateNetworkMaxFlow", [&fixture](BenchmarkState &state) {
+        if (fixture.numStations() > 600) return state.skip("quadratic in the number of stations");
+        RailwayNetwork &network = fixture.get();
+        while (state.keepRunning()) network.getGraph().calculateNetworkMaxFlow(network.getResidualGraph());
+        unsigned long long n = fixture.numStations();
+        state.setItemsProcessed(n * (n - 1) / 2);
+    });
+
+    runner.add(prefix + "topGroupings/district", [&fixture, maxQuadraticStations](BenchmarkState &state) {
+        if (fixture.numStations() > maxQuadraticStations) return state.skip("one max flow per station");
+        RailwayNetwork &network = fixture.get();
+        unsigned long long stations = 0;
+        while (state.keepRunning()) {
+            network.getGraph().topGroupings(network.getDataRepository(), Grouping::DISTRICT,
+                                            network.getResidualGraph());
+            stations += fixture.numStations();
+        }
+        state.setItemsProcessed(stations);
+    });
+
+    runner.add(prefix + "topGroupings/township/top5", [&fixture, maxQuadraticStations](BenchmarkState &state) {
+        if (fixture.numStations() > maxQuadraticStations) return state.skip("one max flow per station");
+        RailwayNetwork &network = fixture.get();
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            network.getGraph().topGroupings(network.getDataRepository(), Grouping::TOWNSHIP, 5,
+                                            network.getResidualGraph());
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "topReductions", [&fixture, maxQuadraticStations](BenchmarkState &state) {
+        if (fixture.numStations() > maxQuadraticStations) return state.skip("two max flows per station");
+        RailwayNetwork &network = fixture.get();
+        std::vector<Edge *> failed = {network.getGraph().findVertex(fixture.target)->getAdj().front()};
+        unsigned long long stations = 0;
+        while (state.keepRunning()) {
+            network.getGraph().topReductions(failed, network.getResidualGraph());
+            Graph::activateEdges(failed);
+            stations += fixture.numStations();
+        }
+        state.setItemsProcessed(stations);
+    });
+
+    runner.add(prefix + "contractedGraph/edmondsKarp", [&fixture](BenchmarkState &state) {
+        RailwayNetwork &network = fixture.get();
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            network.getContractedGraph().edmondsKarp({fixture.source}, fixture.target);
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "flowNetwork/maxFlow", [&fixture](BenchmarkState &state) {
+        const FlowNetwork &flowNetwork = fixture.get().getFlowNetwork();
+        unsigned int source = flowNetwork.findStation(fixture.source);
+        unsigned int target = flowNetwork.findStation(fixture.target);
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            (void) flowNetwork.maxFlow({source}, target);
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "widestPath/dijkstra", [&fixture](BenchmarkState &state) {
+        const FlowNetwork &flowNetwork = fixture.get().getFlowNetwork();
+        unsigned int source = flowNetwork.findStation(fixture.source);
+        unsigned int target = flowNetwork.findStation(fixture.target);
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            (void) flowNetwork.widestPath(source, target);
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    runner.add(prefix + "widestPath/tree", [&fixture](BenchmarkState &state) {
+        RailwayNetwork &network = fixture.get();
+        unsigned int source = network.getFlowNetwork().findStation(fixture.source);
+        unsigned int target = network.getFlowNetwork().findStation(fixture.target);
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            (void) network.getWidestPathTree().widestCapacity(source, target);
+            queries++;
+        }
+        state.setItemsProcessed(queries);
+    });
+
+    for (RouteMetric metric: {RouteMetric::COST, RouteMetric::HOPS}) {
+        std::string route = prefix + (metric == RouteMetric::COST ? "cheapestRoute/" : "shortestRoute/");
+        runner.add(route + "dijkstra", [&fixture, metric](BenchmarkState &state) {
+            const FlowNetwork &flowNetwork = fixture.get().getFlowNetwork();
+            unsigned int source = flowNetwork.findStation(fixture.source);
+            unsigned int target = flowNetwork.findStation(fixture.target);
+            unsigned long long queries = 0;
+            while (state.keepRunning()) {
+                (void) flowNetwork.shortestPath(source, target, metric);
+                queries++;
+            }
+            state.setItemsProcessed(queries);
+        });
+
+        runner.add(route + "hierarchy", [&fixture, metric](BenchmarkState &state) {
+            RailwayNetwork &network = fixture.get();
+            const ContractionHierarchy &hierarchy = network.getContractionHierarchy(metric);
+            unsigned int source = network.getFlowNetwork().findStation(fixture.source);
+            unsigned int target = network.getFlowNetwork().findStation(fixture.target);
+            (void) hierarchy.shortestPath(source, target); //The first query builds the hierarchy
+            unsigned long long queries = 0;
+            while (state.keepRunning()) {
+                (void) hierarchy.shortestPath(source, target);
+                queries++;
+            }
+            state.setItemsProcessed(queries);
+        });
+
+        runner.add(route + "build", [&fixture, metric](BenchmarkState &state) {
+            const FlowNetwork &flowNetwork = fixture.get().getFlowNetwork();
+            unsigned long long stations = 0;
+            while (state.keepRunning()) {
+                ContractionHierarchy hierarchy;
+                hierarchy.build(flowNetwork, metric);
+                stations += flowNetwork.getNumStations();
+            }
+            state.setItemsProcessed(stations);
+        });
+    }
+
+    runner.add(prefix + "queryEngine/workload", [&fixture, maxQuadraticStations](BenchmarkState &state) {
+        RailwayNetwork &network = fixture.get();
+        std::string neighbour = network.getGraph().findVertex(fixture.target)->getAdj().front()->getDest()->getId();
+        std::vector<std::vector<std::string>> workload = {
+                {"max_flow",         fixture.source, fixture.target},
+                {"incoming_flux",    fixture.target},
+                {"failure_max_flow", fixture.source, fixture.target, fixture.target, neighbour},
+                {"closure_max_flow", fixture.source, fixture.target, neighbour},
+                {"critical_rails",   fixture.source, fixture.target, "5"}};
+        if (fixture.numStations() <= maxQuadraticStations) workload.push_back({"top_groupings", "district", "5"});
+        if (!fixture.minCostSource.empty())
+            workload.push_back({"min_cost", fixture.minCostSource, fixture.minCostTarget});
+        QueryEngine queryEngine(network.getDataRepository(), network.getFlowNetwork());
+        unsigned long long queries = 0;
+        while (state.keepRunning()) {
+            (void) queryEngine.executeAll(workload, 1);
+            queries += workload.size();
+        }
+        state.setItemsProcessed(queries);
+    });
+}
+
+/**
+ * Usage: RailwayBenchmarks [--filter TEXT] [--min-time SECONDS] [--format table|csv] [--dataset DIRECTORY]
+ *                          [--sizes N1,N2,...] [--max-quadratic N] [--baseline FILE [--tolerance F]
+ *                          [--allocation-tolerance F] [--retries N]] [--write-baseline FILE]
+ * Runs the benchmarks on the shipped dataset and on generated networks with the given numbers of stations, writing the
+ * results to the standard output. With --baseline, only the benchmarks in FILE (a CSV written by --format csv or
+ * --write-baseline) are run and compared with it, and the exit status is 1 if any of them regressed beyond the
+ * tolerances (see BenchmarkRunner::compare). Benchmarks slower than their baseline are run again up to N times
+ * (2 by default) before they count as regressions, keeping their fastest run. --write-baseline saves the results as a
+ * new baseline, in which case regressions don't change the exit status
+ */
+int main(int argc, char *argv[]) {
+    std::string filter;
+    double minTime = 0.2;
+    std::string format = "table";
+    std::string dataset = "../dataset";
+    std::vector<unsigned int> sizes = {1000, 10000, 100000};
+    unsigned int maxQuadraticStations = 2000;
+    std::string baselinePath;
+    std::string writeBaselinePath;
+    RegressionTolerance tolerance;
+    unsigned int retries = 2;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        bool valid = true;
+        if (option == "--filter") filter = value;
+        else if (option == "--min-time") valid = parseNumber(value, minTime);
+        else if (option == "--format") format = value;
+        else if (option == "--dataset") dataset = value;
+        else if (option == "--max-quadratic") valid = parseNumber(value, maxQuadraticStations);
+        else if (option == "--baseline") baselinePath = value;
+        else if (option == "--write-baseline") writeBaselinePath = value;
+        else if (option == "--tolerance") valid = parseNumber(value, tolerance.latency);
+        else if (option == "--allocation-tolerance") valid = parseNumber(value, tolerance.allocations);
+        else if (option == "--retries") valid = parseNumber(value, retries);
+        else if (option == "--sizes") {
+            sizes.clear();
+            std::istringstream list(value);
+            for (std::string size; valid && std::getline(list, size, ',');) {
+                if (size.empty()) continue;
+                valid = parseNumber(size, sizes.emplace_back());
+            }
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value " << value << " of " << option << std::endl;
+            return 2;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--min-time SECONDS] [--format table|csv]"
+                  << " [--dataset DIRECTORY] [--sizes N1,N2,...] [--max-quadratic N] [--baseline FILE"
+                  << " [--tolerance F] [--allocation-tolerance F] [--retries N]] [--write-baseline FILE]" << std::endl;
+        return 2;
+    }
+    std::vector<BenchmarkResult> baseline;
+    if (!baselinePath.empty()) {
+        std::ifstream file(baselinePath);
+        if (!file || !BenchmarkRunner::readCsv(file, baseline)) {
+            std::cerr << "Could not read the baseline " << baselinePath << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<std::unique_ptr<Fixture>> fixtures;
+    fixtures.push_back(std::make_unique<Fixture>(Fixture{
+            "dataset", dataset + "/stations.csv", dataset + "/network.csv", "Porto Campanhã", "Lisboa Oriente", "Ovar",
+            "Miramar", nullptr}));
+    std::filesystem::path generated = std::filesystem::temp_directory_path() / "railway-benchmark";
+    for (unsigned int size: sizes) {
+        if (size < 2) continue;
+        std::filesystem::path directory = generated / std::to_string(size);
+        std::filesystem::create_directories(directory);
+        GeneratorOptions options;
+        options.numStations = size;
+        options.seed = 42;
+        NetworkGenerator(options).write((directory / "stations.csv").string(),
+                                        (directory / "network.csv").string());
+        fixtures.push_back(std::make_unique<Fixture>(Fixture{
+                "generated-" + std::to_string(size), (directory / "stations.csv").string(),
+                (directory / "network.csv").string(), NetworkGenerator::stationName(0),
+                NetworkGenerator::stationName(size - 1), "", "", nullptr}));
+    }
+
+    BenchmarkRunner runner;
+    for (std::unique_ptr<Fixture> &fixture: fixtures) addBenchmarks(runner, *fixture, maxQuadraticStations);
+    std::vector<BenchmarkResult> results = baselinePath.empty() ? runner.run(filter, minTime, std::cerr)
+                                                                : runner.run(baseline, minTime, std::cerr);
+    if (!baselinePath.empty()) runner.retrySlower(results, baseline, tolerance, minTime, retries, std::cerr);
+    std::filesystem::remove_all(generated);
+
+    if (!writeBaselinePath.empty()) {
+        std::ofstream file(writeBaselinePath);
+        BenchmarkRunner::printCsv(results, file);
+        if (!file) {
+            std::cerr << "Could not write the baseline " << writeBaselinePath << std::endl;
+            return 1;
+        }
+    }
+    if (!baselinePath.empty()) {
+        bool passed = BenchmarkRunner::compare(results, baseline, tolerance, std::cout);
+        return passed || !writeBaselinePath.empty() ? 0 : 1;
+    }
+    if (format == "csv") BenchmarkRunner::printCsv(results, std::cout);
+    else BenchmarkRunner::printTable(results, std::cout);
+    return 0;
+}
@@ -0,0 +1,576 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "bridgeDecomposition.h"
+#include "networkSnapshot.h"
+
+BridgeDecomposition::BridgeDecomposition() = default;
+
+/**
+ * Computes the bridges, the 2-edge-connected components and the bridge tree of a network
+ * Time Complexity: O(|V|+|E|) (average case)
+ * @param network - Graph to decompose. Must outlive this object
+ */
+void BridgeDecomposition::build(const Graph &network) {
+    graph = &network;
+    bridges.clear();
+    vertexToComponent.clear();
+    components.clear();
+    componentBridges.clear();
+    parentBridge.clear();
+    depth.clear();
+    treeRoot.clear();
+
+    findBridges(graph->getVertexSet());
+    buildBridgeTree();
+}
+
+/**
+ * Loads the bridges and the 2-edge-connected components of a network from the snapshot it was loaded from, instead of
+ * searching for them, and roots every tree of the bridge forest
+ * Time Complexity: O(|V|+b) (average case), b being the number of bridges
+ * @param network - Graph loaded from the snapshot. Must outlive this object
+ * @param snapshot - Valid snapshot
+ * @param vertices - Vertices of the Graph, indexed by their station index in the snapshot
+ * @param edges - Edges of the Graph, indexed by their edge index in the snapshot (see SnapshotRail)
+ */
+void BridgeDecomposition::build(const Graph &network, const NetworkSnapshot &snapshot,
+                                const std::vector<Vertex *> &vertices, const std::vector<Edge *> &edges) {
+    graph = &network;
+    bridges.clear();
+    vertexToComponent.clear();
+    components.clear();
+    componentBridges.clear();
+    parentBridge.clear();
+    depth.clear();
+    treeRoot.clear();
+
+    std::span<const uint32_t> offsets = snapshot.getIndexArray(NetworkSnapshot::COMPONENT_OFFSETS);
+    std::span<const uint32_t> stations = snapshot.getIndexArray(NetworkSnapshot::COMPONENT_STATIONS);
+    for (size_t c = 0; c + 1 < offsets.size(); c++) {
+        unsigned int component = addComponent();
+        for (uint32_t i = offsets[c]; i < offsets[c + 1]; i++) {
+            Vertex *v = vertices[stations[i]];
+            vertexToComponent[v] = component;
+            components[component].push_back(v);
+        }
+    }
+    for (uint32_t edge: snapshot.getIndexArray(NetworkSnapshot::BRIDGES)) {
+        Edge *e = edges[edge];
+        bridges.insert(e);
+        bridges.insert(e->getReverse());
+        componentBridges[vertexToComponent.at(e->getOrig())].push_back(e);
+        componentBridges[vertexToComponent.at(e->getDest())].push_back(e->getReverse());
+    }
+    rootForest();
+}
+
+/**
+ * Iterative version of Tarjan's bridge-finding algorithm, run from the given vertices without crossing the bridges
+ * already known. Only the reverse of the edge used to reach a vertex is skipped, so parallel rails between two stations
+ * are correctly not reported as bridges
+ * Time Complexity: O(|V|+|E|) (average case), for the V and E reachable from the given vertices
+ * @param vertices - Vertices to search from, e.g. every vertex of the Graph or of a single component
+ * @param removed - Pointer to either direction of a rail to ignore, as if it had already been removed, or nullptr
+ */
+void BridgeDecomposition::findBridges(const std::vector<Vertex *> &vertices, const Edge *removed) {
+    struct Frame {
+        Vertex *v;
+        Edge *parentEdge;
+        std::vector<Edge *> adj;
+        size_t next;
+    };
+
+    std::unordered_map<const Vertex *, unsigned int> discovery;
+    std::unordered_map<const Vertex *, unsigned int> low;
+    unsigned int time = 0;
+    std::vector<Frame> stack;
+
+    for (Vertex *root: vertices) {
+        if (discovery.find(root) != discovery.end()) continue;
+        discovery[root] = low[root] = time++;
+        stack.push_back({root, nullptr, root->getAdj(), 0});
+
+        while (!stack.empty()) {
+            Frame &frame = stack.back();
+            if (frame.next < frame.adj.size()) {
+                Edge *e = frame.adj[frame.next++];
+                if (frame.parentEdge != nullptr && e == frame.parentEdge->getReverse()) continue;
+                if (e == removed || e->getReverse() == removed || isBridge(e)) continue;
+                Vertex *w = e->getDest();
+                auto it = discovery.find(w);
+                if (it == discovery.end()) {
+                    discovery[w] = low[w] = time++;
+                    stack.push_back({w, e, w->getAdj(), 0});
+                } else {
+                    low[frame.v] = std::min(low[frame.v], it->second);
+                }
+            } else {
+                Vertex *v = frame.v;
+                Edge *parentEdge = frame.parentEdge;
+                stack.pop_back();
+                if (stack.empty()) continue;
+                Vertex *parent = stack.back().v;
+                low[parent] = std::min(low[parent], low[v]);
+                if (low[v] > discovery[parent]) {
+                    bridges.insert(parentEdge);
+                    bridges.insert(parentEdge->getReverse());
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Assigns to a component every vertex reachable from a root without crossing a bridge
+ * Time Complexity: O(|V|+|E|) (average case), for the V and E of the component
+ * @param root - Pointer to a Vertex not assigned to any component yet
+ * @param component - Index of the component, whose list of vertices must be empty
+ * @param removed - Pointer to either direction of a rail to ignore, as if it had already been removed, or nullptr
+ */
+void BridgeDecomposition::groupComponent(Vertex *root, unsigned int component, const Edge *removed) {
+    std::queue<Vertex *> q;
+    q.push(root);
+    vertexToComponent[root] = component;
+    while (!q.empty()) {
+        Vertex *v = q.front();
+        q.pop();
+        components[component].push_back(v);
+        for (Edge *e: v->getAdj()) {
+            if (e == removed || e->getReverse() == removed || isBridge(e)) continue;
+            if (vertexToComponent.emplace(e->getDest(), component).second) q.push(e->getDest());
+        }
+    }
+}
+
+/**
+ * Groups the vertices into 2-edge-connected components and roots every tree of the resulting bridge forest
+ * Time Complexity: O(|V|+|E|) (average case)
+ */
+void BridgeDecomposition::buildBridgeTree() {
+    for (Vertex *root: graph->getVertexSet()) {
+        if (vertexToComponent.find(root) == vertexToComponent.end()) groupComponent(root, addComponent());
+    }
+    for (Edge *e: bridges) componentBridges[vertexToComponent.at(e->getOrig())].push_back(e);
+    rootForest();
+}
+
+/**
+ * Roots every tree of the bridge forest at its component with the smallest index
+ * Time Complexity: O(c), c being the number of components
+ */
+void BridgeDecomposition::rootForest() {
+    treeRoot.assign(components.size(), (unsigned int) components.size());
+    for (unsigned int root = 0; root < components.size(); root++) {
+        if (treeRoot[root] == components.size()) rootTree(root);
+    }
+}
+
+/**
+ * Roots the tree of the bridge forest that contains a component at that component, setting the root, parent bridge and
+ * depth of every component of the tree
+ * Time Complexity: O(c), c being the number of components of the tree
+ * @param root - Index of the component
+ */
+void BridgeDecomposition::rootTree(unsigned int root) {
+    treeRoot[root] = root;
+    parentBridge[root] = nullptr;
+    depth[root] = 0;
+    std::queue<unsigned int> q;
+    q.push(root);
+    while (!q.empty()) {
+        unsigned int c = q.front();
+        q.pop();
+        for (Edge *e: componentBridges[c]) {
+            if (parentBridge[c] != nullptr && e == parentBridge[c]->getReverse()) continue;
+            unsigned int child = vertexToComponent.at(e->getDest());
+            treeRoot[child] = root;
+            parentBridge[child] = e;
+            depth[child] = depth[c] + 1;
+            q.push(child);
+        }
+    }
+}
+
+/**
+ * Appends an empty component, as the root of a tree of its own
+ * Time Complexity: O(1) (amortized)
+ * @return Index of the component
+ */
+unsigned int BridgeDecomposition::addComponent() {
+    auto component = (unsigned int) components.size();
+    components.emplace_back();
+    componentBridges.emplace_back();
+    parentBridge.push_back(nullptr);
+    depth.push_back(0);
+    treeRoot.push_back(component);
+    return component;
+}
+
+/**
+ * Removes a component whose vertices and bridges were all moved to other components, by moving the last component into
+ * its index
+ * Time Complexity: O(v) (average case), v being the number of vertices of the last component, plus O(c) if it is the
+ * root of a tree of c components
+ * @param component - Index of the component
+ */
+void BridgeDecomposition::removeComponent(unsigned int component) {
+    auto last = (unsigned int) components.size() - 1;
+    if (component != last) {
+        components[component] = std::move(components[last]);
+        componentBridges[component] = std::move(componentBridges[last]);
+        parentBridge[component] = parentBridge[last];
+        depth[component] = depth[last];
+        treeRoot[component] = treeRoot[last];
+        for (Vertex const *v: components[component]) vertexToComponent[v] = component;
+        if (treeRoot[component] == last) rootTree(component);
+    }
+    components.pop_back();
+    componentBridges.pop_back();
+    parentBridge.pop_back();
+    depth.pop_back();
+    treeRoot.pop_back();
+}
+
+/**
+ * Adds a station just added to the Graph, without rails, as a component and a tree of its own
+ * Time Complexity: O(1) (average case)
+ * @param station - Pointer to the new Vertex
+ */
+void BridgeDecomposition::addStation(Vertex *station) {
+    unsigned int component = addComponent();
+    vertexToComponent[station] = component;
+    components[component].push_back(station);
+}
+
+/**
+ * Patches the decomposition with a rail just added to the Graph. A rail inside a component changes nothing, and a rail
+ * between two trees of the bridge forest is a new bridge joining them. A rail between two components of the same tree
+ * closes a cycle with the bridges between them, so those bridges stop being bridges and the components on their path
+ * merge into one
+ * Time Complexity: O(d + v + c) (average case), d being the depth of the bridge tree, v the number of vertices of the
+ * merged components and c the number of components of the tree
+ * @param rail - Pointer to either direction of the new Edge
+ */
+void BridgeDecomposition::addRail(Edge *rail) {
+    unsigned int first = vertexToComponent.at(rail->getOrig());
+    unsigned int second = vertexToComponent.at(rail->getDest());
+    if (first == second) return;
+
+    if (treeRoot[first] != treeRoot[second]) {
+        bridges.insert(rail);
+        bridges.insert(rail->getReverse());
+        componentBridges[first].push_back(rail);
+        componentBridges[second].push_back(rail->getReverse());
+        rootTree(treeRoot[first]);
+        return;
+    }
+
+    std::vector<unsigned int> merged = {first};
+    for (Edge *e: bridgePath(first, second)) {
+        bridges.erase(e);
+        bridges.erase(e->getReverse());
+        merged.push_back(vertexToComponent.at(e->getDest()));
+    }
+    std::sort(merged.begin(), merged.end());
+    unsigned int target = merged.front();
+    CountedVector<Edge *, MemoryCategory::BRIDGES> targetBridges;
+    for (unsigned int c: merged) {
+        for (Edge *e: componentBridges[c]) {
+            if (isBridge(e)) targetBridges.push_back(e);
+        }
+        if (c == target) continue;
+        for (Vertex *v: components[c]) {
+            vertexToComponent[v] = target;
+            components[target].push_back(v);
+        }
+        components[c].clear();
+        componentBridges[c].clear();
+    }
+    componentBridges[target] = std::move(targetBridges);
+    for (auto it = merged.rbegin(); *it != target; it++) removeComponent(*it);
+    rootTree(target);
+}
+
+/**
+ * Patches the decomposition before a rail is removed from the Graph. Removing a bridge splits its tree in two. Removing
+ * any other rail can only split its own component, so the bridges are searched again inside that component alone
+ * Time Complexity: O(c) for a bridge | O(v+e+c) (average case) otherwise, v and e being the number of vertices and
+ * rails of the rail's component and c the number of components of its tree
+ * @param rail - Pointer to either direction of the Edge, still in the Graph
+ */
+void BridgeDecomposition::removeRail(Edge *rail) {
+    unsigned int first = vertexToComponent.at(rail->getOrig());
+    unsigned int second = vertexToComponent.at(rail->getDest());
+    if (isBridge(rail)) {
+        bridges.erase(rail);
+        bridges.erase(rail->getReverse());
+        auto &firstBridges = componentBridges[first];
+        firstBridges.erase(std::find(firstBridges.begin(), firstBridges.end(), rail));
+        auto &secondBridges = componentBridges[second];
+        secondBridges.erase(std::find(secondBridges.begin(), secondBridges.end(), rail->getReverse()));
+        rootTree(first);
+        rootTree(second);
+        return;
+    }
+
+    unsigned int root = treeRoot[first];
+    std::vector<Vertex *> vertices(components[first].begin(), components[first].end());
+    size_t numBridges = bridges.size();
+    findBridges(vertices, rail);
+    if (bridges.size() == numBridges) return; //Still 2-edge-connected
+
+    for (Vertex const *v: vertices) vertexToComponent.erase(v);
+    components[first].clear();
+    componentBridges[first].clear();
+    groupComponent(vertices.front(), first, rail);
+    for (Vertex *v: vertices) {
+        if (vertexToComponent.find(v) == vertexToComponent.end()) groupComponent(v, addComponent(), rail);
+    }
+    for (Vertex *v: vertices) {
+        for (Edge *e: v->getAdj()) {
+            if (isBridge(e)) componentBridges[vertexToComponent.at(v)].push_back(e);
+        }
+    }
+    rootTree(root);
+}
+
+bool BridgeDecomposition::isBridge(Edge *edge) const {
+    return bridges.find(edge) != bridges.end();
+}
+
+unsigned int BridgeDecomposition::getNumBridges() const {
+    return (unsigned int) bridges.size() / 2;
+}
+
+unsigned int BridgeDecomposition::getNumComponents() const {
+    return (unsigned int) components.size();
+}
+
+const CountedVector<Vertex *, MemoryCategory::BRIDGES> &
+BridgeDecomposition::getComponentStations(unsigned int component) const {
+    return components[component];
+}
+
+/**
+ * Finds the 2-edge-connected component a station belongs to
+ * Time Complexity: O(1) (average case)
+ * @param station - Id of the station
+ * @return Index of the component, or the number of components if no such station exists
+ */
+unsigned int BridgeDecomposition::findComponent(const std::string &station) const {
+    Vertex const *v = graph->findVertex(station);
+    if (v == nullptr) return (unsigned int) components.size();
+    return vertexToComponent.at(v);
+}
+
+/**
+ * Finds the bridges crossed by any route between two components of the same tree
+ * Time Complexity: O(d), d being the depth of the bridge tree
+ * @param from - Index of the starting component
+ * @param to - Index of the ending component
+ * @return Vector of pointers to the bridges, in order and directed from "from" towards "to"
+ */
+std::vector<Edge *> BridgeDecomposition::bridgePath(unsigned int from, unsigned int to) const {
+    std::vector<Edge *> up;
+    std::vector<Edge *> down;
+    while (from != to) {
+        if (depth[from] >= depth[to]) {
+            up.push_back(parentBridge[from]->getReverse());
+            from = vertexToComponent.at(parentBridge[from]->getOrig());
+        } else {
+            down.push_back(parentBridge[to]);
+            to = vertexToComponent.at(parentBridge[to]->getOrig());
+        }
+    }
+    up.insert(up.end(), down.rbegin(), down.rend());
+    return up;
+}
+
+/**
+ * Computes the max flow inside a single component, from a set of unlimited sources and a set of vertices that can
+ * supply a limited amount of flow each (the flow that reaches them through a bridge)
+ * Time Complexity: O(|VE²|), for the V and E of the component
+ * @param component - Index of the component
+ * @param sources - List of pointers to the source Vertexes inside the component
+ * @param supplies - List of pairs of a Vertex inside the component and the flow it can supply
+ * @param target - Pointer to the target Vertex, inside the component
+ * @return Max flow that can reach target
+ */
+unsigned int BridgeDecomposition::componentMaxFlow(unsigned int component, const std::list<Vertex *> &sources,
+                                                   const std::list<std::pair<Vertex *, unsigned int>> &supplies,
+                                                   Vertex *target) const {
+    if (sources.empty() && supplies.empty()) return 0;
+    if (components[component].size() == 1) { //Every supply is already at the target
+        unsigned int total = 0;
+        for (const auto &[v, supply]: supplies) total += supply;
+        return total;
+    }
+
+    Graph subGraph;
+    Graph subResidual;
+    for (Vertex const *v: components[component]) {
+        subGraph.addVertex(v->getId());
+        subResidual.addVertex(v->getId());
+    }
+
+    auto addEdge = [&subGraph, &subResidual](const std::string &orig, const std::string &dest, unsigned int c,
+                                             Service service) {
+        auto [regular, regularReverse] = subGraph.addAndGetBidirectionalEdge(orig, dest, c, service);
+        auto [residual, residualReverse] = subResidual.addAndGetBidirectionalEdge(orig, dest, c, service);
+        regular->setCorrespondingEdge(residual);
+        regularReverse->setCorrespondingEdge(residualReverse);
+        residual->setCorrespondingEdge(regular);
+        residualReverse->setCorrespondingEdge(regularReverse);
+    };
+
+    for (Vertex const *v: components[component]) {
+        for (Edge *e: v->getAdj()) {
+            if (!e->isSelected() || isBridge(e) || !std::less<Edge *>()(e, e->getReverse())) continue;
+            addEdge(v->getId(), e->getDest()->getId(), e->getCapacity(), e->getService());
+        }
+    }
+
+    std::list<std::string> superSource;
+    for (Vertex const *v: sources) superSource.push_back(v->getId());
+    unsigned int supplyNum = 0;
+    for (const auto &[v, supply]: supplies) {
+        std::string supplyId = "\t"; //Can't clash with a station name
+        supplyId += std::to_string(supplyNum++);
+        subGraph.addVertex(supplyId);
+        subResidual.addVertex(supplyId);
+        addEdge(supplyId, v->getId(), supply, Service::STANDARD);
+        superSource.push_back(supplyId);
+    }
+
+    return subGraph.edmondsKarp(superSource, target->getId(), subResidual);
+}
+
+/**
+ * Checks if deactivating a set of edges certainly disconnects two stations, because one of them is a bridge on the
+ * route between them (or the stations were never connected)
+ * Time Complexity: O(d + size(edges)), d being the depth of the bridge tree
+ * @param edges - Vector of pointers to the Edges to be deactivated
+ * @param source - Id of the source station
+ * @param target - Id of the target station
+ * @return True if no flow can go from source to target once the edges are deactivated
+ */
+bool BridgeDecomposition::disconnects(const std::vector<Edge *> &edges, const std::string &source,
+                                      const std::string &target) const {
+    unsigned int sourceComponent = findComponent(source);
+    unsigned int targetComponent = findComponent(target);
+    if (sourceComponent == components.size() || targetComponent == components.size()) return true;
+    if (treeRoot[sourceComponent] != treeRoot[targetComponent]) return true;
+
+    std::unordered_set<Edge *> path;
+    for (Edge *e: bridgePath(sourceComponent, targetComponent)) {
+        path.insert(e);
+        path.insert(e->getReverse());
+    }
+    return std::any_of(edges.begin(), edges.end(), [&path](Edge *e) { return path.find(e) != path.end(); });
+}
+
+/**
+ * Computes the max flow between two stations by solving it only inside the components on their bridge tree route,
+ * each between the vertices where the route enters and leaves it, and bounding it by the capacity of every bridge
+ * Time Complexity: O(|VE²|), for the V and E of the largest component on the route
+ * @param source - Id of the source station
+ * @param target - Id of the target station
+ * @return Max flow between source and target
+ */
+unsigned int BridgeDecomposition::maxFlow(const std::string &source, const std::string &target) const {
+    Vertex *sourceVertex = graph->findVertex(source);
+    Vertex *targetVertex = graph->findVertex(target);
+    if (sourceVertex == nullptr || targetVertex == nullptr || sourceVertex == targetVertex) return 0;
+    unsigned int sourceComponent = vertexToComponent.at(sourceVertex);
+    unsigned int targetComponent = vertexToComponent.at(targetVertex);
+    if (treeRoot[sourceComponent] != treeRoot[targetComponent]) return 0;
+
+    std::vector<Edge *> path = bridgePath(sourceComponent, targetComponent);
+    unsigned int result = UINT32_MAX;
+    for (Edge const *e: path) {
+        if (!e->isSelected()) return 0;
+        result = std::min(result, e->getCapacity());
+    }
+
+    Vertex *entry = sourceVertex;
+    for (Edge *e: path) {
+        if (entry != e->getOrig())
+            result = std::min(result, componentMaxFlow(vertexToComponent.at(entry), {entry}, {}, e->getOrig()));
+        if (result == 0) return 0;
+        entry = e->getDest();
+    }
+    if (entry != targetVertex) result = std::min(result, componentMaxFlow(targetComponent, {entry}, {}, targetVertex));
+    return result;
+}
+
+/**
+ * Finds the incoming flux of a station (see Graph::incomingFlux) by rooting the bridge tree at the station's component
+ * and computing, bottom-up, how much flow every subtree can push through the bridge to its parent
+ * Time Complexity: O(|V|+|E|) plus O(|VE²|) for the V and E of each component with more than one station
+ * @param station - Id of the station
+ * @return Max flow that can arrive at the given station from all the network
+ */
+unsigned int BridgeDecomposition::incomingFlux(const std::string &station) const {
+    Vertex *target = graph->findVertex(station);
+    if (target == nullptr) return 0;
+
+    std::unordered_set<const Vertex *> superSource;
+    for (const std::string &id: graph->superSourceCreator(station)) superSource.insert(graph->findVertex(id));
+
+    //Components of the tree in BFS order, along with the bridge through which each was reached
+    std::vector<std::pair<unsigned int, Edge *>> order = {{vertexToComponent.at(target), nullptr}};
+    for (size_t i = 0; i < order.size(); i++) {
+        auto [component, in] = order[i];
+        for (Edge *e: componentBridges[component]) {
+            if (in != nullptr && e == in->getReverse()) continue;
+            order.emplace_back(vertexToComponent.at(e->getDest()), e);
+        }
+    }
+
+    std::unordered_map<unsigned int, unsigned int> supplied;
+    for (auto it = order.rbegin(); it != order.rend(); it++) {
+        auto [component, in] = *it;
+        Vertex *exit = in == nullptr ? target : in->getDest();
+
+        std::list<Vertex *> sources;
+        for (Vertex *v: components[component])
+            if (superSource.find(v) != superSource.end()) sources.push_back(v);
+
+        std::list<std::pair<Vertex *, unsigned int>> supplies;
+        for (Edge *e: componentBridges[component]) {
+            if (in != nullptr && e == in->getReverse()) continue;
+            unsigned int supply = supplied[vertexToComponent.at(e->getDest())];
+            if (supply > 0) supplies.emplace_back(e->getOrig(), supply);
+        }
+
+        if (in == nullptr) return componentMaxFlow(component, sources, supplies, exit);
+
+        unsigned int inner = superSource.find(exit) != superSource.end() ? UINT32_MAX :
+                             componentMaxFlow(component, sources, supplies, exit);
+        supplied[component] = in->isSelected() ? std::min(inner, in->getCapacity()) : 0;
+    }
+    return 0;
+}
+
+/**
+ * Calculates the max flow between two stations before and after deactivating a set of edges, answering immediately
+ * when a deactivated bridge disconnects them
+ * Time Complexity: O(d + size(edges)) if disconnected | see BridgeDecomposition::maxFlow otherwise
+ * @param edges - Vector of pointers to the Edges to be deactivated and later reactivated
+ * @param source - Id of the source station
+ * @param target - Id of the target station
+ * @return A pair with the max flow before deactivating the Edges and after
+ */
+std::pair<unsigned int, unsigned int>
+BridgeDecomposition::maxFlowDeactivatedEdges(const std::vector<Edge *> &edges, const std::string &source,
+                                             const std::string &target) const {
+    std::pair<unsigned int, unsigned int> result;
+    result.first = maxFlow(source, target);
+    if (disconnects(edges, source, target)) return {result.first, 0};
+    Graph::deactivateEdges(edges);
+    result.second = maxFlow(source, target);
+    Graph::activateEdges(edges);
+    return result;
+}
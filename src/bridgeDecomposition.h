@@ -0,0 +1,94 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_BRIDGEDECOMPOSITION_H
+#define RAILWAYMANAGEMENT_BRIDGEDECOMPOSITION_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "graph.h"
+
+class NetworkSnapshot;
+
+/**
+ * Decomposition of a railway network into its bridges (rails whose removal disconnects the network) and its
+ * 2-edge-connected components, which are linked by the bridges into a forest (the bridge tree). Flow between two
+ * components can only cross the bridges on their tree path, so max flow queries are solved inside each component
+ */
+class BridgeDecomposition {
+  private:
+    const Graph *graph = nullptr;
+    CountedSet<Edge *, MemoryCategory::BRIDGES> bridges; // both directions of every bridge
+    CountedMap<const Vertex *, unsigned int, MemoryCategory::BRIDGES> vertexToComponent;
+    CountedVector<CountedVector<Vertex *, MemoryCategory::BRIDGES>, MemoryCategory::BRIDGES> components;
+    // bridges leaving each component
+    CountedVector<CountedVector<Edge *, MemoryCategory::BRIDGES>, MemoryCategory::BRIDGES> componentBridges;
+    // bridge from the parent component in the bridge tree, or nullptr for roots
+    CountedVector<Edge *, MemoryCategory::BRIDGES> parentBridge;
+    CountedVector<unsigned int, MemoryCategory::BRIDGES> depth;
+    CountedVector<unsigned int, MemoryCategory::BRIDGES> treeRoot;
+
+    void findBridges(const std::vector<Vertex *> &vertices, const Edge *removed = nullptr);
+
+    void groupComponent(Vertex *root, unsigned int component, const Edge *removed = nullptr);
+
+    void buildBridgeTree();
+
+    void rootForest();
+
+    void rootTree(unsigned int root);
+
+    unsigned int addComponent();
+
+    void removeComponent(unsigned int component);
+
+    [[nodiscard]] std::vector<Edge *> bridgePath(unsigned int from, unsigned int to) const;
+
+    unsigned int
+    componentMaxFlow(unsigned int component, const std::list<Vertex *> &sources,
+                     const std::list<std::pair<Vertex *, unsigned int>> &supplies, Vertex *target) const;
+
+  public:
+    BridgeDecomposition();
+
+    void build(const Graph &network);
+
+    void build(const Graph &network, const NetworkSnapshot &snapshot, const std::vector<Vertex *> &vertices,
+               const std::vector<Edge *> &edges);
+
+    void addStation(Vertex *station);
+
+    void addRail(Edge *rail);
+
+    void removeRail(Edge *rail);
+
+    [[nodiscard]] bool isBridge(Edge *edge) const;
+
+    [[nodiscard]] unsigned int getNumBridges() const;
+
+    [[nodiscard]] unsigned int getNumComponents() const;
+
+    [[nodiscard]] const CountedVector<Vertex *, MemoryCategory::BRIDGES> &
+    getComponentStations(unsigned int component) const;
+
+    [[nodiscard]] unsigned int findComponent(const std::string &station) const;
+
+    [[nodiscard]] bool disconnects(const std::vector<Edge *> &edges, const std::string &source,
+                                   const std::string &target) const;
+
+    [[nodiscard]] unsigned int maxFlow(const std::string &source, const std::string &target) const;
+
+    [[nodiscard]] unsigned int incomingFlux(const std::string &station) const;
+
+    std::pair<unsigned int, unsigned int>
+    maxFlowDeactivatedEdges(const std::vector<Edge *> &edges, const std::string &source,
+                            const std::string &target) const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_BRIDGEDECOMPOSITION_H
@@ -0,0 +1,396 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "contractedGraph.h"
+
+ContractedGraph::ContractedGraph() = default;
+
+/**
+ * Recomputes the capacity and cost of the super-edge containing a rail of the original Graph, after the rail's capacity
+ * or service changed. Rails and stations added to or removed from the original Graph are patched in by addStation,
+ * addRail and removeRail instead
+ * Time Complexity: O(n), n being the length of the chain containing the rail
+ * @param rail - Pointer to an Edge of the original Graph
+ */
+void ContractedGraph::updateRail(Edge *rail) {
+    for (Edge *direction: {rail, rail->getReverse()}) {
+        Edge *superEdge = findSuperEdge(direction);
+        if (superEdge == nullptr) continue;
+        const auto &rails = superEdgeToRails.at(superEdge);
+        int cost = 0;
+        for (Edge const *e: rails) cost += e->getCost();
+        superEdge->setCapacity(Graph::findListBottleneck({rails.begin(), rails.end()}));
+        superEdge->setService(rails.front()->getService());
+        superEdge->setCost(cost);
+        superEdge->getCorrespondingEdge()->setCapacity(superEdge->getCapacity());
+        superEdge->getCorrespondingEdge()->setService(superEdge->getService());
+    }
+}
+
+const Graph &ContractedGraph::getGraph() const {
+    return graph;
+}
+
+unsigned int ContractedGraph::getNumVertex() const {
+    return graph.getNumVertex();
+}
+
+unsigned int ContractedGraph::getTotalEdges() const {
+    return graph.getTotalEdges();
+}
+
+/**
+ * Checks if a vertex of the original graph sits in the middle of a chain, i.e. has exactly two edges leading to two
+ * different stations and was not explicitly kept
+ * Time Complexity: O(1) (average case)
+ * @param v - Pointer to the Vertex of the original Graph
+ * @return True if the Vertex can be contracted, false otherwise
+ */
+bool ContractedGraph::isContractible(const Vertex *v) const {
+    if (pinned.find(v->getId()) != pinned.end()) return false;
+    std::vector<Edge *> adj = v->getAdj();
+    if (adj.size() != 2) return false;
+    return adj[0]->getDest() != adj[1]->getDest() && adj[0]->getDest() != v && adj[1]->getDest() != v;
+}
+
+/**
+ * Builds the contracted network of originalGraph, along with its residual network and the mappings back to the
+ * original stations and rails
+ * Time Complexity: O(|V|+|E|) (average case)
+ * @param originalGraph - Graph to be contracted. Must outlive this object
+ * @param keep - Ids of stations that must remain as vertices of the contracted Graph (e.g. query endpoints)
+ */
+void ContractedGraph::build(const Graph &originalGraph, const std::unordered_set<std::string> &keep) {
+    original = &originalGraph;
+    pinned = {keep.begin(), keep.end()};
+    graph = Graph();
+    residualGraph = Graph();
+    superEdgeToRails.clear();
+    railToSuperEdge.clear();
+    superEdgeToStations.clear();
+    stationToSuperEdge.clear();
+    splitStations = 0;
+
+    for (Vertex const *v: original->getVertexSet()) {
+        if (isContractible(v)) continue;
+        graph.addVertex(v->getId());
+        residualGraph.addVertex(v->getId());
+    }
+
+    std::unordered_set<Edge *> processed;
+    for (Vertex const *v: original->getVertexSet()) {
+        if (graph.findVertex(v->getId()) == nullptr) continue;
+        for (Edge *e: v->getAdj()) {
+            if (processed.find(e) == processed.end()) contractChain(e, processed);
+        }
+    }
+
+    //Components that are a single cycle have no station to anchor their chains, so one is kept
+    for (Vertex *v: original->getVertexSet()) {
+        if (graph.findVertex(v->getId()) != nullptr || processed.find(v->getAdj()[0]) != processed.end()) continue;
+        pinned.insert(v->getId());
+        graph.addVertex(v->getId());
+        residualGraph.addVertex(v->getId());
+        for (Edge *e: v->getAdj()) {
+            if (processed.find(e) == processed.end()) contractChain(e, processed);
+        }
+    }
+    builtStations = graph.getNumVertex();
+}
+
+/**
+ * Follows the chain of contractible stations that starts with a given edge until a kept station is reached, and
+ * replaces it with a super-edge
+ * Time Complexity: O(n), n being the length of the chain
+ * @param first - Pointer to the first Edge of the chain, leaving a kept station
+ * @param processed - Set of the original Edges already assigned to a super-edge, in either direction
+ */
+void ContractedGraph::contractChain(Edge *first, std::unordered_set<Edge *> &processed) {
+    std::vector<Edge *> rails = {first};
+    processed.insert(first);
+    processed.insert(first->getReverse());
+
+    Vertex *current = first->getDest();
+    while (isContractible(current)) {
+        std::vector<Edge *> adj = current->getAdj();
+        Edge *next = adj[0] == rails.back()->getReverse() ? adj[1] : adj[0];
+        rails.push_back(next);
+        processed.insert(next);
+        processed.insert(next->getReverse());
+        current = next->getDest();
+    }
+
+    //A chain that loops back to its starting station can never carry flow
+    if (current == first->getOrig()) return;
+    addSuperEdge(first->getOrig(), current, rails);
+}
+
+/**
+ * Adds a bidirectional super-edge representing a chain of rails, to both the contracted Graph and its residual network
+ * Time Complexity: O(n), n being the length of the chain
+ * @param orig - Pointer to the original Vertex where the chain starts
+ * @param dest - Pointer to the original Vertex where the chain ends
+ * @param rails - Original Edges of the chain, in order from orig to dest
+ */
+void ContractedGraph::addSuperEdge(Vertex *orig, Vertex *dest, const std::vector<Edge *> &rails) {
+    unsigned int capacity = Graph::findListBottleneck({rails.begin(), rails.end()});
+    int cost = 0;
+    for (Edge const *e: rails) cost += e->getCost();
+
+    auto [regular, regularReverse] = graph.addAndGetBidirectionalEdge(orig->getId(), dest->getId(), capacity,
+                                                                      rails.front()->getService());
+    auto [residual, residualReverse] = residualGraph.addAndGetBidirectionalEdge(orig->getId(), dest->getId(),
+                                                                                capacity,
+                                                                                rails.front()->getService());
+    regular->setCorrespondingEdge(residual);
+    regularReverse->setCorrespondingEdge(residualReverse);
+    residual->setCorrespondingEdge(regular);
+    residualReverse->setCorrespondingEdge(regularReverse);
+    regular->setCost(cost);
+    regularReverse->setCost(cost);
+
+    std::vector<Edge *> reverseRails;
+    std::vector<std::string> stations;
+    for (auto it = rails.rbegin(); it != rails.rend(); it++) reverseRails.push_back((*it)->getReverse());
+    for (auto it = rails.begin(); it + 1 != rails.end(); it++) stations.push_back((*it)->getDest()->getId());
+
+    for (Edge *e: rails) railToSuperEdge[e] = regular;
+    for (Edge *e: reverseRails) railToSuperEdge[e] = regularReverse;
+    superEdgeToRails[regular] = {rails.begin(), rails.end()};
+    superEdgeToRails[regularReverse] = {reverseRails.begin(), reverseRails.end()};
+    superEdgeToStations[regular] = {stations.begin(), stations.end()};
+    superEdgeToStations[regularReverse] = {stations.rbegin(), stations.rend()};
+    for (const std::string &station: stations) stationToSuperEdge[station] = regular;
+}
+
+/**
+ * Removes a super-edge, in both directions, from the contracted Graph, its residual network and the mappings from
+ * super-edges. The mappings from its rails and stations are left for the caller to overwrite
+ * Time Complexity: O(deg(orig) + deg(dest)) (average case)
+ * @param superEdge - Pointer to either direction of the super-edge
+ */
+void ContractedGraph::removeSuperEdge(Edge *superEdge) {
+    for (Edge *direction: {superEdge, superEdge->getReverse()}) {
+        superEdgeToRails.erase(direction);
+        superEdgeToStations.erase(direction);
+    }
+    residualGraph.removeBidirectionalEdge(superEdge->getCorrespondingEdge());
+    graph.removeBidirectionalEdge(superEdge);
+}
+
+/**
+ * Keeps a contracted station as a vertex of the contracted Graph, by splitting the super-edge of its chain in two at
+ * the station. The rest of the contracted Graph is left untouched
+ * Time Complexity: O(n), n being the length of the chain
+ * @param station - Id of a station contracted into a super-edge
+ */
+void ContractedGraph::splitChain(const std::string &station) {
+    Edge *superEdge = stationToSuperEdge.at(station);
+    std::vector<Edge *> rails(superEdgeToRails.at(superEdge).begin(), superEdgeToRails.at(superEdge).end());
+    size_t split = 0;
+    while (rails[split]->getDest()->getId() != station) split++;
+
+    removeSuperEdge(superEdge);
+    stationToSuperEdge.erase(station);
+    graph.addVertex(station);
+    residualGraph.addVertex(station);
+    addSuperEdge(rails.front()->getOrig(), rails[split]->getDest(), {rails.begin(), rails.begin() + (long) split + 1});
+    addSuperEdge(rails[split + 1]->getOrig(), rails.back()->getDest(), {rails.begin() + (long) split + 1, rails.end()});
+    splitStations++;
+}
+
+/**
+ * Makes sure the given stations are vertices of the contracted Graph, splitting the chains they had been contracted
+ * into. Split stations add up over the queries, so once they outnumber a quarter of the stations the contracted Graph
+ * was built with, it is rebuilt instead, keeping only the given stations. Stations of chains that loop back to their
+ * only kept station belong to no super-edge, and also make it rebuild
+ * Time Complexity: O(size(stations)) (average case) if every station is kept | O(n) for each contracted station, n
+ * being the length of its chain | O(|V|+|E|) amortized over the |V|/4 splits that precede a rebuild
+ * @param stations - Ids of the stations to keep
+ */
+void ContractedGraph::keepStations(const std::list<std::string> &stations) {
+    std::vector<std::string> contracted;
+    bool rebuild = false;
+    for (const std::string &s: stations) {
+        if (graph.findVertex(s) != nullptr || original->findVertex(s) == nullptr) continue;
+        contracted.push_back(s);
+        if (stationToSuperEdge.find(s) == stationToSuperEdge.end()) rebuild = true;
+    }
+    if (contracted.empty()) return;
+    if (rebuild || 4 * (splitStations + contracted.size()) > builtStations) {
+        build(*original, {stations.begin(), stations.end()});
+        return;
+    }
+    for (const std::string &s: contracted) {
+        if (graph.findVertex(s) == nullptr) splitChain(s); //The same station may be listed twice
+    }
+}
+
+/**
+ * Makes sure both stations of a rail of the original Graph are vertices of the contracted Graph, splitting the chains
+ * they had been contracted into. If one of them belongs to a chain that loops back to its only kept station, the
+ * contracted Graph is rebuilt instead, keeping both stations
+ * Time Complexity: O(n), n being the length of the chains | O(|V|+|E|) if it is rebuilt
+ * @param rail - Pointer to an Edge of the original Graph
+ * @return True if the contracted Graph was rebuilt, false otherwise
+ */
+bool ContractedGraph::keepEndpoints(Edge *rail) {
+    const std::string &orig = rail->getOrig()->getId();
+    const std::string &dest = rail->getDest()->getId();
+    for (const std::string &s: {orig, dest}) {
+        if (graph.findVertex(s) == nullptr && stationToSuperEdge.find(s) == stationToSuperEdge.end()) {
+            build(*original, {orig, dest});
+            return true;
+        }
+    }
+    for (const std::string &s: {orig, dest}) {
+        if (graph.findVertex(s) == nullptr) splitChain(s);
+    }
+    return false;
+}
+
+/**
+ * Adds a station just added to the original Graph, without rails, as a vertex of the contracted Graph
+ * Time Complexity: O(1) (average case)
+ * @param station - Id of the station
+ */
+void ContractedGraph::addStation(const std::string &station) {
+    graph.addVertex(station);
+    residualGraph.addVertex(station);
+}
+
+/**
+ * Adds a rail just added to the original Graph as a super-edge of its own, after splitting the chains of its stations.
+ * Stations left with two rails are not contracted again until the next build
+ * Time Complexity: O(n), n being the length of the chains of the rail's stations | O(|V|+|E|) if it is rebuilt
+ * @param rail - Pointer to either direction of the new Edge of the original Graph
+ */
+void ContractedGraph::addRail(Edge *rail) {
+    if (keepEndpoints(rail)) return; //Rebuilt with the rail
+    addSuperEdge(rail->getOrig(), rail->getDest(), {rail});
+}
+
+/**
+ * Removes a rail of the original Graph from the contracted Graph, after splitting the chains of its stations so that
+ * the rail is a super-edge of its own. Must be called before the rail is removed from the original Graph
+ * Time Complexity: O(n), n being the length of the chains of the rail's stations | O(|V|+|E|) if it is rebuilt
+ * @param rail - Pointer to either direction of the Edge of the original Graph
+ */
+void ContractedGraph::removeRail(Edge *rail) {
+    keepEndpoints(rail);
+    Edge *superEdge = findSuperEdge(rail);
+    if (superEdge != nullptr) removeSuperEdge(superEdge);
+    railToSuperEdge.erase(rail);
+    railToSuperEdge.erase(rail->getReverse());
+}
+
+/**
+ * Finds the super-edge that contains a given rail of the original Graph
+ * Time Complexity: O(1) (average case)
+ * @param rail - Pointer to the original Edge
+ * @return Pointer to the super-edge with the same direction as rail, or nullptr if the rail can never carry flow
+ */
+Edge *ContractedGraph::findSuperEdge(Edge *rail) const {
+    auto it = railToSuperEdge.find(rail);
+    if (it == railToSuperEdge.end()) return nullptr;
+    return it->second;
+}
+
+/**
+ * Finds the rails of the original Graph that a super-edge stands for
+ * Time Complexity: O(n), n being the length of the chain
+ * @param superEdge - Pointer to an Edge of the contracted Graph
+ * @return Vector with pointers to the original Edges, in order from the super-edge's origin to its destination
+ */
+std::vector<Edge *> ContractedGraph::expandEdge(Edge *superEdge) const {
+    auto it = superEdgeToRails.find(superEdge);
+    if (it == superEdgeToRails.end()) return {};
+    return {it->second.begin(), it->second.end()};
+}
+
+/**
+ * Finds the stations of the original Graph that were contracted into a super-edge
+ * Time Complexity: O(n), n being the length of the chain
+ * @param superEdge - Pointer to an Edge of the contracted Graph
+ * @return Vector with the ids of the contracted stations, in order from the super-edge's origin to its destination
+ */
+std::vector<std::string> ContractedGraph::expandStations(Edge *superEdge) const {
+    auto it = superEdgeToStations.find(superEdge);
+    if (it == superEdgeToStations.end()) return {};
+    return {it->second.begin(), it->second.end()};
+}
+
+/**
+ * Translates a vector of original rails into the super-edges that contain them, without repetitions
+ * Time Complexity: O(size(rails)) (average case)
+ * @param rails - Vector of pointers to original Edges
+ * @return Vector of pointers to the corresponding super-edges
+ */
+std::vector<Edge *> ContractedGraph::contractEdges(const std::vector<Edge *> &rails) const {
+    std::vector<Edge *> result;
+    std::unordered_set<Edge *> seen;
+    for (Edge *rail: rails) {
+        Edge *superEdge = findSuperEdge(rail);
+        if (superEdge != nullptr && seen.insert(superEdge).second && seen.insert(superEdge->getReverse()).second)
+            result.push_back(superEdge);
+    }
+    return result;
+}
+
+/**
+ * Copies the flow computed on every super-edge by the last query onto the rails of the original Graph
+ * Time Complexity: O(|E|)
+ */
+void ContractedGraph::expandFlow() const {
+    for (Vertex const *v: original->getVertexSet()) {
+        for (Edge *e: v->getAdj()) e->setFlow(0);
+    }
+    for (const auto &[superEdge, rails]: superEdgeToRails) {
+        for (Edge *e: rails) e->setFlow(superEdge->getFlow());
+    }
+}
+
+/**
+ * Edmonds-Karp algorithm run on the contracted network
+ * Time Complexity: O(|VE²|), for the contracted Graph's V and E
+ * @param source - List of ids of the source Vertex(es)
+ * @param target - Id of the target Vertex
+ * @return unsigned int representing computed value of max flow
+ */
+unsigned int ContractedGraph::edmondsKarp(const std::list<std::string> &source, const std::string &target) {
+    std::list<std::string> stations = source;
+    stations.push_back(target);
+    keepStations(stations);
+    return graph.edmondsKarp(source, target, residualGraph);
+}
+
+/**
+ * Cycle-cancelling min cost max flow run on the contracted network
+ * @param source - Id of the source Vertex
+ * @param target - Id of the target Vertex
+ * @return A pair of unsigned ints representing the value of the max flow and its min cost
+ */
+std::pair<unsigned int, unsigned int>
+ContractedGraph::minCostMaxFlow(const std::string &source, const std::string &target) {
+    keepStations({source, target});
+    return graph.minCostMaxFlow(source, target, residualGraph);
+}
+
+/**
+ * Calculates the maximum flow on the contracted network before and after deactivating a set of original rails. A
+ * failed rail takes its whole chain out of service
+ * Time Complexity: O(|VE²|), for the contracted Graph's V and E
+ * @param rails - Vector of pointers to the original Edges to be deactivated
+ * @param source - List of ids of source vertexes
+ * @param target - Id of the target Vertex
+ * @return A pair with the max flow before deactivating the Edges and after
+ */
+std::pair<unsigned int, unsigned int>
+ContractedGraph::maxFlowDeactivatedEdges(const std::vector<Edge *> &rails, const std::list<std::string> &source,
+                                         const std::string &target) {
+    std::list<std::string> stations = source;
+    stations.push_back(target);
+    keepStations(stations);
+    return graph.maxFlowDeactivatedEdges(contractEdges(rails), source, target, residualGraph);
+}
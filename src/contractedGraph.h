@@ -0,0 +1,92 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_CONTRACTEDGRAPH_H
+#define RAILWAYMANAGEMENT_CONTRACTEDGRAPH_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "graph.h"
+
+/**
+ * Compressed view of a railway network in which every chain of stations with exactly two neighbours is replaced by a
+ * single super-edge, whose capacity is the minimum capacity of the chain and whose cost is the sum of its costs
+ */
+class ContractedGraph {
+  private:
+    Graph graph;
+    Graph residualGraph;
+    const Graph *original = nullptr;
+    CountedSet<std::string, MemoryCategory::CONTRACTION> pinned; // stations that must never be contracted
+    // super-edge -> original edges, in order
+    CountedMap<Edge *, CountedVector<Edge *, MemoryCategory::CONTRACTION>, MemoryCategory::CONTRACTION>
+            superEdgeToRails;
+    // original edge -> super-edge with the same direction
+    CountedMap<Edge *, Edge *, MemoryCategory::CONTRACTION> railToSuperEdge;
+    // super-edge -> contracted stations
+    CountedMap<Edge *, CountedVector<std::string, MemoryCategory::CONTRACTION>, MemoryCategory::CONTRACTION>
+            superEdgeToStations;
+    // contracted station -> super-edge whose chain goes through it, in the direction of its rails
+    CountedMap<std::string, Edge *, MemoryCategory::CONTRACTION> stationToSuperEdge;
+    unsigned int builtStations = 0; // stations of the contracted Graph when it was built
+    unsigned int splitStations = 0; // stations kept by splitting their chain since it was built
+
+    [[nodiscard]] bool isContractible(const Vertex *v) const;
+
+    void contractChain(Edge *first, std::unordered_set<Edge *> &processed);
+
+    void addSuperEdge(Vertex *orig, Vertex *dest, const std::vector<Edge *> &rails);
+
+    void removeSuperEdge(Edge *superEdge);
+
+    void splitChain(const std::string &station);
+
+    bool keepEndpoints(Edge *rail);
+
+  public:
+    ContractedGraph();
+
+    void build(const Graph &originalGraph, const std::unordered_set<std::string> &keep = {});
+
+    void keepStations(const std::list<std::string> &stations);
+
+    void updateRail(Edge *rail);
+
+    void addStation(const std::string &station);
+
+    void addRail(Edge *rail);
+
+    void removeRail(Edge *rail);
+
+    [[nodiscard]] const Graph &getGraph() const;
+
+    [[nodiscard]] unsigned int getNumVertex() const;
+
+    [[nodiscard]] unsigned int getTotalEdges() const;
+
+    [[nodiscard]] Edge *findSuperEdge(Edge *rail) const;
+
+    [[nodiscard]] std::vector<Edge *> expandEdge(Edge *superEdge) const;
+
+    [[nodiscard]] std::vector<std::string> expandStations(Edge *superEdge) const;
+
+    [[nodiscard]] std::vector<Edge *> contractEdges(const std::vector<Edge *> &rails) const;
+
+    void expandFlow() const;
+
+    unsigned int edmondsKarp(const std::list<std::string> &source, const std::string &target);
+
+    std::pair<unsigned int, unsigned int> minCostMaxFlow(const std::string &source, const std::string &target);
+
+    std::pair<unsigned int, unsigned int>
+    maxFlowDeactivatedEdges(const std::vector<Edge *> &rails, const std::list<std::string> &source,
+                            const std::string &target);
+};
+
+
+#endif //RAILWAYMANAGEMENT_CONTRACTEDGRAPH_H
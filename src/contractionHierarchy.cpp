@@ -0,0 +1,403 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "contractionHierarchy.h"
+#include "queryStats.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace {
+    typedef std::pair<unsigned int, unsigned int> Label; // (length, station)
+    typedef std::priority_queue<Label, std::vector<Label>, std::greater<>> MinQueue;
+
+    // Stations a witness search may settle before giving up, adding the shortcut even if it might not be needed. The
+    // importance of a station is only an estimate, so a shorter search is enough for it
+    const unsigned int WITNESS_SETTLE_LIMIT = 500;
+    const unsigned int ESTIMATE_SETTLE_LIMIT = 30;
+
+    /**
+     * Edge of the remaining network, seen from one of its endpoints
+     */
+    struct Neighbour {
+        unsigned int station;
+        unsigned int length;
+        unsigned int edge;
+    };
+
+    /**
+     * Remaining network while the hierarchy is built: every edge created so far and, per station, its neighbours that
+     * weren't contracted yet, through the shortest edge to each of them
+     */
+    struct Contraction {
+        std::vector<unsigned int> endpoint1, endpoint2, length, rail, middle, first, second;
+        std::vector<bool> replaced;
+        std::vector<std::vector<Neighbour>> adjacency;
+        std::vector<bool> contracted;
+        std::vector<unsigned int> contractedNeighbours;
+        // witness searches: labels and targets are only valid if their stamp is the current round
+        std::vector<unsigned int> distance, stamp, target;
+        std::vector<Label> heap;
+        unsigned int round = 0;
+        // shortcuts found for the last station, as pairs of its neighbours at their ends
+        std::vector<std::pair<Neighbour, Neighbour>> found;
+
+        explicit Contraction(unsigned int numStations) : adjacency(numStations), contracted(numStations, false),
+                                                         contractedNeighbours(numStations, 0), distance(numStations),
+                                                         stamp(numStations, 0), target(numStations, 0) {}
+
+        void reserve(size_t numEdges) {
+            for (std::vector<unsigned int> *field: {&endpoint1, &endpoint2, &length, &rail, &middle, &first, &second})
+                field->reserve(numEdges);
+            replaced.reserve(numEdges);
+        }
+
+        /**
+         * Adds an edge between two stations, unless they already have one at least as short. A longer one is replaced
+         */
+        void addEdge(unsigned int station1, unsigned int station2, unsigned int edgeLength, unsigned int edgeRail,
+                     unsigned int edgeMiddle, unsigned int edgeFirst, unsigned int edgeSecond) {
+            auto existing = std::find_if(adjacency[station1].begin(), adjacency[station1].end(),
+                                         [station2](const Neighbour &n) { return n.station == station2; });
+            if (existing != adjacency[station1].end() && existing->length <= edgeLength) return;
+            auto edge = (unsigned int) endpoint1.size();
+            endpoint1.push_back(station1);
+            endpoint2.push_back(station2);
+            length.push_back(edgeLength);
+            rail.push_back(edgeRail);
+            middle.push_back(edgeMiddle);
+            first.push_back(edgeFirst);
+            second.push_back(edgeSecond);
+            replaced.push_back(false);
+            if (existing != adjacency[station1].end()) {
+                replaced[existing->edge] = true;
+                *existing = {station2, edgeLength, edge};
+                for (Neighbour &neighbour: adjacency[station2])
+                    if (neighbour.station == station1) neighbour = {station1, edgeLength, edge};
+            } else {
+                adjacency[station1].push_back({station2, edgeLength, edge});
+                adjacency[station2].push_back({station1, edgeLength, edge});
+            }
+        }
+
+        /**
+         * Dijkstra's algorithm over the remaining network without a station, until the targets are settled, the
+         * maximum distance is reached or settleLimit stations were settled. The distances found are valid for the
+         * current round
+         */
+        void witnessSearch(unsigned int source, unsigned int excluded, unsigned int maxDistance, unsigned int targets,
+                           unsigned int settleLimit) {
+            round++;
+            heap.clear();
+            distance[source] = 0;
+            stamp[source] = round;
+            heap.emplace_back(0, source);
+            unsigned int settled = 0;
+            while (!heap.empty() && settled < settleLimit && targets > 0) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+                auto [label, station] = heap.back();
+                heap.pop_back();
+                if (label > distance[station]) continue; //Outdated entry
+                if (label > maxDistance) break;
+                settled++;
+                if (target[station] == round) targets--;
+                for (const Neighbour &neighbour: adjacency[station]) {
+                    if (neighbour.station == excluded) continue;
+                    unsigned int through = label + neighbour.length;
+                    if (stamp[neighbour.station] == round && through >= distance[neighbour.station]) continue;
+                    distance[neighbour.station] = through;
+                    stamp[neighbour.station] = round;
+                    heap.emplace_back(through, neighbour.station);
+                    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                }
+            }
+        }
+
+        /**
+         * Finds the shortcuts needed to contract a station: one per pair of its neighbours whose shortest route goes
+         * through it, as far as witness searches of up to settleLimit stations can tell. They are stored in found
+         */
+        void findShortcuts(unsigned int station, unsigned int settleLimit) {
+            found.clear();
+            const std::vector<Neighbour> &neighbours = adjacency[station];
+            unsigned int longest = 0;
+            for (const Neighbour &neighbour: neighbours) longest = std::max(longest, neighbour.length);
+            for (size_t i = 0; i + 1 < neighbours.size(); i++) {
+                for (size_t j = i + 1; j < neighbours.size(); j++) target[neighbours[j].station] = round + 1;
+                witnessSearch(neighbours[i].station, station, neighbours[i].length + longest,
+                              (unsigned int) (neighbours.size() - i - 1), settleLimit);
+                for (size_t j = i + 1; j < neighbours.size(); j++) {
+                    unsigned int through = neighbours[i].length + neighbours[j].length;
+                    if (stamp[neighbours[j].station] != round || distance[neighbours[j].station] > through)
+                        found.emplace_back(neighbours[i], neighbours[j]);
+                }
+            }
+        }
+
+        /**
+         * Importance of a station, the stations being contracted from the least important: the number of shortcuts
+         * its contraction adds minus the edges it removes, plus its contracted neighbours, to spread the contractions
+         * evenly over the network
+         */
+        int priority(unsigned int station) {
+            findShortcuts(station, ESTIMATE_SETTLE_LIMIT);
+            return (int) found.size() - (int) adjacency[station].size() + (int) contractedNeighbours[station];
+        }
+
+        /**
+         * Removes a station from the remaining network, adding the shortcuts that keep the shortest routes between
+         * its neighbours
+         */
+        void contract(unsigned int station) {
+            findShortcuts(station, WITNESS_SETTLE_LIMIT);
+            for (auto [neighbour1, neighbour2]: found) {
+                addEdge(neighbour1.station, neighbour2.station, neighbour1.length + neighbour2.length,
+                        FlowNetwork::NOT_FOUND, station, neighbour1.edge, neighbour2.edge);
+            }
+            contracted[station] = true;
+            for (const Neighbour &neighbour: adjacency[station]) {
+                std::vector<Neighbour> &neighbourEdges = adjacency[neighbour.station];
+                neighbourEdges.erase(std::find_if(neighbourEdges.begin(), neighbourEdges.end(),
+                                                  [station](const Neighbour &n) { return n.station == station; }));
+                contractedNeighbours[neighbour.station]++;
+            }
+        }
+    };
+
+    /**
+     * Labels of a route query, reused across the queries of a thread. A label is only valid if its stamp is the
+     * current round, so the vectors are never cleared
+     */
+    struct RouteSearch {
+        std::vector<unsigned int> stamp;
+        std::vector<unsigned int> length[2]; // from the source (0) and from the target (1)
+        std::vector<unsigned int> viaEdge[2];
+        unsigned int round = 0;
+
+        void start(unsigned int numStations) {
+            if (stamp.size() < numStations) {
+                stamp.resize(numStations, 0);
+                for (unsigned int direction = 0; direction < 2; direction++) {
+                    length[direction].resize(numStations);
+                    viaEdge[direction].resize(numStations);
+                }
+            }
+            round++;
+        }
+
+        void touch(unsigned int station) {
+            if (stamp[station] == round) return;
+            stamp[station] = round;
+            length[0][station] = length[1][station] = FlowNetwork::NOT_FOUND;
+            viaEdge[0][station] = viaEdge[1][station] = FlowNetwork::NOT_FOUND;
+        }
+
+        [[nodiscard]] unsigned int lengthOf(unsigned int direction, unsigned int station) const {
+            return stamp[station] == round ? length[direction][station] : FlowNetwork::NOT_FOUND;
+        }
+    };
+}
+
+ContractionHierarchy::ContractionHierarchy() = default;
+
+/**
+ * Builds the hierarchy of a FlowNetwork right away. Must be called again after the capacities or costs of the
+ * FlowNetwork change
+ * Time Complexity: see contract
+ * @param flowNetwork - Network whose stations and rails are contracted
+ * @param metric - Whether routes are measured by cost or by number of rails
+ */
+void ContractionHierarchy::build(const FlowNetwork &flowNetwork, RouteMetric metric) {
+    lazyNetwork = nullptr;
+    lazyBuild.reset();
+    contract(flowNetwork, metric);
+}
+
+/**
+ * Discards the hierarchy and has the first query build it from a FlowNetwork, which must outlive it. Concurrent first
+ * queries wait for a single build. Must be called again after the capacities or costs of the FlowNetwork change, while
+ * no query runs
+ * Time Complexity: O(1)
+ * @param flowNetwork - Network whose stations and rails are contracted
+ * @param metric - Whether routes are measured by cost or by number of rails
+ */
+void ContractionHierarchy::buildLazily(const FlowNetwork &flowNetwork, RouteMetric metric) {
+    numStations = 0;
+    firstUpward.clear();
+    firstUpward.shrink_to_fit();
+    edges.clear();
+    edges.shrink_to_fit();
+    lazyNetwork = &flowNetwork;
+    lazyMetric = metric;
+    lazyBuild = std::make_unique<std::once_flag>();
+}
+
+/**
+ * Contracts the stations of a FlowNetwork by increasing importance, with lazy updates of the importances, and stores
+ * the resulting hierarchy. Rails without capacity are left out, as no train can use them, and of the parallel rails
+ * between two stations only the shortest is kept
+ * Time Complexity: O(|V| d² s log s) in practice, d being the degree of the stations when they are contracted and s
+ * the stations settled by a witness search (at most WITNESS_SETTLE_LIMIT)
+ * @param flowNetwork - Network whose stations and rails are contracted
+ * @param metric - Whether routes are measured by cost or by number of rails
+ */
+void ContractionHierarchy::contract(const FlowNetwork &flowNetwork, RouteMetric metric) const {
+    numStations = flowNetwork.getNumStations();
+    Contraction contraction(numStations);
+    contraction.reserve(2 * flowNetwork.getNumRails());
+    for (unsigned int rail = 0; rail < flowNetwork.getNumRails(); rail++) {
+        unsigned int station1 = flowNetwork.arcTail(2 * rail), station2 = flowNetwork.arcHead(2 * rail);
+        if (flowNetwork.getRailCapacity(rail) == 0 || station1 == station2) continue;
+        contraction.addEdge(station1, station2, flowNetwork.railLength(rail, metric), rail, FlowNetwork::NOT_FOUND,
+                            FlowNetwork::NOT_FOUND, FlowNetwork::NOT_FOUND);
+    }
+
+    //Contracts the least important station, unless its importance grew past the next one's since it was computed
+    std::vector<int> priority(numStations);
+    std::priority_queue<std::pair<int, unsigned int>, std::vector<std::pair<int, unsigned int>>, std::greater<>> queue;
+    for (unsigned int station = 0; station < numStations; station++) {
+        priority[station] = contraction.priority(station);
+        queue.emplace(priority[station], station);
+    }
+    std::vector<unsigned int> rank(numStations);
+    std::vector<Neighbour> neighbours;
+    unsigned int contracted = 0;
+    while (!queue.empty()) {
+        auto [stationPriority, station] = queue.top();
+        queue.pop();
+        if (contraction.contracted[station] || stationPriority != priority[station]) continue; //Outdated entry
+        priority[station] = contraction.priority(station);
+        if (!queue.empty() && priority[station] > queue.top().first) {
+            queue.emplace(priority[station], station);
+            continue;
+        }
+        neighbours.assign(contraction.adjacency[station].begin(), contraction.adjacency[station].end());
+        contraction.contract(station);
+        rank[station] = contracted++;
+        for (const Neighbour &neighbour: neighbours) {
+            priority[neighbour.station] = contraction.priority(neighbour.station);
+            queue.emplace(priority[neighbour.station], neighbour.station);
+        }
+    }
+
+    //Stores the edges that weren't replaced, grouped by their lower endpoint
+    std::vector<unsigned int> newIndex(contraction.endpoint1.size(), FlowNetwork::NOT_FOUND);
+    firstUpward.assign(numStations + 1, 0);
+    for (unsigned int edge = 0; edge < contraction.endpoint1.size(); edge++) {
+        if (contraction.replaced[edge]) continue;
+        firstUpward[std::min(contraction.endpoint1[edge], contraction.endpoint2[edge], [&rank](auto a, auto b) {
+            return rank[a] < rank[b];
+        }) + 1]++;
+    }
+    for (unsigned int station = 0; station < numStations; station++) firstUpward[station + 1] += firstUpward[station];
+    std::vector<unsigned int> next(firstUpward.begin(), firstUpward.end() - 1);
+    edges.assign(firstUpward[numStations], {});
+    for (unsigned int edge = 0; edge < contraction.endpoint1.size(); edge++) {
+        if (contraction.replaced[edge]) continue;
+        Shortcut shortcut = {contraction.endpoint1[edge], contraction.endpoint2[edge], contraction.length[edge],
+                             contraction.rail[edge], contraction.middle[edge], contraction.first[edge],
+                             contraction.second[edge]};
+        if (rank[shortcut.lower] > rank[shortcut.upper]) {
+            std::swap(shortcut.lower, shortcut.upper);
+            std::swap(shortcut.first, shortcut.second);
+        }
+        newIndex[edge] = next[shortcut.lower]++;
+        edges[newIndex[edge]] = shortcut;
+    }
+    for (Shortcut &shortcut: edges) {
+        if (shortcut.rail != FlowNetwork::NOT_FOUND) continue;
+        shortcut.first = newIndex[shortcut.first];
+        shortcut.second = newIndex[shortcut.second];
+    }
+}
+
+/**
+ * Expands an edge of the hierarchy into the rails it stands for, in order from one of its endpoints to the other
+ * Time Complexity: O(n), n being the number of rails of the edge
+ * @param edge - Index of the edge
+ * @param from - Endpoint of the edge the rails start at
+ * @param rails - Vector where the rails are appended
+ */
+void ContractionHierarchy::unpack(unsigned int edge, unsigned int from, std::vector<unsigned int> &rails) const {
+    const Shortcut &shortcut = edges[edge];
+    if (shortcut.rail != FlowNetwork::NOT_FOUND) {
+        rails.push_back(shortcut.rail);
+    } else if (from == shortcut.lower) {
+        unpack(shortcut.first, shortcut.lower, rails);
+        unpack(shortcut.second, shortcut.middle, rails);
+    } else {
+        unpack(shortcut.second, shortcut.upper, rails);
+        unpack(shortcut.first, shortcut.middle, rails);
+    }
+}
+
+/**
+ * Finds the cheapest route between two stations, with a bidirectional Dijkstra's algorithm that only climbs the
+ * hierarchy. Each side stops once its next station is farther than the best route found through a station reached
+ * from both sides
+ * Time Complexity: O(s log s + n), s being the stations of the hierarchy above the two stations (a few hundred in
+ * practice) and n the number of rails of the route, plus the build of a lazily built hierarchy on its first query
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @return Pair with the length of the cheapest route and its rails, in order from source to target, 0 and no rails if
+ * the stations are the same, or FlowNetwork::NOT_FOUND and no rails if they aren't connected, as is the case of the
+ * stations added to the FlowNetwork, without rails, after the hierarchy was built
+ */
+std::pair<unsigned int, std::vector<unsigned int>>
+ContractionHierarchy::shortestPath(unsigned int source, unsigned int target) const {
+    if (lazyBuild != nullptr) std::call_once(*lazyBuild, [this] { contract(*lazyNetwork, lazyMetric); });
+    if (source == target) return {0, {}};
+    if (source >= numStations || target >= numStations) return {FlowNetwork::NOT_FOUND, {}};
+    thread_local RouteSearch search;
+    search.start(numStations);
+    MinQueue queues[2];
+    unsigned int ends[2] = {source, target};
+    for (unsigned int direction = 0; direction < 2; direction++) {
+        search.touch(ends[direction]);
+        search.length[direction][ends[direction]] = 0;
+        queues[direction].emplace(0, ends[direction]);
+    }
+
+    unsigned int best = FlowNetwork::NOT_FOUND, meeting = FlowNetwork::NOT_FOUND;
+    unsigned long long arcsScanned = 0, relaxations = 0;
+    QUERY_STATS_ADD(searches, 1);
+    while (true) {
+        for (MinQueue &queue: queues)
+            if (!queue.empty() && queue.top().first >= best) queue = MinQueue();
+        if (queues[0].empty() && queues[1].empty()) break;
+        unsigned int direction = queues[0].empty() || (!queues[1].empty() && queues[1].top() < queues[0].top());
+        auto [label, station] = queues[direction].top();
+        queues[direction].pop();
+        if (label > search.length[direction][station]) continue; //Outdated entry
+        unsigned int opposite = search.lengthOf(1 - direction, station);
+        if (opposite != FlowNetwork::NOT_FOUND && label + opposite < best) {
+            best = label + opposite;
+            meeting = station;
+        }
+        for (unsigned int edge = firstUpward[station]; edge < firstUpward[station + 1]; edge++) {
+            arcsScanned++;
+            unsigned int upper = edges[edge].upper;
+            unsigned int through = label + edges[edge].length;
+            search.touch(upper);
+            if (through >= search.length[direction][upper]) continue;
+            relaxations++;
+            search.length[direction][upper] = through;
+            search.viaEdge[direction][upper] = edge;
+            queues[direction].emplace(through, upper);
+        }
+    }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+    QUERY_STATS_ADD(relaxations, relaxations);
+    if (meeting == FlowNetwork::NOT_FOUND) return {FlowNetwork::NOT_FOUND, {}};
+
+    std::vector<unsigned int> climb;
+    for (unsigned int station = meeting; station != source; station = edges[climb.back()].lower)
+        climb.push_back(search.viaEdge[0][station]);
+    std::vector<unsigned int> rails;
+    for (auto edge = climb.rbegin(); edge != climb.rend(); edge++) unpack(*edge, edges[*edge].lower, rails);
+    for (unsigned int station = meeting; station != target; station = edges[search.viaEdge[1][station]].lower)
+        unpack(search.viaEdge[1][station], station, rails);
+    return {best, rails};
+}
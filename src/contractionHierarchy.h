@@ -0,0 +1,65 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_CONTRACTIONHIERARCHY_H
+#define RAILWAYMANAGEMENT_CONTRACTIONHIERARCHY_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flowNetwork.h"
+#include "memoryAccounting.h"
+
+/**
+ * Contraction hierarchy of a railway network for the cheapest routes of a RouteMetric. The stations are contracted one
+ * by one, least important first, and every route through a contracted station that has no cheaper alternative is kept
+ * as a shortcut between its neighbours. A route query then only climbs the hierarchy, from both ends at once, settling
+ * a few hundred stations even on national networks, and unpacks the shortcuts of the best meeting point into rails.
+ * Contracting takes much longer than loading the network, so a hierarchy can also be built lazily, on its first query.
+ * Like FlowNetwork, it is immutable once built, so any number of threads can query it concurrently
+ */
+class ContractionHierarchy {
+  private:
+    /**
+     * Edge of the hierarchy between two stations: a rail, or a shortcut for the two edges through a station contracted
+     * before both of them
+     */
+    struct Shortcut {
+        unsigned int lower; // endpoint contracted first
+        unsigned int upper; // endpoint contracted last
+        unsigned int length;
+        unsigned int rail; // rail of the FlowNetwork, NOT_FOUND for shortcuts
+        unsigned int middle; // station bypassed by a shortcut
+        unsigned int first; // edge of a shortcut between its middle station and its lower endpoint
+        unsigned int second; // edge of a shortcut between its middle station and its upper endpoint
+    };
+
+    // mutable as a lazily built hierarchy fills them on its first query, under lazyBuild
+    mutable unsigned int numStations = 0;
+    // CSR offsets into edges, one per station plus one: the edges whose lower endpoint is the station
+    mutable CountedVector<unsigned int, MemoryCategory::ROUTE_HIERARCHIES> firstUpward;
+    mutable CountedVector<Shortcut, MemoryCategory::ROUTE_HIERARCHIES> edges;
+    // network and metric of a lazily built hierarchy, and the flag of its build, null if it is built eagerly
+    const FlowNetwork *lazyNetwork = nullptr;
+    RouteMetric lazyMetric = RouteMetric::COST;
+    std::unique_ptr<std::once_flag> lazyBuild;
+
+    void contract(const FlowNetwork &flowNetwork, RouteMetric metric) const;
+
+    void unpack(unsigned int edge, unsigned int from, std::vector<unsigned int> &rails) const;
+
+  public:
+    ContractionHierarchy();
+
+    void build(const FlowNetwork &flowNetwork, RouteMetric metric);
+
+    void buildLazily(const FlowNetwork &flowNetwork, RouteMetric metric);
+
+    [[nodiscard]] std::pair<unsigned int, std::vector<unsigned int>>
+    shortestPath(unsigned int source, unsigned int target) const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_CONTRACTIONHIERARCHY_H
@@ -0,0 +1,174 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "csvReader.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+/**
+ * Opens a CSV file, memory-mapping it read-only when possible and reading it into memory otherwise
+ * Time Complexity: O(1) if mapped | O(n) otherwise, n being the size of the file
+ * @param path - Path of the file
+ */
+CsvReader::CsvReader(const std::string &path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info{};
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void *mapping = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, (size_t) info.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(mapping);
+                size = (size_t) info.st_size;
+                mapped = true;
+            }
+        }
+        close(fd);
+        if (mapped) return;
+    }
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    buffer = contents.str();
+    data = buffer.data();
+    size = buffer.size();
+}
+
+/**
+ * Tokenises CSV contents already in memory, which must outlive this object
+ * Time Complexity: O(1)
+ * @param begin - Pointer to the first character
+ * @param length - Number of characters
+ */
+CsvReader::CsvReader(const char *begin, size_t length) : data(begin), size(length) {}
+
+CsvReader::~CsvReader() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<char *>(data), size);
+#endif
+}
+
+/**
+ * Checks if the file was opened successfully
+ * @return True if there is data to read, false otherwise
+ */
+bool CsvReader::isOpen() const {
+    return data != nullptr;
+}
+
+const char *CsvReader::getData() const {
+    return data;
+}
+
+size_t CsvReader::getSize() const {
+    return size;
+}
+
+size_t CsvReader::getPosition() const {
+    return position;
+}
+
+/**
+ * Reads the next non-empty record. The returned views are valid until the next call (for unescaped fields) or for the
+ * lifetime of the reader (for every other field)
+ * Time Complexity: O(n), n being the length of the record
+ * @param fields - Vector where the record's fields are stored
+ * @return True if a record was read, false at the end of the file
+ */
+bool CsvReader::nextRecord(std::vector<std::string_view> &fields) {
+    fields.clear();
+    unescaped.clear();
+
+    while (position < size) {
+        bool lastField = false;
+        if (data[position] == '"') { //Quoted field
+            size_t start = ++position;
+            bool escaped = false;
+            while (position < size) {
+                if (data[position] == '"') {
+                    if (position + 1 < size && data[position + 1] == '"') {
+                        escaped = true;
+                        position += 2;
+                        continue;
+                    }
+                    break;
+                }
+                position++;
+            }
+            std::string_view field(data + start, std::min(position, size) - start);
+            if (escaped) {
+                std::string &copy = unescaped.emplace_back();
+                for (size_t i = 0; i < field.size(); i++) {
+                    copy.push_back(field[i]);
+                    if (field[i] == '"') i++;
+                }
+                field = copy;
+            }
+            fields.push_back(field);
+            position++; //Skip closing "
+            while (position < size && data[position] != ',' && data[position] != '\n') position++; //Ignore stray text
+        } else {
+            size_t start = position;
+            while (position < size && data[position] != ',' && data[position] != '\n') position++;
+            size_t end = position;
+            if (end > start && data[end - 1] == '\r' && (end == size || data[end] == '\n')) end--;
+            fields.emplace_back(data + start, end - start);
+        }
+
+        if (position >= size || data[position] == '\n') lastField = true;
+        position++; //Skip , or \n
+        if (!lastField && position >= size) { //Record ends with an empty field
+            fields.emplace_back();
+            return true;
+        }
+        if (lastField) {
+            if (fields.size() == 1 && fields[0].empty()) { //Blank line
+                fields.clear();
+                continue;
+            }
+            return true;
+        }
+    }
+    return !fields.empty();
+}
+
+/**
+ * Splits CSV contents into chunks of roughly equal size that start and end at record boundaries, so that each chunk
+ * can be tokenised independently. Line breaks inside quoted fields are never used as boundaries
+ * Time Complexity: O(n), n being the length of the contents
+ * @param begin - Pointer to the first character, which must start a record
+ * @param length - Number of characters
+ * @param chunks - Maximum number of chunks
+ * @return Vector with the [first, second) offsets of each non-empty chunk, in order
+ */
+std::vector<std::pair<size_t, size_t>> CsvReader::splitRecords(const char *begin, size_t length, unsigned int chunks) {
+    std::vector<std::pair<size_t, size_t>> result;
+    size_t start = 0;
+    size_t position = 0;
+    bool quoted = false;
+    for (unsigned int i = 1; i <= chunks && start < length; i++) {
+        size_t target = i == chunks ? length : std::max(start, length / chunks * i);
+        while (position < length && (position < target || quoted || (position > 0 && begin[position - 1] != '\n'))) {
+            if (begin[position] == '"') quoted = !quoted;
+            position++;
+        }
+        if (position > start) result.emplace_back(start, position);
+        start = position;
+    }
+    return result;
+}
@@ -0,0 +1,52 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_CSVREADER_H
+#define RAILWAYMANAGEMENT_CSVREADER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+
+/**
+ * Single-pass RFC 4180 CSV tokeniser over a memory-mapped file. Fields are returned as string_views into the mapping,
+ * so no field is copied unless it contains escaped ("") quotes. Records may end with \n or \r\n, and quoted fields may
+ * contain separators and line breaks
+ */
+class CsvReader {
+  private:
+    const char *data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+    bool mapped = false;
+    std::string buffer; // file contents, when the file can't be memory-mapped
+    std::deque<std::string> unescaped; // storage for the fields of the current record that had escaped quotes
+
+  public:
+    explicit CsvReader(const std::string &path);
+
+    CsvReader(const char *begin, size_t length);
+
+    CsvReader(const CsvReader &) = delete;
+
+    CsvReader &operator=(const CsvReader &) = delete;
+
+    ~CsvReader();
+
+    [[nodiscard]] bool isOpen() const;
+
+    [[nodiscard]] const char *getData() const;
+
+    [[nodiscard]] size_t getSize() const;
+
+    [[nodiscard]] size_t getPosition() const;
+
+    bool nextRecord(std::vector<std::string_view> &fields);
+
+    static std::vector<std::pair<size_t, size_t>> splitRecords(const char *begin, size_t length, unsigned int chunks);
+};
+
+
+#endif //RAILWAYMANAGEMENT_CSVREADER_H
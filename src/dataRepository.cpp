@@ -4,169 +4,309 @@
 
 #include <iostream>
 #include "dataRepository.h"
+#include "networkSnapshot.h"
 
 using namespace std;
 
+const unsigned int DataRepository::NOT_FOUND = (unsigned int) -1;
+
 DataRepository::DataRepository() = default;
 
-const stationTable &DataRepository::getStations() const {
+const StationTable &DataRepository::getStations() const {
     return stations;
 }
 
-void DataRepository::setStations(const stationTable &stations) {
-    this->stations = stations;
-}
-
-const unordered_map<std::string, std::list<Station>> &DataRepository::getDistrictToStations() const {
-    return districtToStations;
-}
-
-void DataRepository::setDistrictToStations(const unordered_map<std::string, std::list<Station>> &districtToStations) {
-    DataRepository::districtToStations = districtToStations;
-}
-
-const unordered_map<std::string, std::list<Station>> &DataRepository::getMunicipalityToStations() const {
-    return municipalityToStations;
-}
-
-void DataRepository::setMunicipalityToStations(
-        const unordered_map<std::string, std::list<Station>> &municipalityToStations) {
-    DataRepository::municipalityToStations = municipalityToStations;
-}
-
-const unordered_map<std::string, std::list<Station>> &DataRepository::getTownshipToStations() const {
-    return townshipToStations;
+const SymbolTable &DataRepository::getSymbols() const {
+    return symbols;
 }
 
-void DataRepository::setTownshipToStations(const unordered_map<std::string, std::list<Station>> &townshipToStations) {
-    DataRepository::townshipToStations = townshipToStations;
+/**
+ * Gets the string a Symbol of the repository stands for, such as a station's name or district
+ * Time Complexity: O(1)
+ * @param symbol - Symbol to look up
+ * @return Interned string
+ */
+const string &DataRepository::getString(Symbol symbol) const {
+    return symbols.getString(symbol);
 }
 
 /**
- * Adds a new entry to the unordered_set of Stations, creating the corresponding Station object
+ * Adds a new Station, interning its attributes. If a Station with the same name already exists, it is left unchanged
  * Time Complexity: O(1) (average case) | O(size(stations)) (worst case)
  * @param name - Name of the station to be created
  * @param district - District of the Station to be created
  * @param municipality - Municipality of the Station to be created
  * @param township - Township of the Station to be created
  * @param line - Line of the station to be created
- * @return New Station object created
+ * @return Station stored under the given name
  */
 Station
 DataRepository::addStationEntry(const std::string &name, const std::string &district, const std::string &municipality,
                                 const std::string &township,
                                 const std::string &line) {
-    Station newStation = Station(name, district, municipality, township, line);
-    stations.insert(newStation);
-    return newStation;
+    Symbol nameSymbol = symbols.intern(name);
+    auto [it, inserted] = nameToStation.emplace(nameSymbol, (unsigned int) stations.size());
+    if (inserted) {
+        stations.emplace_back(nameSymbol, symbols.intern(district), symbols.intern(municipality),
+                              symbols.intern(township), symbols.intern(line));
+    }
+    return stations[it->second];
 }
 
 
 /**
- * Adds a new Station value to an entry in the districtToStations unordered_map
- * Time Complexity: O(1) (average case) | O(size(districtToStations)) (worst case)
- * @param district - District of the new Station
- * @param station - Station to add
+ * Rebuilds the table of every grouping from the attributes of the stations, with the groups in order of their first
+ * station and the stations of each group in the order they were added. Must be called after adding stations
+ * Time Complexity: O(n) (average case), n being the number of stations
  */
-void DataRepository::addStationToDistrictEntry(const string &district, const Station &station) {
-    districtToStations[district].push_back(station);
+void DataRepository::buildGroupings() {
+    for (unsigned int g = 0; g < NUM_GROUPINGS; g++) {
+        GroupingTable &table = groupings[g];
+        table = GroupingTable();
+        auto attribute = [g](const Station &station) {
+            switch ((Grouping) g) {
+                case Grouping::DISTRICT:
+                    return station.getDistrict();
+                case Grouping::MUNICIPALITY:
+                    return station.getMunicipality();
+                case Grouping::TOWNSHIP:
+                    return station.getTownship();
+                default:
+                    return station.getLine();
+            }
+        };
+
+        std::vector<unsigned int> stationGroup(stations.size());
+        for (unsigned int s = 0; s < stations.size(); s++) {
+            auto [it, inserted] = table.symbolToGroup.emplace(attribute(stations[s]), (unsigned int) table.groups.size());
+            if (inserted) table.groups.push_back(it->first);
+            stationGroup[s] = it->second;
+        }
+
+        table.offsets.assign(table.groups.size() + 1, 0);
+        for (unsigned int group: stationGroup) table.offsets[group + 1]++;
+        for (size_t i = 1; i < table.offsets.size(); i++) table.offsets[i] += table.offsets[i - 1];
+        table.stations.resize(stations.size());
+        std::vector<unsigned int> position(table.offsets.begin(), table.offsets.end() - 1);
+        for (unsigned int s = 0; s < stations.size(); s++) table.stations[position[stationGroup[s]]++] = s;
+    }
+}
+
+/**
+ * Loads the table of every grouping from a snapshot, as written after buildGroupings, instead of rebuilding it. Must be
+ * called right after the stations of the snapshot were added, in order and to an empty repository, so that the station
+ * indexes of the snapshot are the same as the ones of the repository
+ * Time Complexity: O(n+g) (average case), n being the number of stations and g the number of groups
+ * @param snapshot - Valid snapshot the stations were loaded from
+ */
+void DataRepository::loadGroupings(const NetworkSnapshot &snapshot) {
+    for (unsigned int g = 0; g < NUM_GROUPINGS; g++) {
+        GroupingTable &table = groupings[g];
+        table = GroupingTable();
+        for (uint32_t name: snapshot.getIndexArray(NetworkSnapshot::GROUP_NAMES + g)) {
+            Symbol group = symbols.intern(snapshot.getString(name));
+            table.symbolToGroup.emplace(group, (unsigned int) table.groups.size());
+            table.groups.push_back(group);
+        }
+        std::span<const uint32_t> offsets = snapshot.getIndexArray(NetworkSnapshot::GROUP_OFFSETS + g);
+        std::span<const uint32_t> members = snapshot.getIndexArray(NetworkSnapshot::GROUP_STATIONS + g);
+        table.offsets.assign(offsets.begin(), offsets.end());
+        table.stations.assign(members.begin(), members.end());
+    }
+}
+
+unsigned int DataRepository::getNumGroups(Grouping grouping) const {
+    return (unsigned int) groupings[(unsigned int) grouping].groups.size();
+}
+
+Symbol DataRepository::getGroupName(Grouping grouping, unsigned int group) const {
+    return groupings[(unsigned int) grouping].groups[group];
 }
 
 /**
- * Adds a new Station value to an entry in the municipalityToStations unordered_map
- * Time Complexity: O(1) (average case) | O(size(municipalityToStations)) (worst case)
- * @param municipality - Municipality of the new Station
- * @param station - Station to add
+ * Finds the index of a group, such as a district, by its name
+ * Time Complexity: O(n) (average case), n being the length of the name
+ * @param grouping - Grouping the group belongs to
+ * @param name - Name of the group
+ * @return Index of the group, or NOT_FOUND if no station belongs to such a group
  */
-void DataRepository::addStationToMunicipalityEntry(const std::string &municipality, const Station &station) {
-    municipalityToStations[municipality].push_back(station);
+unsigned int DataRepository::findGroup(Grouping grouping, const std::string &name) const {
+    const GroupingTable &table = groupings[(unsigned int) grouping];
+    auto it = table.symbolToGroup.find(symbols.find(name));
+    return it == table.symbolToGroup.end() ? NOT_FOUND : it->second;
 }
 
 /**
- * Adds a new Station value to an entry in the townshipToStations unordered_map
- * Time Complexity: O(1) (average case) | O(size(townshipToStations)) (worst case)
- * @param township - Township of the new Station
- * @param station - Station to add
+ * Gets the stations of a group, without copying them
+ * Time Complexity: O(1)
+ * @param grouping - Grouping the group belongs to
+ * @param group - Index of the group
+ * @return Span with the indexes of the group's stations, valid until the groupings are rebuilt
  */
-void DataRepository::addStationToTownshipEntry(const std::string &township, const Station &station) {
-    townshipToStations[township].push_back(station);
+std::span<const unsigned int> DataRepository::getGroupStations(Grouping grouping, unsigned int group) const {
+    const GroupingTable &table = groupings[(unsigned int) grouping];
+    return {table.stations.data() + table.offsets[group], table.offsets[group + 1] - table.offsets[group]};
 }
 
+/**
+ * Finds the k groups with the highest average of some value of their stations, without averaging it over every group.
+ * Averaging a bound of the value gives a bound of each group's average, so the groups are evaluated in decreasing order
+ * of their bounds, and the search stops as soon as k exact averages are greater than the bound of the next group, which
+ * no group left can then beat
+ * Time Complexity: O(|V| + g log g + k e) plus the evaluations, g being the number of groups and e the number of groups
+ * evaluated
+ * @param grouping - Attribute by which the stations are grouped
+ * @param k - Number of groups wanted
+ * @param stationBound - Upper bound of the value of a station, given its index in getStations
+ * @param groupAverages - Exact averages of the value over the stations of each of a batch of groups
+ * @param batchSize - Maximum number of groups evaluated together, e.g. to spread them over threads
+ * @return An ordered vector of at most k pairs with decreasing average (second element), identified by the group's name
+ * (first element). Groups with the same average keep their order in the repository
+ */
+std::vector<std::pair<std::string, double>>
+DataRepository::topGroups(Grouping grouping, unsigned int k, const std::function<double(unsigned int)> &stationBound,
+                          const std::function<std::vector<double>(const std::vector<unsigned int> &)> &groupAverages,
+                          unsigned int batchSize) const {
+    std::vector<std::pair<double, unsigned int>> bounds; // (bound of the average, group)
+    for (unsigned int group = 0; group < getNumGroups(grouping); group++) {
+        std::span<const unsigned int> groupStations = getGroupStations(grouping, group);
+        double bound = 0;
+        for (unsigned int station: groupStations) bound += stationBound(station);
+        bounds.emplace_back(bound / (double) groupStations.size(), group);
+    }
+    std::stable_sort(bounds.begin(), bounds.end(), [](const auto &left, const auto &right) {
+        return left.first > right.first;
+    });
+
+    //Best exact averages so far, sorted by decreasing average and then by group
+    std::vector<std::pair<double, unsigned int>> best;
+    auto better = [](const std::pair<double, unsigned int> &left, const std::pair<double, unsigned int> &right) {
+        return left.first > right.first || (left.first == right.first && left.second < right.second);
+    };
+    auto beaten = [&best, k](double bound) {
+        return best.size() == k && (k == 0 || best.back().first > bound);
+    };
+    size_t next = 0;
+    while (next < bounds.size() && !beaten(bounds[next].first)) {
+        std::vector<unsigned int> batch;
+        for (; next < bounds.size() && batch.size() < std::max(1u, batchSize) && !beaten(bounds[next].first); next++)
+            batch.push_back(bounds[next].second);
+        std::vector<double> averages = groupAverages(batch);
+        for (size_t i = 0; i < batch.size(); i++) {
+            std::pair<double, unsigned int> average = {averages[i], batch[i]};
+            best.insert(std::upper_bound(best.begin(), best.end(), average, better), average);
+            if (best.size() > k) best.pop_back();
+        }
+    }
+
+    std::vector<std::pair<std::string, double>> result;
+    for (const auto &[average, group]: best) result.emplace_back(getString(getGroupName(grouping, group)), average);
+    return result;
+}
 
 /**
  * Finds the Station object with the given name
- * Time Complexity: O(1) (average case) | O(size(stations)) (worst case)
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param name - Name of the Station to be returned
  * @return optional<Station> value which will contain the Station object, or be empty if no such Station was found
  */
-std::optional<Station> DataRepository::findStation(const string &name) {
+std::optional<Station> DataRepository::findStation(const string &name) const {
     std::optional<Station> result;
-    auto it = stations.find(Station(name));
-    if (it != stations.end()) result = *it;
+    auto it = nameToStation.find(symbols.find(name));
+    if (it != nameToStation.end()) result = stations[it->second];
     return result;
 }
 
+/**
+ * Finds the stations of a group by its name
+ * Time Complexity: O(n) (average case), n being the length of the name
+ * @param grouping - Grouping the group belongs to
+ * @param group - Name of the group
+ * @return Span with the indexes of the group's stations, empty if there is no such group
+ */
+std::span<const unsigned int> DataRepository::findStationsInGroup(Grouping grouping, const string &group) const {
+    unsigned int index = findGroup(grouping, group);
+    if (index == NOT_FOUND) return {};
+    return getGroupStations(grouping, index);
+}
+
 
 /**
- * Finds the Station objects with the given district
- * Time Complexity: O(1) (average case) | O(size(districtToStations)) (worst case)
+ * Finds the Stations with the given district
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param district - District whose Stations should be found
- * @return list<Station> containing the Stations in the given district
+ * @return Span with the indexes of the Stations in the given district
  */
-list<Station> DataRepository::findStationsInDistrict(const std::string &district) {
-    return districtToStations.at(district);
+span<const unsigned int> DataRepository::findStationsInDistrict(const std::string &district) const {
+    return findStationsInGroup(Grouping::DISTRICT, district);
 }
 
 /**
- * Finds the Station objects with the given municipality
- * Time Complexity: O(1) (average case) | O(size(municipalityToStations)) (worst case)
+ * Finds the Stations with the given municipality
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param municipality - Municipality whose Stations should be found
- * @return list<Station> containing the Stations in the given municipality
+ * @return Span with the indexes of the Stations in the given municipality
  */
-list<Station> DataRepository::findStationsInMunicipality(const std::string &municipality) {
-    return municipalityToStations.at(municipality);
+span<const unsigned int> DataRepository::findStationsInMunicipality(const std::string &municipality) const {
+    return findStationsInGroup(Grouping::MUNICIPALITY, municipality);
 }
 
 /**
- * Finds the Station objects with the given township
- * Time Complexity: O(1) (average case) | O(size(townshipToStations)) (worst case)
+ * Finds the Stations with the given township
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param township - Township whose Stations should be found
- * @return list<Station> containing the Stations in the given township
+ * @return Span with the indexes of the Stations in the given township
+ */
+span<const unsigned int> DataRepository::findStationsInTownship(const std::string &township) const {
+    return findStationsInGroup(Grouping::TOWNSHIP, township);
+}
+
+/**
+ * Finds the Stations on the given line
+ * Time Complexity: O(n) (average case), n being the length of the name
+ * @param line - Line whose Stations should be found
+ * @return Span with the indexes of the Stations on the given line
  */
-list<Station> DataRepository::findStationsInTownship(const std::string &township) {
-    return townshipToStations.at(township);
+span<const unsigned int> DataRepository::findStationsInLine(const std::string &line) const {
+    return findStationsInGroup(Grouping::LINE, line);
 }
 
 /**
  * Checks if the given district is valid, that is, if there is stored data referencing it
- * Time Complexity: O(1) (average case) | O(size(districtToStations)) (worst case)
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param district - District to be validated
  * @return true if the district is valid, false if it is not
  */
-bool DataRepository::checkValidDistrict(const std::string &district) {
-    return districtToStations.find(district) != districtToStations.end();
+bool DataRepository::checkValidDistrict(const std::string &district) const {
+    return findGroup(Grouping::DISTRICT, district) != NOT_FOUND;
 }
 
 /**
  * Checks if the given municipality is valid, that is, if there is stored data referencing it
- * Time Complexity: O(1) (average case) | O(size(municipalityToStations)) (worst case)
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param municipality - Municipality to be validated
  * @return true if the municipality is valid, false if it is not
  */
-bool DataRepository::checkValidMunicipality(const std::string &municipality) {
-    return municipalityToStations.find(municipality) != municipalityToStations.end();
+bool DataRepository::checkValidMunicipality(const std::string &municipality) const {
+    return findGroup(Grouping::MUNICIPALITY, municipality) != NOT_FOUND;
 }
 
 /**
  * Checks if the given township is valid, that is, if there is stored data referencing it
- * Time Complexity: O(1) (average case) | O(size(townshipToStations)) (worst case)
+ * Time Complexity: O(n) (average case), n being the length of the name
  * @param township - Township to be validated
  * @return true if the township is valid, false if it is not
  */
-bool DataRepository::checkValidTownship(const std::string &township) {
-    return townshipToStations.find(township) != townshipToStations.end();
+bool DataRepository::checkValidTownship(const std::string &township) const {
+    return findGroup(Grouping::TOWNSHIP, township) != NOT_FOUND;
 }
 
-
-
-
+/**
+ * Checks if the given line is valid, that is, if there is stored data referencing it
+ * Time Complexity: O(n) (average case), n being the length of the name
+ * @param line - Line to be validated
+ * @return true if the line is valid, false if it is not
+ */
+bool DataRepository::checkValidLine(const std::string &line) const {
+    return findGroup(Grouping::LINE, line) != NOT_FOUND;
+}
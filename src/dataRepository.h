@@ -5,63 +5,99 @@
 #ifndef RAILWAYMANAGEMENT_DATAREPOSITORY_H
 #define RAILWAYMANAGEMENT_DATAREPOSITORY_H
 
+#include <functional>
 #include <list>
+#include <vector>
+#include <span>
 #include <optional>
 #include <algorithm>
 #include "station.h"
+#include "symbolTable.h"
+#include "memoryAccounting.h"
+
+/**
+ * Attributes by which the stations of a DataRepository are grouped
+ */
+enum class Grouping : unsigned int {
+    DISTRICT, MUNICIPALITY, TOWNSHIP, LINE
+};
 
+/**
+ * Stations grouped by one attribute, in compressed sparse row form: the stations of group g are
+ * stations[offsets[g]] .. stations[offsets[g + 1] - 1], as indexes in DataRepository::getStations
+ */
+struct GroupingTable {
+    CountedVector<Symbol, MemoryCategory::GROUPINGS> groups; // name of each group
+    CountedMap<Symbol, unsigned int, MemoryCategory::GROUPINGS> symbolToGroup;
+    CountedVector<unsigned int, MemoryCategory::GROUPINGS> offsets;
+    CountedVector<unsigned int, MemoryCategory::GROUPINGS> stations;
+};
 
-class DataRepository {
+typedef CountedVector<Station, MemoryCategory::STATIONS> StationTable;
 
+class NetworkSnapshot;
+
+class DataRepository {
+public:
+    static const unsigned int NUM_GROUPINGS = 4;
 
 private:
-    stationTable stations;
-    std::unordered_map<std::string, std::list<Station>> districtToStations;
-    std::unordered_map<std::string, std::list<Station>> municipalityToStations;
-    std::unordered_map<std::string, std::list<Station>> townshipToStations;
+    SymbolTable symbols;
+    StationTable stations;
+    CountedMap<Symbol, unsigned int, MemoryCategory::STATIONS> nameToStation;
+    GroupingTable groupings[NUM_GROUPINGS];
+
+    [[nodiscard]] std::span<const unsigned int> findStationsInGroup(Grouping grouping, const std::string &group) const;
 
 public:
+    static const unsigned int NOT_FOUND;
+
     DataRepository();
 
-    const stationTable &getStations() const;
+    [[nodiscard]] const StationTable &getStations() const;
 
-    void setStations(const stationTable &Stations);
+    [[nodiscard]] const SymbolTable &getSymbols() const;
 
-    const std::unordered_map<std::string, std::list<Station>> &getDistrictToStations() const;
+    [[nodiscard]] const std::string &getString(Symbol symbol) const;
 
-    void setDistrictToStations(const std::unordered_map<std::string, std::list<Station>> &districtToStations);
+    [[nodiscard]] std::optional<Station> findStation(const std::string &name) const;
 
-    const std::unordered_map<std::string, std::list<Station>> &getTownshipToStations() const;
+    Station addStationEntry(const std::string &name, const std::string &district, const std::string &municipality,
+                            const std::string &township,
+                            const std::string &line);
 
-    void setTownshipToStations(const std::unordered_map<std::string, std::list<Station>> &townshipToStations);
+    void buildGroupings();
 
-    const std::unordered_map<std::string, std::list<Station>> &getMunicipalityToStations() const;
+    void loadGroupings(const NetworkSnapshot &snapshot);
 
-    void setMunicipalityToStations(const std::unordered_map<std::string, std::list<Station>> &municipalityToStations);
+    [[nodiscard]] unsigned int getNumGroups(Grouping grouping) const;
 
-    std::optional<Station> findStation(const std::string &name);
+    [[nodiscard]] Symbol getGroupName(Grouping grouping, unsigned int group) const;
 
-    Station addStationEntry(const std::string &name, const std::string &district, const std::string &municipality,
-                             const std::string &township,
-                             const std::string &line);
+    [[nodiscard]] unsigned int findGroup(Grouping grouping, const std::string &name) const;
+
+    [[nodiscard]] std::span<const unsigned int> getGroupStations(Grouping grouping, unsigned int group) const;
 
-    void addStationToDistrictEntry(const std::string &district, const Station &station);
+    [[nodiscard]] std::vector<std::pair<std::string, double>>
+    topGroups(Grouping grouping, unsigned int k, const std::function<double(unsigned int)> &stationBound,
+              const std::function<std::vector<double>(const std::vector<unsigned int> &)> &groupAverages,
+              unsigned int batchSize = 1) const;
 
-    void addStationToMunicipalityEntry(const std::string &municipality, const Station &station);
+    [[nodiscard]] std::span<const unsigned int> findStationsInDistrict(const std::string &district) const;
 
-    std::list<Station> findStationsInDistrict(const std::string &district);
+    [[nodiscard]] bool checkValidDistrict(const std::string &district) const;
 
-    bool checkValidDistrict(const std::string &district);
+    [[nodiscard]] bool checkValidMunicipality(const std::string &municipality) const;
 
-    bool checkValidMunicipality(const std::string &municipality);
+    [[nodiscard]] std::span<const unsigned int> findStationsInMunicipality(const std::string &municipality) const;
 
-    std::list<Station> findStationsInMunicipality(const std::string &municipality);
+    [[nodiscard]] std::span<const unsigned int> findStationsInTownship(const std::string &township) const;
 
-    std::list<Station> findStationsInTownship(const std::string &township);
+    [[nodiscard]] bool checkValidTownship(const std::string &township) const;
 
-    void addStationToTownshipEntry(const std::string &township, const Station &station);
+    [[nodiscard]] std::span<const unsigned int> findStationsInLine(const std::string &line) const;
 
-    bool checkValidTownship(const std::string &township);
+    [[nodiscard]] bool checkValidLine(const std::string &line) const;
 };
 
 
@@ -12,6 +12,20 @@ Edge::Edge(Vertex *orig, Vertex *dest, unsigned int capacity, Service service) {
     initializeCost();
 }
 
+/**
+ * Allocates an Edge, accounting its memory (see MemoryAccounting)
+ */
+void *Edge::operator new(size_t size) {
+    void *pointer = ::operator new(size);
+    MemoryAccounting::allocated(MemoryCategory::EDGES, size);
+    return pointer;
+}
+
+void Edge::operator delete(void *pointer, size_t size) {
+    MemoryAccounting::released(MemoryCategory::EDGES, size);
+    ::operator delete(pointer);
+}
+
 Vertex *Edge::getDest() const {
     return this->dest;
 }
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include "vertex.h"
+#include "memoryAccounting.h"
 
 class Vertex;
 
@@ -20,6 +21,10 @@ class Edge {
   public:
     Edge(Vertex *orig, Vertex *dest, unsigned int w, Service s);
 
+    static void *operator new(size_t size);
+
+    static void operator delete(void *pointer, size_t size);
+
     [[nodiscard]] Vertex *getDest() const;
 
     [[nodiscard]] unsigned int getCapacity() const;
@@ -0,0 +1,829 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "flowNetwork.h"
+#include "networkSnapshot.h"
+#include "parallel.h"
+#include "queryStats.h"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <set>
+
+const unsigned int FlowNetwork::NOT_FOUND = std::numeric_limits<unsigned int>::max();
+
+FlowNetwork::FlowNetwork() : firstArc({0}) {}
+
+/**
+ * Builds the snapshot of a Graph's stations and rails. Edges deactivated in the Graph are still included, since
+ * failures are expressed per query through a FailureMask
+ * Time Complexity: O(|V|+|E|) (average case)
+ * @param network - Graph to take the snapshot of. Its Edges must outlive this object, to be reported by the queries
+ */
+FlowNetwork::FlowNetwork(const Graph &network) {
+    std::vector<Vertex *> vertices = network.getVertexSet();
+    for (Vertex const *v: vertices) {
+        nameToStation[v->getId()] = (unsigned int) stationNames.size();
+        stationNames.push_back(v->getId());
+    }
+
+    std::vector<unsigned int> tails;
+    for (Vertex const *v: vertices) {
+        for (Edge *e: v->getAdj()) {
+            if (!std::less<Edge *>()(e, e->getReverse())) continue;
+            auto rail = (unsigned int) railCapacity.size();
+            railCapacity.push_back(e->getCapacity());
+            railCost.push_back(e->getCost());
+            railToEdge.push_back(e);
+            edgeToRail[e] = rail;
+            edgeToRail[e->getReverse()] = rail;
+            tails.push_back(nameToStation[v->getId()]);
+            tails.push_back(nameToStation[e->getDest()->getId()]);
+            heads.push_back(tails[2 * rail + 1]);
+            heads.push_back(tails[2 * rail]);
+        }
+    }
+
+    firstArc.assign(stationNames.size() + 1, 0);
+    for (unsigned int tail: tails) firstArc[tail + 1]++;
+    for (size_t i = 1; i < firstArc.size(); i++) firstArc[i] += firstArc[i - 1];
+    adjacentArcs.resize(tails.size());
+    std::vector<unsigned int> position(firstArc.begin(), firstArc.end() - 1);
+    for (unsigned int arc = 0; arc < tails.size(); arc++) adjacentArcs[position[tails[arc]]++] = arc;
+}
+
+/**
+ * Builds the FlowNetwork stored in a snapshot, by copying its CSR arrays instead of computing them from a Graph. The
+ * result is the same as the FlowNetwork the snapshot was written from, with the same station and rail indexes
+ * Time Complexity: O(|V|+|E|) (average case)
+ * @param snapshot - Valid snapshot the network was loaded from
+ * @param edges - Edges of the loaded network, indexed by their edge index in the snapshot (see SnapshotRail). They must
+ * outlive this object, to be reported by the queries
+ */
+FlowNetwork::FlowNetwork(const NetworkSnapshot &snapshot, const std::vector<Edge *> &edges) {
+    for (uint32_t station = 0; station < snapshot.getNumStations(); station++) {
+        std::string name(snapshot.getString(snapshot.getStation(station).name));
+        nameToStation[name] = station;
+        stationNames.push_back(std::move(name));
+    }
+
+    std::span<const uint32_t> arcs = snapshot.getIndexArray(NetworkSnapshot::FIRST_ARCS);
+    firstArc.assign(arcs.begin(), arcs.end());
+    arcs = snapshot.getIndexArray(NetworkSnapshot::ADJACENT_ARCS);
+    adjacentArcs.assign(arcs.begin(), arcs.end());
+    arcs = snapshot.getIndexArray(NetworkSnapshot::ARC_HEADS);
+    heads.assign(arcs.begin(), arcs.end());
+
+    for (uint32_t edge: snapshot.getIndexArray(NetworkSnapshot::RAIL_EDGES)) {
+        Edge *e = edges[edge];
+        auto rail = (unsigned int) railCapacity.size();
+        railCapacity.push_back(e->getCapacity());
+        railCost.push_back(e->getCost());
+        railToEdge.push_back(e);
+        edgeToRail[e] = rail;
+        edgeToRail[e->getReverse()] = rail;
+    }
+}
+
+/**
+ * Adds a station without rails, e.g. one just added to the Graph the network was built from
+ * Time Complexity: O(1) (average case)
+ * @param name - Name of the station
+ * @return Index of the station
+ */
+unsigned int FlowNetwork::addStation(const std::string &name) {
+    auto station = (unsigned int) stationNames.size();
+    nameToStation[name] = station;
+    stationNames.push_back(name);
+    firstArc.push_back(firstArc.back());
+    return station;
+}
+
+unsigned int FlowNetwork::getNumStations() const {
+    return (unsigned int) stationNames.size();
+}
+
+unsigned int FlowNetwork::getNumRails() const {
+    return (unsigned int) railCapacity.size();
+}
+
+/**
+ * Finds the index of the station with a given name
+ * Time Complexity: O(1) (average case)
+ * @param name - Name of the station
+ * @return Index of the station, or NOT_FOUND if no such station exists
+ */
+unsigned int FlowNetwork::findStation(const std::string &name) const {
+    auto it = nameToStation.find(name);
+    return it == nameToStation.end() ? NOT_FOUND : it->second;
+}
+
+const std::string &FlowNetwork::getStationName(unsigned int station) const {
+    return stationNames[station];
+}
+
+/**
+ * Finds the index of the rail an Edge of the original Graph belongs to, in either direction
+ * Time Complexity: O(1) (average case)
+ * @param edge - Pointer to the Edge
+ * @return Index of the rail, or NOT_FOUND if the Edge isn't part of this snapshot
+ */
+unsigned int FlowNetwork::findRail(const Edge *edge) const {
+    auto it = edgeToRail.find(edge);
+    return it == edgeToRail.end() ? NOT_FOUND : it->second;
+}
+
+/**
+ * Finds every rail between two stations
+ * Time Complexity: O(outdegree(station1))
+ * @param station1 - Index of one of the stations
+ * @param station2 - Index of the other station
+ * @return Vector of the indexes of the rails between them, empty if there are none
+ */
+std::vector<unsigned int> FlowNetwork::findRails(unsigned int station1, unsigned int station2) const {
+    std::vector<unsigned int> result;
+    for (unsigned int j = firstArc[station1]; j < firstArc[station1 + 1]; j++)
+        if (heads[adjacentArcs[j]] == station2) result.push_back(adjacentArcs[j] >> 1);
+    return result;
+}
+
+Edge *FlowNetwork::getRailEdge(unsigned int rail) const {
+    return railToEdge[rail];
+}
+
+unsigned int FlowNetwork::getRailCapacity(unsigned int rail) const {
+    return railCapacity[rail];
+}
+
+int FlowNetwork::getRailCost(unsigned int rail) const {
+    return railCost[rail];
+}
+
+/**
+ * Length of a rail in the cheapest-route queries
+ * Time Complexity: O(1)
+ * @param rail - Index of the rail
+ * @param metric - Whether routes are measured by cost or by number of rails
+ * @return Cost of the rail for RouteMetric::COST, 1 for RouteMetric::HOPS
+ */
+unsigned int FlowNetwork::railLength(unsigned int rail, RouteMetric metric) const {
+    return metric == RouteMetric::COST ? (unsigned int) railCost[rail] : 1;
+}
+
+/**
+ * Total capacity of the rails of a station, an upper bound of any flow that reaches or leaves it
+ * Time Complexity: O(d), d being the number of rails of the station
+ * @param station - Index of the station
+ * @return Sum of the capacities of the station's rails
+ */
+unsigned long long FlowNetwork::incidentCapacity(unsigned int station) const {
+    unsigned long long capacity = 0;
+    for (unsigned int j = firstArc[station]; j < firstArc[station + 1]; j++)
+        capacity += railCapacity[adjacentArcs[j] >> 1];
+    return capacity;
+}
+
+/**
+ * Changes the capacity of a rail in place. Must not run concurrently with any query
+ * Time Complexity: O(1)
+ * @param rail - Index of the rail
+ * @param capacity - New capacity of the rail
+ */
+void FlowNetwork::setRailCapacity(unsigned int rail, unsigned int capacity) {
+    railCapacity[rail] = capacity;
+}
+
+/**
+ * Changes the cost per unit of flow of a rail in place. Must not run concurrently with any query
+ * Time Complexity: O(1)
+ * @param rail - Index of the rail
+ * @param cost - New cost of the rail
+ */
+void FlowNetwork::setRailCost(unsigned int rail, int cost) {
+    railCost[rail] = cost;
+}
+
+/**
+ * Gets the CSR offsets of the arcs leaving each station into getAdjacentArcs
+ * Time Complexity: O(1)
+ * @return Span with one offset per station plus one, valid until the FlowNetwork changes
+ */
+std::span<const unsigned int> FlowNetwork::getFirstArcs() const {
+    return firstArc;
+}
+
+/**
+ * Gets the arcs leaving every station, grouped by station as given by getFirstArcs
+ * Time Complexity: O(1)
+ * @return Span with the arcs, valid until the FlowNetwork changes
+ */
+std::span<const unsigned int> FlowNetwork::getAdjacentArcs() const {
+    return adjacentArcs;
+}
+
+unsigned int FlowNetwork::arcTail(unsigned int arc) const {
+    return heads[arc ^ 1];
+}
+
+unsigned int FlowNetwork::arcHead(unsigned int arc) const {
+    return heads[arc];
+}
+
+/**
+ * Builds the FailureMask that takes the rails of the given Edges out of service and closes the given stations
+ * Time Complexity: O(|V|+|E|)
+ * @param edges - Vector of pointers to Edges of the original Graph
+ * @param closedStations - Names of the stations to close
+ * @return FailureMask for the given Edges and stations
+ */
+FailureMask FlowNetwork::makeMask(const std::vector<Edge *> &edges, const std::vector<std::string> &closedStations) const {
+    FailureMask mask;
+    mask.rails.assign(railCapacity.size(), false);
+    for (Edge const *e: edges) {
+        unsigned int rail = findRail(e);
+        if (rail != NOT_FOUND) mask.rails[rail] = true;
+    }
+    mask.stations.assign(stationNames.size(), false);
+    for (const std::string &name: closedStations) {
+        unsigned int station = findStation(name);
+        if (station != NOT_FOUND) mask.stations[station] = true;
+    }
+    return mask;
+}
+
+/**
+ * Finds the stations at the ends of the lines of a station's connected component, excluding itself. Equivalent to
+ * Graph::superSourceCreator
+ * Time Complexity: O(|V|+|E|)
+ * @param station - Index of the station
+ * @return Vector of indexes of the source stations
+ */
+std::vector<unsigned int> FlowNetwork::superSource(unsigned int station) const {
+    std::vector<unsigned int> result;
+    std::vector<bool> visited(stationNames.size(), false);
+    std::vector<unsigned int> queue = {station};
+    visited[station] = true;
+    for (size_t i = 0; i < queue.size(); i++) {
+        unsigned int v = queue[i];
+        if (firstArc[v + 1] - firstArc[v] == 1 && v != station) result.push_back(v);
+        for (unsigned int j = firstArc[v]; j < firstArc[v + 1]; j++) {
+            unsigned int w = heads[adjacentArcs[j]];
+            if (!visited[w]) {
+                visited[w] = true;
+                queue.push_back(w);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Dijkstra's algorithm modified to find the widest path between two stations, i.e. the route whose narrowest rail has
+ * the largest capacity: the number of trains that can use the best single route. A station's label is the width of the
+ * widest path found to it, and the station with the widest label is settled first
+ * Time Complexity: O(|E| log |V|)
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @param mask - Rails out of service and closed stations
+ * @return Pair with the capacity of the widest path and its rails, in order from source to target, or 0 and no rails
+ * if the stations are the same or aren't connected
+ */
+std::pair<unsigned int, std::vector<unsigned int>>
+FlowNetwork::widestPath(unsigned int source, unsigned int target, const FailureMask &mask) const {
+    if (source == target || !mask.isStationActive(source) || !mask.isStationActive(target)) return {0, {}};
+    std::vector<unsigned int> width(stationNames.size(), 0);
+    std::vector<unsigned int> viaArc(stationNames.size(), NOT_FOUND);
+    std::priority_queue<std::pair<unsigned int, unsigned int>> queue; // (width, station), widest first
+    width[source] = std::numeric_limits<unsigned int>::max();
+    queue.emplace(width[source], source);
+
+    unsigned long long arcsScanned = 0;
+    QUERY_STATS_ADD(searches, 1);
+    while (!queue.empty()) {
+        auto [label, station] = queue.top();
+        queue.pop();
+        if (label < width[station]) continue; //Outdated entry
+        if (station == target) break;
+        for (unsigned int j = firstArc[station]; j < firstArc[station + 1]; j++) {
+            arcsScanned++;
+            unsigned int arc = adjacentArcs[j];
+            unsigned int head = heads[arc];
+            if (!mask.isRailActive(arc >> 1) || !mask.isStationActive(head)) continue;
+            unsigned int through = std::min(label, railCapacity[arc >> 1]);
+            if (through <= width[head]) continue;
+            width[head] = through;
+            viaArc[head] = arc;
+            queue.emplace(through, head);
+        }
+    }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+    if (width[target] == 0) return {0, {}};
+
+    std::vector<unsigned int> rails;
+    for (unsigned int station = target; station != source; station = arcTail(viaArc[station]))
+        rails.push_back(viaArc[station] >> 1);
+    std::reverse(rails.begin(), rails.end());
+    return {width[target], rails};
+}
+
+/**
+ * Dijkstra's algorithm to find the cheapest route between two stations, by cost of the services or by number of rails.
+ * Rails without capacity are left out, as no train can use them
+ * Time Complexity: O(|E| log |V|)
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @param metric - Whether routes are measured by cost or by number of rails
+ * @param mask - Rails out of service and closed stations
+ * @return Pair with the length of the cheapest route and its rails, in order from source to target, 0 and no rails if
+ * the stations are the same, or NOT_FOUND and no rails if they aren't connected
+ */
+std::pair<unsigned int, std::vector<unsigned int>>
+FlowNetwork::shortestPath(unsigned int source, unsigned int target, RouteMetric metric,
+                          const FailureMask &mask) const {
+    if (source == target) return {0, {}};
+    if (!mask.isStationActive(source) || !mask.isStationActive(target)) return {NOT_FOUND, {}};
+    std::vector<unsigned int> length(stationNames.size(), NOT_FOUND);
+    std::vector<unsigned int> viaArc(stationNames.size(), NOT_FOUND);
+    // (length, station), shortest first
+    std::priority_queue<std::pair<unsigned int, unsigned int>, std::vector<std::pair<unsigned int, unsigned int>>,
+            std::greater<>> queue;
+    length[source] = 0;
+    queue.emplace(0, source);
+
+    unsigned long long arcsScanned = 0;
+    QUERY_STATS_ADD(searches, 1);
+    while (!queue.empty()) {
+        auto [label, station] = queue.top();
+        queue.pop();
+        if (label > length[station]) continue; //Outdated entry
+        if (station == target) break;
+        for (unsigned int j = firstArc[station]; j < firstArc[station + 1]; j++) {
+            arcsScanned++;
+            unsigned int arc = adjacentArcs[j];
+            unsigned int head = heads[arc];
+            if (railCapacity[arc >> 1] == 0 || !mask.isRailActive(arc >> 1) || !mask.isStationActive(head)) continue;
+            unsigned int through = label + railLength(arc >> 1, metric);
+            if (through >= length[head]) continue;
+            length[head] = through;
+            viaArc[head] = arc;
+            queue.emplace(through, head);
+        }
+    }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+    if (length[target] == NOT_FOUND) return {NOT_FOUND, {}};
+
+    std::vector<unsigned int> rails;
+    for (unsigned int station = target; station != source; station = arcTail(viaArc[station]))
+        rails.push_back(viaArc[station] >> 1);
+    std::reverse(rails.begin(), rails.end());
+    return {length[target], rails};
+}
+
+/**
+ * Edmonds-Karp augmentation starting from a given (valid) flow, until no more augmenting paths exist or limit units of
+ * flow were pushed from the sources to any of the targets. Closed stations can't be crossed, nor supply flow
+ * Time Complexity: O(|VE²|)
+ * @param sources - Indexes of the source stations
+ * @param isTarget - Vector indexed by station, true for the target stations
+ * @param flow - Flow per arc, updated in place
+ * @param mask - Rails out of service
+ * @param limit - Maximum amount of flow to push
+ * @return Amount of flow pushed
+ */
+unsigned int FlowNetwork::augment(const std::vector<unsigned int> &sources, const std::vector<bool> &isTarget,
+                                  std::vector<int> &flow, const FailureMask &mask, unsigned int limit) const {
+    const unsigned int none = NOT_FOUND;
+    unsigned int total = 0;
+    std::vector<unsigned int> parentArc(stationNames.size());
+    std::vector<bool> visited(stationNames.size());
+    std::vector<unsigned int> queue;
+    queue.reserve(stationNames.size());
+    unsigned long long arcsScanned = 0;
+
+    while (total < limit) {
+        std::fill(visited.begin(), visited.end(), false);
+        queue.clear();
+        for (unsigned int s: sources) {
+            if (!mask.isStationActive(s)) continue;
+            visited[s] = true;
+            parentArc[s] = none;
+            queue.push_back(s);
+        }
+
+        unsigned int found = none;
+        QUERY_STATS_ADD(searches, 1);
+        for (size_t i = 0; i < queue.size() && found == none; i++) {
+            unsigned int v = queue[i];
+            arcsScanned += firstArc[v + 1] - firstArc[v];
+            for (unsigned int j = firstArc[v]; j < firstArc[v + 1]; j++) {
+                unsigned int arc = adjacentArcs[j];
+                unsigned int w = heads[arc];
+                if (visited[w] || !mask.isRailActive(arc >> 1) || !mask.isStationActive(w) ||
+                    (int) railCapacity[arc >> 1] - flow[arc] <= 0)
+                    continue;
+                visited[w] = true;
+                parentArc[w] = arc;
+                if (isTarget[w]) {
+                    found = w;
+                    break;
+                }
+                queue.push_back(w);
+            }
+        }
+        if (found == none) break;
+
+        unsigned int bottleneck = limit - total;
+        for (unsigned int v = found; parentArc[v] != none; v = arcTail(parentArc[v]))
+            bottleneck = std::min(bottleneck, (unsigned int) ((int) railCapacity[parentArc[v] >> 1] - flow[parentArc[v]]));
+        for (unsigned int v = found; parentArc[v] != none; v = arcTail(parentArc[v])) {
+            flow[parentArc[v]] += (int) bottleneck;
+            flow[parentArc[v] ^ 1] -= (int) bottleneck;
+        }
+        total += bottleneck;
+        QUERY_STATS_ADD(augmentations, 1);
+    }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+    return total;
+}
+
+/**
+ * Computes the net flow arriving at a station
+ * Time Complexity: O(outdegree(station))
+ * @param station - Index of the station
+ * @param flow - Flow per arc
+ * @return Net incoming flow
+ */
+unsigned int FlowNetwork::inflow(unsigned int station, const std::vector<int> &flow) const {
+    int total = 0;
+    for (unsigned int j = firstArc[station]; j < firstArc[station + 1]; j++) total -= flow[adjacentArcs[j]];
+    return total < 0 ? 0 : (unsigned int) total;
+}
+
+/**
+ * Single-source or Multi-source Edmonds-Karp algorithm, keeping the resulting flow
+ * Time Complexity: O(|VE²|)
+ * @param sources - Indexes of the source stations
+ * @param target - Index of the target station
+ * @param flow - Vector where the flow per arc is stored
+ * @param mask - Rails out of service
+ * @return Value of the max flow
+ */
+unsigned int FlowNetwork::maxFlow(const std::vector<unsigned int> &sources, unsigned int target, std::vector<int> &flow,
+                                  const FailureMask &mask) const {
+    QUERY_STATS_PHASE(QueryPhase::MAX_FLOW);
+    flow.assign(heads.size(), 0);
+    std::vector<bool> isTarget(stationNames.size(), false);
+    isTarget[target] = true;
+    return augment(sources, isTarget, flow, mask, std::numeric_limits<unsigned int>::max());
+}
+
+/**
+ * Single-source or Multi-source Edmonds-Karp algorithm
+ * Time Complexity: O(|VE²|)
+ * @param sources - Indexes of the source stations
+ * @param target - Index of the target station
+ * @param mask - Rails out of service
+ * @return Value of the max flow
+ */
+unsigned int FlowNetwork::maxFlow(const std::vector<unsigned int> &sources, unsigned int target,
+                                  const FailureMask &mask) const {
+    std::vector<int> flow;
+    return maxFlow(sources, target, flow, mask);
+}
+
+/**
+ * Takes a rail out of service and turns a max flow into a max flow of the reduced network. The rail's flow is first
+ * rerouted through the residual network, whatever can't be rerouted is cancelled back to the sources and from the
+ * target, and the flow is then augmented again, which costs O(f·E) for a rail carrying f units instead of a full
+ * re-solve
+ * Time Complexity: O(f·|E|) (usual case) | O(|VE²|) (worst case)
+ * @param rail - Index of the rail to fail
+ * @param sources - Indexes of the source stations
+ * @param target - Index of the target station
+ * @param isSource - Vector indexed by station, true for the source stations
+ * @param flow - A max flow for mask, updated in place
+ * @param mask - Rails out of service, to which rail is added
+ * @return Value of the max flow once rail fails
+ */
+unsigned int FlowNetwork::failRail(unsigned int rail, const std::vector<unsigned int> &sources, unsigned int target,
+                                   const std::vector<bool> &isSource, std::vector<int> &flow, FailureMask &mask) const {
+    mask.rails[rail] = true;
+    std::vector<bool> isTarget(stationNames.size(), false);
+    isTarget[target] = true;
+
+    if (flow[2 * rail] != 0) {
+        unsigned int arc = flow[2 * rail] > 0 ? 2 * rail : 2 * rail + 1;
+        auto carried = (unsigned int) flow[arc];
+        unsigned int from = arcTail(arc);
+        unsigned int to = arcHead(arc);
+        flow[arc] = flow[arc ^ 1] = 0;
+
+        std::vector<bool> isTo(stationNames.size(), false);
+        isTo[to] = true;
+        unsigned int cancelled = carried - augment({from}, isTo, flow, mask, carried);
+        bool valid = true;
+        if (cancelled > 0 && !isSource[from])
+            valid = augment({from}, isSource, flow, mask, cancelled) == cancelled;
+        if (valid && cancelled > 0 && to != target)
+            valid = augment({target}, isTo, flow, mask, cancelled) == cancelled;
+        if (!valid) return maxFlow(sources, target, flow, mask); //Flow couldn't be repaired (e.g. it ran in a cycle)
+    }
+
+    augment(sources, isTarget, flow, mask, std::numeric_limits<unsigned int>::max());
+    return inflow(target, flow);
+}
+
+/**
+ * Successive shortest paths algorithm for the min cost max flow from source to target. Each augmenting path is a
+ * cheapest path in the residual network, found with a queue-based Bellman-Ford since cancelling flow has negative cost.
+ * An arc with flow in the opposite direction only offers the cancellation of that flow, which is cheaper than any new
+ * flow through it, so the antisymmetric flow vector is enough to represent the residual network
+ * Time Complexity: O(f·|VE|), f being the value of the max flow
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @param mask - Rails out of service and closed stations
+ * @return Pair with the value of the max flow and its minimum total cost, which may exceed the range of an unsigned int
+ */
+std::pair<unsigned int, long long>
+FlowNetwork::minCostMaxFlow(unsigned int source, unsigned int target, const FailureMask &mask) const {
+    QUERY_STATS_PHASE(QueryPhase::MIN_COST);
+    const unsigned int none = NOT_FOUND;
+    const long long infinity = std::numeric_limits<long long>::max();
+    if (source == target || !mask.isStationActive(source) || !mask.isStationActive(target)) return {0, 0};
+
+    std::vector<int> flow(heads.size(), 0);
+    std::vector<long long> distance(stationNames.size());
+    std::vector<unsigned int> parentArc(stationNames.size());
+    std::vector<bool> inQueue(stationNames.size(), false);
+    std::deque<unsigned int> queue;
+    auto residual = [&](unsigned int arc) {
+        return flow[arc] < 0 ? (unsigned int) -flow[arc] : railCapacity[arc >> 1] - (unsigned int) flow[arc];
+    };
+    auto cost = [&](unsigned int arc) {
+        return flow[arc] < 0 ? -railCost[arc >> 1] : railCost[arc >> 1];
+    };
+
+    unsigned int total = 0;
+    long long totalCost = 0;
+    unsigned long long arcsScanned = 0;
+    unsigned long long relaxations = 0;
+    while (true) {
+        QUERY_STATS_ADD(searches, 1);
+        std::fill(distance.begin(), distance.end(), infinity);
+        distance[source] = 0;
+        parentArc[source] = none;
+        queue.push_back(source);
+        inQueue[source] = true;
+        while (!queue.empty()) {
+            unsigned int v = queue.front();
+            queue.pop_front();
+            inQueue[v] = false;
+            arcsScanned += firstArc[v + 1] - firstArc[v];
+            for (unsigned int j = firstArc[v]; j < firstArc[v + 1]; j++) {
+                unsigned int arc = adjacentArcs[j];
+                unsigned int w = heads[arc];
+                if (!mask.isRailActive(arc >> 1) || !mask.isStationActive(w) || residual(arc) == 0) continue;
+                if (distance[v] + cost(arc) < distance[w]) {
+                    distance[w] = distance[v] + cost(arc);
+                    parentArc[w] = arc;
+                    relaxations++;
+                    if (!inQueue[w]) {
+                        inQueue[w] = true;
+                        queue.push_back(w);
+                    }
+                }
+            }
+        }
+        if (distance[target] == infinity) break;
+
+        unsigned int bottleneck = std::numeric_limits<unsigned int>::max();
+        for (unsigned int v = target; parentArc[v] != none; v = arcTail(parentArc[v]))
+            bottleneck = std::min(bottleneck, residual(parentArc[v]));
+        for (unsigned int v = target; parentArc[v] != none; v = arcTail(parentArc[v])) {
+            flow[parentArc[v]] += (int) bottleneck;
+            flow[parentArc[v] ^ 1] -= (int) bottleneck;
+        }
+        total += bottleneck;
+        totalCost += (long long) bottleneck * distance[target];
+        QUERY_STATS_ADD(augmentations, 1);
+    }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+    QUERY_STATS_ADD(relaxations, relaxations);
+    return {total, totalCost};
+}
+
+/**
+ * Ranks every rail by how much its failure alone reduces the max flow from the sources to the target. Rails carrying no
+ * flow in a baseline max flow can't reduce it; the others reuse the baseline flow (see FlowNetwork::failRail) and are
+ * processed in parallel
+ * Time Complexity: O(|VE²| + k·f·|E| / threads), k being the number of rails carrying flow
+ * @param sources - Indexes of the source stations
+ * @param target - Index of the target station
+ * @param threads - Number of threads to use, 0 meaning one per hardware thread
+ * @return Vector with the Edge of every rail and its max flow before and after failing, by decreasing reduction
+ */
+std::vector<std::pair<Edge *, std::pair<unsigned int, unsigned int>>>
+FlowNetwork::criticalRails(const std::vector<unsigned int> &sources, unsigned int target, unsigned int threads) const {
+    QUERY_STATS_PHASE(QueryPhase::FAILURE_SCAN);
+    std::vector<int> baseFlow;
+    unsigned int baseline = maxFlow(sources, target, baseFlow);
+
+    std::vector<std::pair<Edge *, std::pair<unsigned int, unsigned int>>> result;
+    std::vector<unsigned int> pending;
+    for (unsigned int rail = 0; rail < railCapacity.size(); rail++) {
+        result.push_back({railToEdge[rail], {baseline, baseline}});
+        if (baseFlow[2 * rail] != 0) pending.push_back(rail);
+    }
+
+    std::vector<bool> isSource(stationNames.size(), false);
+    for (unsigned int s: sources) isSource[s] = true;
+
+    if (threads == 0) threads = defaultThreadCount();
+    std::vector<std::vector<int>> flows(threads);
+    std::vector<FailureMask> masks(threads, FailureMask{std::vector<bool>(railCapacity.size(), false), {}});
+
+    parallelFor(pending.size(), [&](size_t i, unsigned int worker) {
+        unsigned int rail = pending[i];
+        flows[worker] = baseFlow;
+        result[rail].second.second = failRail(rail, sources, target, isSource, flows[worker], masks[worker]);
+        masks[worker].rails[rail] = false;
+    }, threads);
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const std::pair<Edge *, std::pair<unsigned int, unsigned int>> &p1,
+                        const std::pair<Edge *, std::pair<unsigned int, unsigned int>> &p2) {
+                         return p1.second.first - p1.second.second > p2.second.first - p2.second.second;
+                     });
+    return result;
+}
+
+/**
+ * Finds the n combinations of up to k simultaneous rail failures that leave the least flow from the sources to the
+ * target. Any combination that reduces the flow must fail a rail carrying flow in the current max flow, so the search
+ * only branches on those rails (which include every saturated min cut rail), and prunes a branch when even losing the
+ * full capacity of the largest remaining rails couldn't beat the n-th best combination found so far. Each combination
+ * is explored once, whatever the order its rails were chosen in, and the subtrees of the first failed rail are
+ * explored in parallel
+ * Time Complexity: O(c^k · f·|E| / threads), c being the number of rails carrying flow
+ * @param sources - Indexes of the source stations
+ * @param target - Index of the target station
+ * @param k - Maximum number of failed rails per combination
+ * @param n - Number of combinations to report
+ * @param threads - Number of threads to use, 0 meaning one per hardware thread
+ * @return Vector of the combinations' Edges and the max flow left, by increasing max flow. Combinations with fewer than
+ * k rails are reported when they already cut all the flow
+ */
+std::vector<std::pair<std::vector<Edge *>, unsigned int>>
+FlowNetwork::worstFailures(const std::vector<unsigned int> &sources, unsigned int target, unsigned int k,
+                           unsigned int n, unsigned int threads) const {
+    QUERY_STATS_PHASE(QueryPhase::FAILURE_SCAN);
+    std::vector<int> baseFlow;
+    unsigned int baseline = maxFlow(sources, target, baseFlow);
+    if (baseline == 0 || k == 0 || n == 0) return {};
+    k = std::min(k, getNumRails()); //No more rails than the network has can fail
+
+    //largestCapacities[i] is the sum of the i largest rail capacities, bounding the loss of failing i more rails
+    std::vector<unsigned int> capacities(railCapacity.begin(), railCapacity.end());
+    std::sort(capacities.begin(), capacities.end(), std::greater<>());
+    std::vector<unsigned long long> largestCapacities = {0};
+    for (unsigned int i = 0; i < k; i++) largestCapacities.push_back(largestCapacities.back() + capacities[i]);
+
+    std::vector<bool> isSource(stationNames.size(), false);
+    for (unsigned int s: sources) isSource[s] = true;
+
+    std::mutex lock;
+    std::set<std::vector<unsigned int>> explored;
+    std::vector<std::pair<std::vector<unsigned int>, unsigned int>> best; //Sorted by increasing flow, at most n
+
+    auto threshold = [&]() {
+        std::lock_guard<std::mutex> guard(lock);
+        return best.size() < n ? std::numeric_limits<unsigned int>::max() : best.back().second;
+    };
+    auto record = [&](std::vector<unsigned int> rails, unsigned int value) {
+        std::sort(rails.begin(), rails.end());
+        std::lock_guard<std::mutex> guard(lock);
+        std::pair<std::vector<unsigned int>, unsigned int> entry = {rails, value};
+        auto position = std::upper_bound(best.begin(), best.end(), entry, [](const auto &p1, const auto &p2) {
+            return p1.second != p2.second ? p1.second < p2.second : p1.first < p2.first;
+        });
+        best.insert(position, entry);
+        if (best.size() > n) best.pop_back();
+    };
+    auto firstVisit = [&](std::vector<unsigned int> rails) {
+        std::sort(rails.begin(), rails.end());
+        std::lock_guard<std::mutex> guard(lock);
+        return explored.insert(rails).second;
+    };
+
+    std::function<void(std::vector<unsigned int> &, const std::vector<int> &, unsigned int, FailureMask &)> explore =
+            [&](std::vector<unsigned int> &chosen, const std::vector<int> &flow, unsigned int value,
+                FailureMask &mask) {
+                if (chosen.size() == k || value == 0) {
+                    record(chosen, value);
+                    return;
+                }
+                unsigned long long maxLoss = largestCapacities[k - chosen.size()];
+                unsigned int bound = value > maxLoss ? value - (unsigned int) maxLoss : 0;
+                if (bound > threshold()) return;
+
+                std::vector<int> childFlow;
+                for (unsigned int rail = 0; rail < railCapacity.size(); rail++) {
+                    if (flow[2 * rail] == 0 || !mask.isRailActive(rail)) continue;
+                    chosen.push_back(rail);
+                    if (firstVisit(chosen)) {
+                        childFlow = flow;
+                        unsigned int childValue = failRail(rail, sources, target, isSource, childFlow, mask);
+                        explore(chosen, childFlow, childValue, mask);
+                        mask.rails[rail] = false;
+                    }
+                    chosen.pop_back();
+                }
+            };
+
+    std::vector<unsigned int> firstRails;
+    for (unsigned int rail = 0; rail < railCapacity.size(); rail++)
+        if (baseFlow[2 * rail] != 0) firstRails.push_back(rail);
+
+    if (threads == 0) threads = defaultThreadCount();
+    std::vector<FailureMask> masks(threads, FailureMask{std::vector<bool>(railCapacity.size(), false), {}});
+    parallelFor(firstRails.size(), [&](size_t i, unsigned int worker) {
+        std::vector<unsigned int> chosen = {firstRails[i]};
+        if (!firstVisit(chosen)) return;
+        std::vector<int> flow = baseFlow;
+        unsigned int value = failRail(firstRails[i], sources, target, isSource, flow, masks[worker]);
+        explore(chosen, flow, value, masks[worker]);
+        masks[worker].rails[firstRails[i]] = false;
+    }, threads);
+
+    std::vector<std::pair<std::vector<Edge *>, unsigned int>> result;
+    for (const auto &[rails, value]: best) {
+        std::vector<Edge *> edges;
+        for (unsigned int rail: rails) edges.push_back(railToEdge[rail]);
+        result.emplace_back(edges, value);
+    }
+    return result;
+}
+
+/**
+ * Counts the pairs of open stations that are connected through rails in service
+ * Time Complexity: O(|V|+|E|)
+ * @param mask - Rails out of service and closed stations
+ * @return Number of unordered pairs of connected stations
+ */
+unsigned long long FlowNetwork::connectedPairs(const FailureMask &mask) const {
+    unsigned long long pairs = 0;
+    std::vector<bool> visited(stationNames.size(), false);
+    std::vector<unsigned int> queue;
+    for (unsigned int root = 0; root < stationNames.size(); root++) {
+        if (visited[root] || !mask.isStationActive(root)) continue;
+        queue = {root};
+        visited[root] = true;
+        for (size_t i = 0; i < queue.size(); i++) {
+            for (unsigned int j = firstArc[queue[i]]; j < firstArc[queue[i] + 1]; j++) {
+                unsigned int w = heads[adjacentArcs[j]];
+                if (visited[w] || !mask.isStationActive(w) || !mask.isRailActive(adjacentArcs[j] >> 1)) continue;
+                visited[w] = true;
+                queue.push_back(w);
+            }
+        }
+        pairs += (unsigned long long) queue.size() * (queue.size() - 1) / 2;
+    }
+    return pairs;
+}
+
+/**
+ * Ranks every station by how much its closure hurts the network: first by the number of pairs of stations that can no
+ * longer reach each other (including the pairs of the closed station itself), then by the total capacity of the rails
+ * through it. Each closure is simulated with its own FailureMask, in parallel, without modifying the network
+ * Time Complexity: O(|V|(|V|+|E|) / threads)
+ * @param threads - Number of threads to use, 0 meaning one per hardware thread
+ * @return Vector of the stations' names along with the connected pairs lost and the capacity of the rails through them,
+ * by decreasing impact
+ */
+std::vector<std::pair<std::string, std::pair<unsigned long long, unsigned int>>>
+FlowNetwork::topStationClosures(unsigned int threads) const {
+    QUERY_STATS_PHASE(QueryPhase::FAILURE_SCAN);
+    unsigned long long baseline = connectedPairs({});
+    std::vector<std::pair<std::string, std::pair<unsigned long long, unsigned int>>> result(stationNames.size());
+
+    if (threads == 0) threads = defaultThreadCount();
+    std::vector<FailureMask> masks(threads, FailureMask{{}, std::vector<bool>(stationNames.size(), false)});
+    parallelFor(stationNames.size(), [&](size_t station, unsigned int worker) {
+        masks[worker].stations[station] = true;
+        unsigned int capacity = 0;
+        for (unsigned int j = firstArc[station]; j < firstArc[station + 1]; j++)
+            capacity += railCapacity[adjacentArcs[j] >> 1];
+        result[station] = {stationNames[station], {baseline - connectedPairs(masks[worker]), capacity}};
+        masks[worker].stations[station] = false;
+    }, threads);
+
+    std::sort(result.begin(), result.end(),
+              [](const std::pair<std::string, std::pair<unsigned long long, unsigned int>> &p1,
+                 const std::pair<std::string, std::pair<unsigned long long, unsigned int>> &p2) {
+                  return p1.second != p2.second ? p1.second > p2.second : p1.first < p2.first;
+              });
+    return result;
+}
@@ -0,0 +1,152 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_FLOWNETWORK_H
+#define RAILWAYMANAGEMENT_FLOWNETWORK_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <span>
+#include <unordered_map>
+
+#include "graph.h"
+
+class NetworkSnapshot;
+
+/**
+ * Set of rails taken out of service and stations closed for a single query. Unlike Graph::deactivateEdges and
+ * Graph::deactivateVertices, it is owned by the query, so several queries with different failures can run at the same
+ * time on the same FlowNetwork
+ */
+struct FailureMask {
+    std::vector<bool> rails; // indexed by rail, true if the rail is out of service
+    std::vector<bool> stations; // indexed by station, true if the station is closed
+
+    [[nodiscard]] bool isRailActive(unsigned int rail) const {
+        return rail >= rails.size() || !rails[rail];
+    }
+
+    [[nodiscard]] bool isStationActive(unsigned int station) const {
+        return station >= stations.size() || !stations[station];
+    }
+};
+
+/**
+ * Length of a rail for the cheapest-route queries
+ */
+enum class RouteMetric {
+    COST, // cost of the rail's service, as set by Edge::initializeCost
+    HOPS // one per rail, for the routes with the fewest rails
+};
+
+/**
+ * Immutable, index-based snapshot of a railway network for flow queries. Every rail r is stored as a pair of arcs,
+ * 2r (from the rail's first station to its second) and 2r + 1 (the opposite direction), and a flow is an antisymmetric
+ * vector over the arcs, so an arc's residual capacity is the rail's capacity minus its flow. All the state of a query
+ * lives in the caller's vectors, so any number of threads can query the same FlowNetwork concurrently
+ */
+class FlowNetwork {
+  private:
+    CountedVector<std::string, MemoryCategory::FLOW_NETWORK> stationNames;
+    CountedMap<std::string, unsigned int, MemoryCategory::FLOW_NETWORK> nameToStation;
+    // CSR offsets into adjacentArcs, one per station plus one
+    CountedVector<unsigned int, MemoryCategory::FLOW_NETWORK> firstArc;
+    CountedVector<unsigned int, MemoryCategory::FLOW_NETWORK> adjacentArcs;
+    CountedVector<unsigned int, MemoryCategory::FLOW_NETWORK> heads; // station each arc leads to
+    CountedVector<unsigned int, MemoryCategory::FLOW_NETWORK> railCapacity;
+    // cost per unit of flow through the rail, in either direction
+    CountedVector<int, MemoryCategory::FLOW_NETWORK> railCost;
+    // Edge of the original Graph from the rail's first to its second station
+    CountedVector<Edge *, MemoryCategory::FLOW_NETWORK> railToEdge;
+    CountedMap<const Edge *, unsigned int, MemoryCategory::FLOW_NETWORK> edgeToRail;
+
+    unsigned int augment(const std::vector<unsigned int> &sources, const std::vector<bool> &isTarget,
+                         std::vector<int> &flow, const FailureMask &mask, unsigned int limit) const;
+
+    [[nodiscard]] unsigned int inflow(unsigned int station, const std::vector<int> &flow) const;
+
+    [[nodiscard]] unsigned long long connectedPairs(const FailureMask &mask) const;
+
+    unsigned int failRail(unsigned int rail, const std::vector<unsigned int> &sources, unsigned int target,
+                          const std::vector<bool> &isSource, std::vector<int> &flow, FailureMask &mask) const;
+
+  public:
+    static const unsigned int NOT_FOUND;
+
+    FlowNetwork();
+
+    explicit FlowNetwork(const Graph &network);
+
+    FlowNetwork(const NetworkSnapshot &snapshot, const std::vector<Edge *> &edges);
+
+    [[nodiscard]] unsigned int getNumStations() const;
+
+    [[nodiscard]] unsigned int getNumRails() const;
+
+    [[nodiscard]] unsigned int findStation(const std::string &name) const;
+
+    [[nodiscard]] const std::string &getStationName(unsigned int station) const;
+
+    [[nodiscard]] unsigned int findRail(const Edge *edge) const;
+
+    [[nodiscard]] std::vector<unsigned int> findRails(unsigned int station1, unsigned int station2) const;
+
+    [[nodiscard]] Edge *getRailEdge(unsigned int rail) const;
+
+    [[nodiscard]] unsigned int getRailCapacity(unsigned int rail) const;
+
+    [[nodiscard]] int getRailCost(unsigned int rail) const;
+
+    [[nodiscard]] unsigned int railLength(unsigned int rail, RouteMetric metric) const;
+
+    [[nodiscard]] unsigned long long incidentCapacity(unsigned int station) const;
+
+    void setRailCapacity(unsigned int rail, unsigned int capacity);
+
+    void setRailCost(unsigned int rail, int cost);
+
+    unsigned int addStation(const std::string &name);
+
+    [[nodiscard]] std::span<const unsigned int> getFirstArcs() const;
+
+    [[nodiscard]] std::span<const unsigned int> getAdjacentArcs() const;
+
+    [[nodiscard]] unsigned int arcTail(unsigned int arc) const;
+
+    [[nodiscard]] unsigned int arcHead(unsigned int arc) const;
+
+    [[nodiscard]] FailureMask
+    makeMask(const std::vector<Edge *> &edges, const std::vector<std::string> &closedStations = {}) const;
+
+    [[nodiscard]] std::vector<unsigned int> superSource(unsigned int station) const;
+
+    unsigned int maxFlow(const std::vector<unsigned int> &sources, unsigned int target, std::vector<int> &flow,
+                         const FailureMask &mask = {}) const;
+
+    [[nodiscard]] unsigned int maxFlow(const std::vector<unsigned int> &sources, unsigned int target,
+                                       const FailureMask &mask = {}) const;
+
+    [[nodiscard]] std::pair<unsigned int, std::vector<unsigned int>>
+    widestPath(unsigned int source, unsigned int target, const FailureMask &mask = {}) const;
+
+    [[nodiscard]] std::pair<unsigned int, std::vector<unsigned int>>
+    shortestPath(unsigned int source, unsigned int target, RouteMetric metric, const FailureMask &mask = {}) const;
+
+    [[nodiscard]] std::pair<unsigned int, long long>
+    minCostMaxFlow(unsigned int source, unsigned int target, const FailureMask &mask = {}) const;
+
+    [[nodiscard]] std::vector<std::pair<Edge *, std::pair<unsigned int, unsigned int>>>
+    criticalRails(const std::vector<unsigned int> &sources, unsigned int target, unsigned int threads = 0) const;
+
+    [[nodiscard]] std::vector<std::pair<std::vector<Edge *>, unsigned int>>
+    worstFailures(const std::vector<unsigned int> &sources, unsigned int target, unsigned int k, unsigned int n,
+                  unsigned int threads = 0) const;
+
+    [[nodiscard]] std::vector<std::pair<std::string, std::pair<unsigned long long, unsigned int>>>
+    topStationClosures(unsigned int threads = 0) const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_FLOWNETWORK_H
@@ -3,16 +3,64 @@
 //
 
 #include "graph.h"
+#include "queryStats.h"
+#include "operationMetrics.h"
 
 
 Graph::Graph() = default;
 
+/**
+ * Takes the vertices and edges of another Graph, leaving it empty
+ * @param other - Graph to move
+ */
+Graph::Graph(Graph &&other) noexcept: totalEdges(other.totalEdges), vertexSet(std::move(other.vertexSet)),
+                                      idToVertex(std::move(other.idToVertex)) {
+    other.totalEdges = 0;
+    other.vertexSet.clear();
+    other.idToVertex.clear();
+}
+
+/**
+ * Deletes the vertices and edges of this Graph and takes those of another, leaving it empty
+ * @param other - Graph to move
+ * @return This Graph
+ */
+Graph &Graph::operator=(Graph &&other) noexcept {
+    if (this == &other) return *this;
+    clear();
+    totalEdges = other.totalEdges;
+    vertexSet = std::move(other.vertexSet);
+    idToVertex = std::move(other.idToVertex);
+    other.totalEdges = 0;
+    other.vertexSet.clear();
+    other.idToVertex.clear();
+    return *this;
+}
+
+Graph::~Graph() {
+    clear();
+}
+
+/**
+ * Deletes every vertex and edge of the Graph
+ * Time Complexity: O(|V|+|E|)
+ */
+void Graph::clear() {
+    for (Vertex *v: vertexSet) {
+        for (Edge *e: v->getAdj()) delete e;
+    }
+    for (Vertex *v: vertexSet) delete v;
+    vertexSet.clear();
+    idToVertex.clear();
+    totalEdges = 0;
+}
+
 unsigned int Graph::getNumVertex() const {
     return (unsigned int) vertexSet.size();
 }
 
 std::vector<Vertex *> Graph::getVertexSet() const {
-    return vertexSet;
+    return {vertexSet.begin(), vertexSet.end()};
 }
 
 
@@ -39,6 +87,7 @@ Vertex *Graph::findVertex(const std::string &id) const {
  * @return True if successful, and false if a vertex with the given id already exists
  */
 bool Graph::addVertex(const std::string &id) {
+    TIME_OPERATION("graph", "add_vertex");
     if (findVertex(id) != nullptr)
         return false;
     vertexSet.push_back(new Vertex(id));
@@ -62,8 +111,24 @@ Graph::addAndGetBidirectionalEdge(const std::string &source, const std::string &
     if (v1 == nullptr || v2 == nullptr)
         return {nullptr, nullptr};
 
-    auto e1 = v1->addEdge(v2, c, service);
-    auto e2 = v2->addEdge(v1, c, service);
+    return addAndGetBidirectionalEdge(v1, v2, c, service);
+}
+
+/**
+ * Adds and returns a bidirectional edge between two vertices of the Graph, with a capacity of c, representing a
+ * Service s
+ * Time Complexity: O(1)
+ * @param source - Pointer to the source Vertex
+ * @param dest - Pointer to the destination Vertex
+ * @param c - Capacity of the Edge to be added
+ * @param service - Service of the Edge to be added
+ * @return Pair containing a pointer to the created Edge and to its reverse
+ */
+std::pair<Edge *, Edge *> Graph::addAndGetBidirectionalEdge(Vertex *source, Vertex *dest, unsigned int c,
+                                                            Service service) {
+    TIME_OPERATION("graph", "add_rail");
+    auto e1 = source->addEdge(dest, c, service);
+    auto e2 = dest->addEdge(source, c, service);
     e1->setReverse(e2);
     e2->setReverse(e1);
 
@@ -71,6 +136,41 @@ Graph::addAndGetBidirectionalEdge(const std::string &source, const std::string &
     return {e1, e2};
 }
 
+/**
+ * Removes every bidirectional edge between the vertices with id source and dest
+ * Time Complexity: O(deg(source) + deg(dest)) (average case)
+ * @param source - Id of one of the vertices
+ * @param dest - Id of the other vertex
+ * @return Number of bidirectional edges removed
+ */
+unsigned int Graph::removeBidirectionalEdges(const std::string &source, const std::string &dest) {
+    TIME_OPERATION("graph", "remove_rails");
+    auto v1 = findVertex(source);
+    auto v2 = findVertex(dest);
+    if (v1 == nullptr || v2 == nullptr || v1 == v2)
+        return 0;
+
+    unsigned int removed = 0;
+    for (Edge const *e: v1->getAdj())
+        if (e->getDest() == v2) removed++;
+    v1->removeEdge(dest);
+    v2->removeEdge(source);
+    totalEdges -= removed;
+    return removed;
+}
+
+/**
+ * Removes a single bidirectional edge, leaving any parallel edges between its vertices in place
+ * Time Complexity: O(deg(source) + deg(dest))
+ * @param edge - Pointer to either direction of the Edge, deleted by this call along with its reverse
+ */
+void Graph::removeBidirectionalEdge(Edge *edge) {
+    Edge *reverse = edge->getReverse();
+    edge->getOrig()->removeEdge(edge);
+    reverse->getOrig()->removeEdge(reverse);
+    totalEdges--;
+}
+
 /**
  * Single-source or Multi-source Edmonds-Karp algorithm to find the the network's max flow
  * Time Complexity: O(|VE²|)
@@ -81,6 +181,8 @@ Graph::addAndGetBidirectionalEdge(const std::string &source, const std::string &
  */
 
 unsigned int Graph::edmondsKarp(const std::list<std::string> &source, const std::string &target, Graph &residualGraph) {
+    TIME_OPERATION("graph", "edmonds_karp");
+    QUERY_STATS_PHASE(QueryPhase::MAX_FLOW);
     for (Vertex const *v: vertexSet) {
         for (Edge *e: v->getAdj()) {
             e->setFlow(0);
@@ -101,18 +203,20 @@ unsigned int Graph::edmondsKarp(const std::list<std::string> &source, const std:
 
         // Update the maximum flow with the bottleneck capacity
         maxFlow += bottleneckCapacity;
+        QUERY_STATS_ADD(augmentations, 1);
     }
     return maxFlow;
 }
 
 /**
- * Adapted BFS that checks if there is a valid path connecting the source and target vertices. Indicated for use on residual graphs
+ * Adapted BFS that checks if there is a valid path connecting the source and target vertices, through active stations only. Indicated for use on residual graphs
  * Time Complexity: O(|V| + |E|)
  * @param source - List of ids of the source Vertex(es)
  * @param target - Id of the target Vertex
  * @return True if a path was found, false if not
  */
 bool Graph::path(const std::list<std::string> &source, const std::string &target) const {
+    TIME_OPERATION("graph", "path");
 
     for (Vertex *v: vertexSet) {
         v->setVisited(false);
@@ -121,65 +225,85 @@ bool Graph::path(const std::list<std::string> &source, const std::string &target
 
     std::queue<std::string> q;
     for (const auto &it: source) {
+        if (!findVertex(it)->isActive()) continue;
         q.push(it);
         findVertex(it)->setVisited(true);
     }
 
+    unsigned long long arcsScanned = 0;
+    QUERY_STATS_ADD(searches, 1);
     while (!q.empty()) {
         Vertex const *currentVertex = findVertex(q.front());
         q.pop();
         for (Edge *e: currentVertex->getAdj()) {
-            if (!e->getDest()->isVisited() && e->getCapacity() > 0 && e->isSelected()) {
+            arcsScanned++;
+            if (!e->getDest()->isVisited() && e->getCapacity() > 0 && e->isSelected() && e->getDest()->isActive()) {
                 q.push(e->getDest()->getId());
                 e->getDest()->setVisited(true);
                 e->getDest()->setPath(e);
-                if (e->getDest()->getId() == target) return true;
+                if (e->getDest()->getId() == target) {
+                    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+                    return true;
+                }
             }
         }
     }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
     return false;
 }
 
 /**
- * Bellman-Ford algorithm variation that returns a list of edges belonging to a negative cycle that was found
+ * Bellman-Ford algorithm variation that returns a list of edges belonging to a negative cycle that was found. Every
+ * vertex starts at distance 0, as if a virtual source reached all of them for free, so cycles anywhere in the graph are
+ * found, not only those reachable from a given vertex. Edges without capacity, deactivated edges and edges of closed
+ * stations are ignored
  * Time Complexity: O(|VE|)
- * @param source - Id of source Vertex, to which distances will be relative to
- * @return List of pointers to Edges that belong to a negative cycle, or an empty list if no negative cycle was found
+ * @return List of pointers to the Edges of a negative cycle, in order, or an empty list if no negative cycle was found
  */
-std::list<Edge *> Graph::bellmanFord(const std::string &source) {
+std::list<Edge *> Graph::bellmanFord() {
+    TIME_OPERATION("graph", "bellman_ford");
     for (Vertex *v: vertexSet) {
-        v->setCost(UINT32_MAX);
+        v->setCost(0);
         v->setPath(nullptr);
     }
-    findVertex(source)->setCost(0);
+    unsigned long long arcsScanned = 0;
+    unsigned long long relaxations = 0;
+    QUERY_STATS_ADD(searches, 1);
 
-    for (int i = 1; i <= vertexSet.size(); i++) { //V times
+    for (size_t i = 1; i <= vertexSet.size(); i++) { //V times
+        bool relaxed = false;
         for (Vertex *v: vertexSet) { //Relax every Edge
             for (Edge *e: v->getIncoming()) {
-                if (e->getCapacity() > 0) {
-                    int tempCost = e->getOrig()->getCost() + e->getCost();
-                    if (tempCost < v->getCost()) {
-                        if (i == vertexSet.size()) { //Edge being relaxed on Nth iteration - Negative cycle!
-                            Vertex *currentVertex = v;
-                            std::list<Edge *> negativeCycle;
-
-                            //Get beginning of cycle
-                            for (int j = 0; j < vertexSet.size(); j++) {
-                                currentVertex = currentVertex->getPath()->getOrig();
-                            }
-
-                            for (Vertex *temp = currentVertex;; temp = temp->getPath()->getOrig()) {
-                                negativeCycle.push_back(currentVertex->getPath());
-                                if (temp == currentVertex && negativeCycle.size() > 1) return negativeCycle;
-                            }
-                        }
-                        v->setCost(tempCost);
-                        v->setPath(e);
-                    }
-                }
+                arcsScanned++;
+                if (e->getCapacity() == 0 || !e->isSelected() || !e->getOrig()->isActive() || !v->isActive())
+                    continue;
+                int tempCost = e->getOrig()->getCost() + e->getCost();
+                if (tempCost >= v->getCost()) continue;
+                v->setCost(tempCost);
+                v->setPath(e);
+                relaxations++;
+                relaxed = true;
+                if (i < vertexSet.size()) continue;
+
+                //Edge relaxed on the Nth iteration - Negative cycle! Going back N edges surely lands on it
+                QUERY_STATS_ADD(arcsScanned, arcsScanned);
+                QUERY_STATS_ADD(relaxations, relaxations);
+                Vertex *currentVertex = v;
+                for (size_t j = 0; j < vertexSet.size(); j++) currentVertex = currentVertex->getPath()->getOrig();
+
+                std::list<Edge *> negativeCycle;
+                Vertex *temp = currentVertex;
+                do {
+                    negativeCycle.push_front(temp->getPath());
+                    temp = temp->getPath()->getOrig();
+                } while (temp != currentVertex);
+                return negativeCycle;
             }
         }
+        if (!relaxed) break; //Distances are final, so there is no negative cycle
     }
+    QUERY_STATS_ADD(arcsScanned, arcsScanned);
+    QUERY_STATS_ADD(relaxations, relaxations);
     return {};
 }
 
@@ -192,17 +316,20 @@ std::list<Edge *> Graph::bellmanFord(const std::string &source) {
  */
 std::pair<unsigned int, unsigned int>
 Graph::minCostMaxFlow(const std::string &source, const std::string &target, Graph &residualGraph) {
+    TIME_OPERATION("graph", "min_cost_max_flow");
+    QUERY_STATS_PHASE(QueryPhase::MIN_COST);
     std::pair<unsigned int, unsigned int> result;
     result.first = edmondsKarp({source}, target, residualGraph);
 
     Graph minCostResidual;
     makeMinCostResidual(minCostResidual);
 
-    std::list<Edge *> negativeCycle = minCostResidual.bellmanFord(source);
+    std::list<Edge *> negativeCycle = minCostResidual.bellmanFord();
     while (!negativeCycle.empty()) {
         unsigned int bottleneckCapacity = findListBottleneck(negativeCycle);
         augmentMinCostPath(negativeCycle, bottleneckCapacity);
-        negativeCycle = minCostResidual.bellmanFord(source);
+        QUERY_STATS_ADD(cyclesCancelled, 1);
+        negativeCycle = minCostResidual.bellmanFord();
     }
 
     unsigned int cost = 0;
@@ -259,7 +386,7 @@ unsigned int Graph::findListBottleneck(const std::list<Edge *> &edges) {
 
 
 /**
- * Augments or reduces the flow in the regular Graph path connecting source to target by value units, and updates the residual network. Indicated for use on residual graphs
+ * Augments the flow in the regular Graph path connecting source to target by value units, and updates the residual network. Flow in the opposite direction of a rail is cancelled before any is added in the path's direction, so the residual capacity of every edge stays its capacity minus its flow plus the flow of its reverse. Indicated for use on residual graphs
  * Time Complexity: O(|E|)
  * @param target - Id of the target Vertex
  * @param value - Number of units to alter the flow by
@@ -273,29 +400,15 @@ void Graph::augmentPath(const std::string &target, const unsigned int &value) co
         Edge *regularEdge = residualEdge->getCorrespondingEdge();
         Edge *reverseRegularEdge = regularEdge->getReverse();
 
+        //Cancel the flow in the opposite direction first, then augment the flow in this one
+        unsigned int cancelled = std::min(value, reverseRegularEdge->getFlow());
+        reverseRegularEdge->setFlow(reverseRegularEdge->getFlow() - cancelled);
+        regularEdge->setFlow(regularEdge->getFlow() + value - cancelled);
 
-        if (regularEdge->getFlow() + value > regularEdge->getCapacity()) { //Intended value exceeds capacity
-
-            //Augment flow in regular graph
-            unsigned int intendedValue = regularEdge->getFlow() + value;
-            regularEdge->setFlow(regularEdge->getCapacity());
-            reverseRegularEdge->setFlow(reverseRegularEdge->getFlow() - (intendedValue -
-                                                                         regularEdge->getCapacity())); //Reduce reverse edge flow by exceeding amount
-            //Update residual Graph edges
-            residualEdge->setCapacity(0);
-            reverseResidualEdge->setCapacity(reverseResidualEdge->getCapacity() + (intendedValue -
-                                                                                   regularEdge->getCapacity()));
+        //Update residual Graph edges
+        residualEdge->setCapacity(residualEdge->getCapacity() - value);
+        reverseResidualEdge->setCapacity(reverseResidualEdge->getCapacity() + value);
 
-        } else { //Intended value is within capacity
-
-            //Augment flow in regular graph
-            regularEdge->setFlow(regularEdge->getFlow() + value);
-
-            //Update residual Graph edges
-            residualEdge->setCapacity(regularEdge->getCapacity() - regularEdge->getFlow());
-            reverseResidualEdge->setCapacity(reverseResidualEdge->getCapacity() + value);
-
-        }
         currentVertex = currentVertex->getPath()->getOrig();
     }
 }
@@ -315,18 +428,13 @@ void Graph::augmentMinCostPath(const std::list<Edge *> &edges, const unsigned in
         if (residualEdge->getCost() < 0) {
             //Reduce flow in regular graph
             regularEdge->setFlow(regularEdge->getFlow() - value);
-
-            //Update residual Graph edges
-            residualEdge->setCapacity(residualEdge->getCapacity() + value);
-            reverseResidualEdge->setCapacity(reverseResidualEdge->getCapacity() - value);
         } else {
             //Augment flow in regular graph
             regularEdge->setFlow(regularEdge->getFlow() + value);
-
-            //Update residual Graph edges
-            residualEdge->setCapacity(residualEdge->getCapacity() - value);
-            reverseResidualEdge->setCapacity(reverseResidualEdge->getCapacity() + value);
         }
+        //Update residual Graph edges, the edge used loses the capacity its reverse gains
+        residualEdge->setCapacity(residualEdge->getCapacity() - value);
+        reverseResidualEdge->setCapacity(reverseResidualEdge->getCapacity() + value);
     }
 }
 
@@ -338,6 +446,7 @@ void Graph::augmentMinCostPath(const std::list<Edge *> &edges, const unsigned in
  * @return A vector of pointers to all the Edges chosen
  */
 std::vector<Edge *> Graph::randomlySelectEdges(unsigned int numEdges) {
+    TIME_OPERATION("graph", "randomly_select_edges");
     unsigned int stationNum;
     Vertex *currentVertex;
     unsigned int choice;
@@ -385,6 +494,54 @@ void Graph::activateEdges(const std::vector<Edge *> &edges) {
     }
 }
 
+/**
+ * Closes the stations with the given ids, in this Graph and in its residual network
+ * Time Complexity: O(size(ids)) (average case)
+ * @param ids - Ids of the stations to be closed
+ * @param residualGraph - Graph object representing this Graph's residual network
+ */
+void Graph::deactivateVertices(const std::vector<std::string> &ids, Graph &residualGraph) const {
+    for (const std::string &id: ids) {
+        findVertex(id)->setActive(false);
+        residualGraph.findVertex(id)->setActive(false);
+    }
+}
+
+/**
+ * Reopens the stations with the given ids, in this Graph and in its residual network
+ * Time Complexity: O(size(ids)) (average case)
+ * @param ids - Ids of the stations to be reopened
+ * @param residualGraph - Graph object representing this Graph's residual network
+ */
+void Graph::activateVertices(const std::vector<std::string> &ids, Graph &residualGraph) const {
+    for (const std::string &id: ids) {
+        findVertex(id)->setActive(true);
+        residualGraph.findVertex(id)->setActive(true);
+    }
+}
+
+/**
+ * Calculates the maximum flow between a source vertex and a target vertex with the given stations being closed and reopened after calculating the maximum flow
+ * Time Complexity: O(|VE²|)
+ * @param stations - Ids of the stations to be closed and later reopened
+ * @param source - List of Ids of source vertexes
+ * @param target - Id of the target Vertex
+ * @param residualGraph - Graph object representing this Graph's residual network
+ * @return A pair with the max flow before closing the stations and after
+ */
+std::pair<unsigned int, unsigned int>
+Graph::maxFlowDeactivatedVertices(const std::vector<std::string> &stations, const std::list<std::string> &source,
+                                  const std::string &target, Graph &residualGraph) {
+    TIME_OPERATION("graph", "max_flow_deactivated_vertices");
+    std::pair<unsigned int, unsigned int> result;
+    result.first = edmondsKarp(source, target, residualGraph);
+    deactivateVertices(stations, residualGraph);
+    result.second = edmondsKarp(source, target, residualGraph);
+    activateVertices(stations, residualGraph);
+
+    return result;
+}
+
 /**
  * Calculates the maximum flow between a source vertex and a target vertex with the edges inputted to the function being deactivated and reactivated after calculating the maximum flow
  * Time Complexity: O(|VE²|)
@@ -397,6 +554,7 @@ void Graph::activateEdges(const std::vector<Edge *> &edges) {
 std::pair<unsigned int, unsigned int>
 Graph::maxFlowDeactivatedEdges(const std::vector<Edge *> &selectedEdges, const std::list<std::string> &source,
                                const std::string &target, Graph &residualGraph) {
+    TIME_OPERATION("graph", "max_flow_deactivated_edges");
 
     std::pair<unsigned int, unsigned int> result;
     result.first = edmondsKarp(source, target, residualGraph);
@@ -414,6 +572,7 @@ Graph::maxFlowDeactivatedEdges(const std::vector<Edge *> &selectedEdges, const s
  * @param stationId - Id of the starting station
 */
 std::list<std::string> Graph::findEndOfLines(const std::string &stationId) const {
+    TIME_OPERATION("graph", "find_end_of_lines");
     std::list<std::string> eol_stations;
     std::queue<Vertex *> q;
 
@@ -444,6 +603,7 @@ std::list<std::string> Graph::findEndOfLines(const std::string &stationId) const
  */
 std::vector<std::pair<std::string, std::pair<unsigned int, unsigned int>>>
 Graph::topReductions(const std::vector<Edge *> &edges, Graph &residualGraph) {
+    TIME_OPERATION("graph", "top_reductions");
     std::vector<std::pair<std::string, std::pair<unsigned int, unsigned int>>> result;
 
     for (Vertex *v: vertexSet) {
@@ -469,6 +629,7 @@ Graph::topReductions(const std::vector<Edge *> &edges, Graph &residualGraph) {
  * @return A list with every vertex id on the edges of the connected component except the one selected in the function
  */
 std::list<std::string> Graph::superSourceCreator(const std::string &vertexId) const {
+    TIME_OPERATION("graph", "super_source");
     std::list<std::string> superSource = findEndOfLines(vertexId);
     for (auto it = superSource.begin(); it != superSource.end(); it++)
         if (*it == vertexId) {
@@ -500,6 +661,7 @@ void Graph::visitedDFS(Vertex *source) {
  */
 std::pair<std::list<std::pair<std::string, std::string>>, unsigned int>
 Graph::calculateNetworkMaxFlow(Graph &residualGraph) {
+    TIME_OPERATION("graph", "network_max_flow");
     unsigned int max = 0;
     std::list<std::pair<std::string, std::string>> stationList;
     for (auto itV1 = vertexSet.begin(); itV1 < vertexSet.end(); itV1++) {
@@ -529,6 +691,7 @@ Graph::calculateNetworkMaxFlow(Graph &residualGraph) {
  * @return Max flow that can arrive at the given vertex from all the network
  */
 unsigned int Graph::incomingFlux(const std::string &station, Graph &residualGraph) {
+    TIME_OPERATION("graph", "incoming_flux");
     std::list<std::string> superSource = superSourceCreator(station);
     return edmondsKarp(superSource, station, residualGraph);
 }
@@ -543,6 +706,7 @@ unsigned int Graph::incomingFlux(const std::string &station, Graph &residualGrap
  */
 unsigned int
 Graph::incomingReducedFlux(const std::vector<Edge *> &edges, const std::string &station, Graph &residualGraph) {
+    TIME_OPERATION("graph", "incoming_reduced_flux");
     std::list<std::string> superSource = superSourceCreator(station);
     deactivateEdges(edges);
     unsigned int result = edmondsKarp(superSource, station, residualGraph);
@@ -559,31 +723,68 @@ sort_pair_decreasing_second(const std::pair<std::string, double> &left, const st
 /**
  * Creates an ordered vector with incoming fluxes of previously grouped stations
  * Time Complexity: O(|V²E²| * m), with m being the size of group
- * @param group - Map that identifies a group of stations
+ * @param dataRepository - Repository the grouping and its stations belong to
+ * @param grouping - Attribute by which the stations are grouped
  * @param residualGraph - Graph object representing the graph's residual network
  * @return An ordered vector of pairs with decreasing average flow (second element), identified by its grouping name (first element)
  */
 std::vector<std::pair<std::string, double>>
-Graph::topGroupings(const std::unordered_map<std::string, std::list<Station>> &group, Graph &residualGraph) {
+Graph::topGroupings(const DataRepository &dataRepository, Grouping grouping, Graph &residualGraph) {
+    TIME_OPERATION("graph", "top_groupings");
     std::vector<std::pair<std::string, double>> result;
-    for (const auto &it: group) {
-        double average = getAverageIncomingFlux(it.second, residualGraph);
-        result.emplace_back(it.first, average);
+    for (unsigned int group = 0; group < dataRepository.getNumGroups(grouping); group++) {
+        double average = getAverageIncomingFlux(dataRepository, dataRepository.getGroupStations(grouping, group),
+                                                residualGraph);
+        result.emplace_back(dataRepository.getString(dataRepository.getGroupName(grouping, group)), average);
     }
     std::sort(result.begin(), result.end(), sort_pair_decreasing_second);
     return result;
 }
 
+/**
+ * Finds the k groupings with the highest average incoming flux, without computing it for every grouping (see
+ * DataRepository::topGroups). No flux into a station exceeds the capacity of the rails arriving at it, so those
+ * capacities bound the averages from above
+ * Time Complexity: O(|V|+|E| + g log g + e|VE²|), g being the number of groupings and e the number of stations evaluated
+ * @param dataRepository - Repository the grouping and its stations belong to
+ * @param grouping - Attribute by which the stations are grouped
+ * @param k - Number of groupings wanted
+ * @param residualGraph - Graph object representing the graph's residual network
+ * @return An ordered vector of at most k pairs with decreasing average flow (second element), identified by its grouping
+ * name (first element). Groupings with the same average keep their order in the repository
+ */
+std::vector<std::pair<std::string, double>>
+Graph::topGroupings(const DataRepository &dataRepository, Grouping grouping, unsigned int k, Graph &residualGraph) {
+    TIME_OPERATION("graph", "top_k_groupings");
+    auto incomingCapacity = [this, &dataRepository](unsigned int s) {
+        double capacity = 0;
+        Vertex const *v = findVertex(dataRepository.getString(dataRepository.getStations()[s].getName()));
+        for (Edge const *e: v->getIncoming()) capacity += e->getCapacity();
+        return capacity;
+    };
+    auto averageFluxes = [&](const std::vector<unsigned int> &groups) {
+        std::vector<double> averages;
+        for (unsigned int group: groups)
+            averages.push_back(getAverageIncomingFlux(dataRepository, dataRepository.getGroupStations(grouping, group),
+                                                      residualGraph));
+        return averages;
+    };
+    return dataRepository.topGroups(grouping, k, incomingCapacity, averageFluxes);
+}
+
 /**
  * Finds the average incoming flux for every station in a list (normally, representing a township, etc.)
  * Time Complexity: O(n|VE²|), n being the size of stations
- * @param stations - List with the stations' id
+ * @param dataRepository - Repository the stations belong to
+ * @param stations - Span with the stations' indexes in the repository
  * @param residualGraph - Graph object representing the graph's residual network
  */
-double Graph::getAverageIncomingFlux(const std::list<Station> &stations, Graph &residualGraph) {
+double Graph::getAverageIncomingFlux(const DataRepository &dataRepository, std::span<const unsigned int> stations,
+                                     Graph &residualGraph) {
+    TIME_OPERATION("graph", "average_incoming_flux");
     double flux_sum = 0;
-    for (const Station &s: stations) {
-        const std::string &sid = s.getName();
+    for (unsigned int s: stations) {
+        const std::string &sid = dataRepository.getString(dataRepository.getStations()[s].getName());
         flux_sum += incomingFlux(sid, residualGraph);
     }
     return flux_sum / (double) stations.size();
@@ -595,21 +796,136 @@ double Graph::getAverageIncomingFlux(const std::list<Station> &stations, Graph &
  * @param minCostResidual - Graph object in which to construct the residual network
  */
 void Graph::makeMinCostResidual(Graph &minCostResidual) {
+    TIME_OPERATION("graph", "make_min_cost_residual");
     for (Vertex *v: vertexSet) {
         minCostResidual.addVertex(v->getId());
+        minCostResidual.findVertex(v->getId())->setActive(v->isActive());
     }
     for (Vertex *v: vertexSet) {
         for (Edge *e: v->getAdj()) {
             auto [edge, negativeCostEdge] = minCostResidual.addAndGetBidirectionalEdge(
                     e->getOrig()->getId(), e->getDest()->getId(), e->getCapacity(), e->getService());
 
-            negativeCostEdge->setCost(-edge->getCost());
+            edge->setCost(e->getCost());
+            negativeCostEdge->setCost(-e->getCost());
 
             edge->setCapacity(e->getCapacity() - e->getFlow());
             negativeCostEdge->setCapacity(e->getFlow());
 
             edge->setCorrespondingEdge(e);
             negativeCostEdge->setCorrespondingEdge(e);
+
+            //Failed rails can't carry flow, and the flow they had was already removed by Edmonds-Karp
+            edge->setSelected(e->isSelected());
+            negativeCostEdge->setSelected(e->isSelected());
+        }
+    }
+}
+
+/**
+ * Stoer-Wagner algorithm for the global minimum cut of the undirected rail network, i.e. the smallest total capacity of
+ * rails whose loss splits the network in two. Each phase builds a maximum adjacency ordering with a lazy max-heap and
+ * merges the last two vertices. Deactivated rails are ignored
+ * Time Complexity: O(|V||E|log|V|)
+ * @param stationId - Id of a station of the connected component to cut. If empty, the largest component is used
+ * @return MinCut with the cut's capacity, the rails crossing it (directed from sideA to sideB) and both sides
+ */
+MinCut Graph::globalMinCut(const std::string &stationId) const {
+    TIME_OPERATION("graph", "global_min_cut");
+    //Select the connected component to cut
+    std::vector<Vertex *> component;
+    for (Vertex *v: vertexSet) v->setVisited(false);
+    for (Vertex *root: vertexSet) {
+        if (root->isVisited() || (!stationId.empty() && root->getId() != stationId)) continue;
+        std::vector<Vertex *> current = {root};
+        root->setVisited(true);
+        for (size_t i = 0; i < current.size(); i++) {
+            for (Edge const *e: current[i]->getAdj()) {
+                if (!e->getDest()->isVisited()) {
+                    e->getDest()->setVisited(true);
+                    current.push_back(e->getDest());
+                }
+            }
+        }
+        if (current.size() > component.size()) component = current;
+    }
+
+    MinCut result;
+    if (component.size() < 2) {
+        for (Vertex const *v: component) result.sideA.push_back(v->getId());
+        return result;
+    }
+
+    std::unordered_map<const Vertex *, unsigned int> index;
+    for (unsigned int i = 0; i < component.size(); i++) index[component[i]] = i;
+
+    auto n = (unsigned int) component.size();
+    std::vector<std::unordered_map<unsigned int, unsigned long long>> weight(n);
+    for (Vertex const *v: component) {
+        for (Edge *e: v->getAdj()) {
+            if (!e->isSelected() || e->getDest() == v || !std::less<Edge *>()(e, e->getReverse())) continue;
+            unsigned int a = index[v];
+            unsigned int b = index[e->getDest()];
+            weight[a][b] += e->getCapacity();
+            weight[b][a] += e->getCapacity();
         }
     }
-}
\ No newline at end of file
+
+    std::vector<std::vector<unsigned int>> members(n);
+    for (unsigned int i = 0; i < n; i++) members[i] = {i};
+    std::vector<bool> merged(n, false);
+    unsigned long long best = std::numeric_limits<unsigned long long>::max();
+    std::vector<unsigned int> bestSide;
+
+    for (unsigned int phase = 1; phase < n; phase++) {
+        std::vector<unsigned long long> key(n, 0);
+        std::vector<bool> added(n, false);
+        std::priority_queue<std::pair<unsigned long long, unsigned int>> heap;
+        for (unsigned int i = 0; i < n; i++) if (!merged[i]) heap.emplace(0, i);
+
+        unsigned int previous = n;
+        unsigned int last = n;
+        while (!heap.empty()) {
+            auto [currentKey, v] = heap.top();
+            heap.pop();
+            if (added[v] || currentKey != key[v]) continue; //Stale heap entry
+            added[v] = true;
+            previous = last;
+            last = v;
+            for (const auto &[u, w]: weight[v]) {
+                if (added[u]) continue;
+                key[u] += w;
+                heap.emplace(key[u], u);
+            }
+        }
+
+        if (key[last] < best) {
+            best = key[last];
+            bestSide = members[last];
+        }
+
+        //Merge the last vertex of the ordering into the previous one
+        for (const auto &[u, w]: weight[last]) {
+            if (u == previous) continue;
+            weight[previous][u] += w;
+            weight[u][previous] += w;
+            weight[u].erase(last);
+        }
+        weight[previous].erase(last);
+        weight[last].clear();
+        members[previous].insert(members[previous].end(), members[last].begin(), members[last].end());
+        merged[last] = true;
+    }
+
+    std::vector<bool> inSideA(n, false);
+    for (unsigned int i: bestSide) inSideA[i] = true;
+    result.capacity = best;
+    for (unsigned int i = 0; i < n; i++) {
+        (inSideA[i] ? result.sideA : result.sideB).push_back(component[i]->getId());
+        if (!inSideA[i]) continue;
+        for (Edge *e: component[i]->getAdj()) {
+            if (e->isSelected() && !inSideA[index[e->getDest()]]) result.rails.push_back(e);
+        }
+    }
+    return result;
+}
@@ -17,16 +17,40 @@
 
 #include "vertex.h"
 #include "station.h"
+#include "dataRepository.h"
+#include "memoryAccounting.h"
+
+/**
+ * Result of a global minimum cut query: the rails crossing the cut, their total capacity and the stations on each side
+ */
+struct MinCut {
+    unsigned long long capacity = 0;
+    std::list<Edge *> rails;
+    std::list<std::string> sideA;
+    std::list<std::string> sideB;
+};
 
 class Graph {
   private:
     unsigned int totalEdges = 0;
-    std::vector<Vertex *> vertexSet;    // vertex set
-    std::unordered_map<std::string, Vertex *> idToVertex;
+    CountedVector<Vertex *, MemoryCategory::ID_MAPS> vertexSet;    // vertex set
+    CountedMap<std::string, Vertex *, MemoryCategory::ID_MAPS> idToVertex;
+
+    void clear();
 
   public:
     Graph();
 
+    Graph(const Graph &) = delete;
+
+    Graph &operator=(const Graph &) = delete;
+
+    Graph(Graph &&other) noexcept;
+
+    Graph &operator=(Graph &&other) noexcept;
+
+    ~Graph();
+
     [[nodiscard]] Vertex *findVertex(const std::string &id) const;
 
     bool addVertex(const std::string &id);
@@ -57,6 +81,13 @@ class Graph {
     std::pair<Edge *, Edge *>
     addAndGetBidirectionalEdge(const std::string &source, const std::string &dest, unsigned int c, Service service);
 
+    std::pair<Edge *, Edge *>
+    addAndGetBidirectionalEdge(Vertex *source, Vertex *dest, unsigned int c, Service service);
+
+    unsigned int removeBidirectionalEdges(const std::string &source, const std::string &dest);
+
+    void removeBidirectionalEdge(Edge *edge);
+
     std::pair<unsigned int, unsigned int>
 
     minCostMaxFlow(const std::string &source, const std::string &target, Graph &residualGraph);
@@ -68,11 +99,15 @@ class Graph {
     static void augmentMinCostPath(const std::list<Edge *> &edges, const unsigned int &value);
 
     std::vector<std::pair<std::string, double>>
-    topGroupings(const std::unordered_map<std::string, std::list<Station>> &group, Graph &residualGraph);
+    topGroupings(const DataRepository &dataRepository, Grouping grouping, Graph &residualGraph);
 
-    double getAverageIncomingFlux(const std::list<Station> &stations, Graph &residualGraph);
+    std::vector<std::pair<std::string, double>>
+    topGroupings(const DataRepository &dataRepository, Grouping grouping, unsigned int k, Graph &residualGraph);
 
-    std::list<Edge *> bellmanFord(const std::string &source);
+    double getAverageIncomingFlux(const DataRepository &dataRepository, std::span<const unsigned int> stations,
+                                  Graph &residualGraph);
+
+    std::list<Edge *> bellmanFord();
 
     void visitedDFS(Vertex *source);
 
@@ -89,8 +124,18 @@ class Graph {
 
     static void deactivateEdges(const std::vector<Edge *> &edges);
 
+    void deactivateVertices(const std::vector<std::string> &ids, Graph &residualGraph) const;
+
+    void activateVertices(const std::vector<std::string> &ids, Graph &residualGraph) const;
+
+    std::pair<unsigned int, unsigned int>
+    maxFlowDeactivatedVertices(const std::vector<std::string> &stations, const std::list<std::string> &source,
+                               const std::string &target, Graph &residualGraph);
+
     std::vector<std::pair<std::string, std::pair<unsigned int, unsigned int>>>
     topReductions(const std::vector<Edge *> &edges, Graph &residualGraph);
+
+    [[nodiscard]] MinCut globalMinCut(const std::string &stationId = "") const;
 };
 
 
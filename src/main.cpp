@@ -1,7 +1,141 @@
 #include "menu.h"
+#include "railwayManagement.h"
 
-int main() {
-    Menu menu;
-    menu.minCostExample();
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static std::atomic<bool> stopServer(false);
+
+static void requestStop(int) {
+    stopServer = true;
+}
+
+/**
+ * Parses an unsigned command line value
+ * @return True if the whole value is a number, false otherwise
+ */
+static bool parseNumber(const char *value, unsigned int &number) {
+    auto [end, error] = std::from_chars(value, value + strlen(value), number);
+    return error == std::errc() && *end == '\0';
+}
+
+/**
+ * Usage: RailwayManagement [--stations PATH] [--network PATH] [--batch SCRIPT|- [--threads N]] [--socket PATH|--port N]
+ *                          [--stats] [--metrics-file PATH] [--metrics-port N]
+ * By default the interactive menu is started. With --batch, the queries in SCRIPT (or the standard input, for -) are
+ * run and their results written to the standard output as lines of JSON. With --socket or --port, the network is
+ * served to local clients over a Unix-domain socket or a loopback TCP port until the process is interrupted. With
+ * --stats, the work counters of each operation are printed after it (menu) or added to its result (batch and server),
+ * if the project was built with RAILWAY_INSTRUMENTATION. With --metrics-file or --metrics-port, the latency of every
+ * Graph operation and query is recorded and published in the Prometheus text format, by rewriting PATH every 10 seconds
+ * and on exit, or by answering GET /metrics on loopback port N
+ */
+int main(int argc, char *argv[]) {
+    std::string stationsFilePath = "../dataset/stations.csv";
+    std::string networkFilePath = "../dataset/network.csv";
+    std::string scriptPath;
+    std::string socketPath;
+    std::string metricsFilePath;
+    unsigned int threads = 0;
+    unsigned int port = 0;
+    unsigned int metricsPort = 0;
+    bool serve = false;
+    bool stats = false;
+    const char *usage = " [--stations PATH] [--network PATH] [--batch SCRIPT|- [--threads N]] [--socket PATH|--port N]"
+                        " [--stats] [--metrics-file PATH] [--metrics-port N]";
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && strcmp(argv[i], "--stations") == 0) {
+            stationsFilePath = argv[++i];
+        } else if (hasValue && strcmp(argv[i], "--network") == 0) {
+            networkFilePath = argv[++i];
+        } else if (hasValue && strcmp(argv[i], "--batch") == 0) {
+            scriptPath = argv[++i];
+        } else if (hasValue && strcmp(argv[i], "--threads") == 0) {
+            if (!parseNumber(argv[++i], threads)) {
+                std::cerr << "Invalid number of threads " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (hasValue && strcmp(argv[i], "--socket") == 0) {
+            socketPath = argv[++i];
+            serve = true;
+        } else if (hasValue && strcmp(argv[i], "--port") == 0) {
+            if (!parseNumber(argv[++i], port) || port > 65535) {
+                std::cerr << "Invalid port " << argv[i] << std::endl;
+                return 2;
+            }
+            serve = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (hasValue && strcmp(argv[i], "--metrics-file") == 0) {
+            metricsFilePath = argv[++i];
+        } else if (hasValue && strcmp(argv[i], "--metrics-port") == 0) {
+            if (!parseNumber(argv[++i], metricsPort) || metricsPort == 0 || metricsPort > 65535) {
+                std::cerr << "Invalid port " << argv[i] << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "Usage: " << argv[0] << usage << std::endl;
+            return 2;
+        }
+    }
+    if (stats && !QueryStats::ENABLED)
+        std::cerr << "--stats has no effect: the project was built without RAILWAY_INSTRUMENTATION" << std::endl;
+    if (serve && !scriptPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << usage << std::endl;
+        return 2;
+    }
+
+    MetricsExporter metricsExporter;
+    if (metricsPort != 0 && !metricsExporter.listenHttp((unsigned short) metricsPort)) {
+        std::cerr << "Could not listen on 127.0.0.1:" << metricsPort << std::endl;
+        return 1;
+    }
+    metricsExporter.setFile(metricsFilePath, std::chrono::seconds(10));
+    OperationMetrics::setEnabled(metricsPort != 0 || !metricsFilePath.empty());
+    metricsExporter.start();
+
+    RailwayNetwork network(stationsFilePath, networkFilePath);
+    if (scriptPath.empty() && !serve) {
+        Menu menu(network);
+        menu.setShowStats(stats);
+        menu.initializeMenu();
+        return 0;
+    }
+
+    //Headless modes keep the standard output for results, so the load report goes to the standard error
+    std::ostringstream script;
+    if (scriptPath == "-") {
+        script << std::cin.rdbuf();
+    } else if (!scriptPath.empty()) {
+        std::ifstream file(scriptPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "Could not open the query script " << scriptPath << std::endl;
+            return 1;
+        }
+        script << file.rdbuf();
+    }
+    network.load(std::cerr);
+    QueryEngine queryEngine(network.getDataRepository(), network.getFlowNetwork(), &network.getWidestPathTree(),
+                            &network.getContractionHierarchy(RouteMetric::COST),
+                            &network.getContractionHierarchy(RouteMetric::HOPS));
+    queryEngine.setIncludeStats(stats);
+    if (!serve) return queryEngine.runScript(script.str(), std::cout, threads);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    QueryServer server(queryEngine);
+    std::string address = socketPath.empty() ? "127.0.0.1:" + std::to_string(port) : socketPath;
+    if (!(socketPath.empty() ? server.listenTcp((unsigned short) port) : server.listenUnix(socketPath))) {
+        std::cerr << "Could not listen on " << address << std::endl;
+        return 1;
+    }
+    std::cerr << "Listening on " << address << std::endl;
+    server.run(stopServer);
     return 0;
-}
\ No newline at end of file
+}
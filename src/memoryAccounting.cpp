@@ -0,0 +1,151 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "memoryAccounting.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifndef _WIN32
+
+#include <unistd.h>
+
+#endif
+
+static std::atomic<long long> liveBytes[MemoryAccounting::NUM_CATEGORIES];
+static std::atomic<long long> liveBlocks[MemoryAccounting::NUM_CATEGORIES];
+static std::atomic<long long> peakBytes[MemoryAccounting::NUM_CATEGORIES];
+
+static const char *const CATEGORY_NAMES[MemoryAccounting::NUM_CATEGORIES] = {
+        "vertices", "edges", "adjacency", "id_maps", "stations", "symbols", "groupings", "flow_network",
+        "contraction", "bridges", "widest_paths", "route_hierarchies"};
+
+/**
+ * Accounts an allocation
+ * Time Complexity: O(1)
+ * @param category - Category the memory belongs to
+ * @param bytes - Size of the allocation
+ */
+void MemoryAccounting::allocated(MemoryCategory category, size_t bytes) {
+    auto c = (unsigned int) category;
+    long long now = liveBytes[c].fetch_add((long long) bytes, std::memory_order_relaxed) + (long long) bytes;
+    liveBlocks[c].fetch_add(1, std::memory_order_relaxed);
+    long long peak = peakBytes[c].load(std::memory_order_relaxed);
+    while (now > peak && !peakBytes[c].compare_exchange_weak(peak, now, std::memory_order_relaxed));
+}
+
+/**
+ * Accounts a deallocation
+ * Time Complexity: O(1)
+ * @param category - Category the memory belonged to
+ * @param bytes - Size of the allocation
+ */
+void MemoryAccounting::released(MemoryCategory category, size_t bytes) {
+    auto c = (unsigned int) category;
+    liveBytes[c].fetch_sub((long long) bytes, std::memory_order_relaxed);
+    liveBlocks[c].fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * Size of the memory a string allocated for its contents
+ * @param string - String
+ * @return Bytes allocated, or 0 if the contents fit in the string itself
+ */
+size_t MemoryAccounting::stringBytes(const std::string &string) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return string.capacity() > inlineCapacity ? string.capacity() + 1 : 0;
+}
+
+MemoryUsage MemoryAccounting::usage(MemoryCategory category) {
+    auto c = (unsigned int) category;
+    return {liveBytes[c].load(std::memory_order_relaxed), liveBlocks[c].load(std::memory_order_relaxed),
+            peakBytes[c].load(std::memory_order_relaxed)};
+}
+
+const char *MemoryAccounting::name(MemoryCategory category) {
+    return CATEGORY_NAMES[(unsigned int) category];
+}
+
+/**
+ * Resident set size of the process, as reported by the operating system
+ * @return Bytes of physical memory in use, or -1 if they can't be determined
+ */
+long long MemoryAccounting::residentSetSize() {
+#ifndef _WIN32
+    std::ifstream statm("/proc/self/statm");
+    long long pages, residentPages;
+    if (statm >> pages >> residentPages) return residentPages * sysconf(_SC_PAGESIZE);
+#endif
+    return -1;
+}
+
+/**
+ * Prints a table with the memory of every category, their total and the resident set size
+ * @param out - Stream where the table is written
+ */
+void MemoryAccounting::printReport(std::ostream &out) {
+    std::ostringstream table;
+    table << std::left << std::setw(14) << "Structure" << std::right << std::setw(14) << "Bytes" << std::setw(12)
+          << "Blocks" << std::setw(14) << "Peak bytes" << '\n';
+    MemoryUsage total;
+    for (unsigned int c = 0; c < NUM_CATEGORIES; c++) {
+        MemoryUsage category = usage((MemoryCategory) c);
+        table << std::left << std::setw(14) << CATEGORY_NAMES[c] << std::right << std::setw(14) << category.bytes
+              << std::setw(12) << category.blocks << std::setw(14) << category.peakBytes << '\n';
+        total.bytes += category.bytes;
+        total.blocks += category.blocks;
+    }
+    table << std::left << std::setw(14) << "total" << std::right << std::setw(14) << total.bytes << std::setw(12)
+          << total.blocks << '\n';
+    long long rss = residentSetSize();
+    if (rss >= 0) table << std::left << std::setw(14) << "resident set" << std::right << std::setw(14) << rss << '\n';
+    out << table.str();
+}
+
+/**
+ * Describes the memory of every category as a JSON object
+ * @return JSON object with the bytes, blocks and peak bytes of each category, and the resident set size (null if
+ * unknown)
+ */
+std::string MemoryAccounting::toJson() {
+    std::ostringstream json;
+    json << "{\"structures\":{";
+    for (unsigned int c = 0; c < NUM_CATEGORIES; c++) {
+        MemoryUsage category = usage((MemoryCategory) c);
+        json << (c ? "," : "") << '"' << CATEGORY_NAMES[c] << "\":{\"bytes\":" << category.bytes << ",\"blocks\":"
+             << category.blocks << ",\"peak_bytes\":" << category.peakBytes << "}";
+    }
+    long long rss = residentSetSize();
+    json << "},\"resident_set_bytes\":";
+    if (rss >= 0) json << rss;
+    else json << "null";
+    json << "}";
+    return json.str();
+}
+
+/**
+ * Writes the memory of every category in the Prometheus text exposition format
+ * @param out - Stream where the metrics are written
+ */
+void MemoryAccounting::writePrometheus(std::ostream &out) {
+    std::ostringstream text;
+    text << "# HELP railway_memory_bytes Memory allocated to the network's structures\n"
+         << "# TYPE railway_memory_bytes gauge\n";
+    for (unsigned int c = 0; c < NUM_CATEGORIES; c++)
+        text << "railway_memory_bytes{structure=\"" << CATEGORY_NAMES[c] << "\"} " << usage((MemoryCategory) c).bytes
+             << '\n';
+    text << "# HELP railway_memory_peak_bytes Most memory ever allocated to the network's structures\n"
+         << "# TYPE railway_memory_peak_bytes gauge\n";
+    for (unsigned int c = 0; c < NUM_CATEGORIES; c++)
+        text << "railway_memory_peak_bytes{structure=\"" << CATEGORY_NAMES[c] << "\"} "
+             << usage((MemoryCategory) c).peakBytes << '\n';
+    long long rss = residentSetSize();
+    if (rss >= 0)
+        text << "# HELP railway_resident_set_bytes Resident set size of the process\n"
+             << "# TYPE railway_resident_set_bytes gauge\n"
+             << "railway_resident_set_bytes " << rss << '\n';
+    out << text.str();
+}
@@ -0,0 +1,118 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_MEMORYACCOUNTING_H
+#define RAILWAYMANAGEMENT_MEMORYACCOUNTING_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Kinds of long-lived structures whose memory is accounted for
+ */
+enum class MemoryCategory : unsigned int {
+    VERTICES, // Vertex objects of every Graph, with their ids
+    EDGES, // Edge objects of every Graph
+    ADJACENCY, // outgoing and incoming edge lists of the vertices
+    ID_MAPS, // vertex sets and id -> Vertex maps of the graphs
+    STATIONS, // station table of the DataRepository and its name index
+    SYMBOLS, // interned strings, with their index
+    GROUPINGS, // stations grouped by district, municipality, township and line
+    FLOW_NETWORK, // CSR arrays and indexes of the FlowNetwork
+    CONTRACTION, // super-edge maps of the ContractedGraph (its graphs count as vertices, edges, ...)
+    BRIDGES, // bridges, 2-edge-connected components and bridge tree of the BridgeDecomposition
+    WIDEST_PATHS, // maximum spanning forest and ancestor tables of the WidestPathTree
+    ROUTE_HIERARCHIES // upward edges and shortcuts of the ContractionHierarchy of each RouteMetric
+};
+
+/**
+ * Bytes and blocks of memory currently allocated to a category, and the most bytes it ever had
+ */
+struct MemoryUsage {
+    long long bytes = 0;
+    long long blocks = 0;
+    long long peakBytes = 0;
+};
+
+/**
+ * Process-wide memory accounting of the network's structures, fed by CountingAllocator and by the allocation operators
+ * of Vertex and Edge. Only the memory the structures request is counted, not the allocator's own overhead. The contents
+ * of vertex ids and symbols are counted when they don't fit in the string itself, those of other strings aren't.
+ * Temporary buffers of the queries aren't counted either, so the difference to the resident set size is the allocator
+ * overhead, the code and the transient memory
+ */
+class MemoryAccounting {
+  public:
+    static const unsigned int NUM_CATEGORIES = 12;
+
+    static void allocated(MemoryCategory category, size_t bytes);
+
+    static void released(MemoryCategory category, size_t bytes);
+
+    static size_t stringBytes(const std::string &string);
+
+    static MemoryUsage usage(MemoryCategory category);
+
+    static const char *name(MemoryCategory category);
+
+    static long long residentSetSize();
+
+    static void printReport(std::ostream &out);
+
+    static std::string toJson();
+
+    static void writePrometheus(std::ostream &out);
+};
+
+/**
+ * Standard allocator that accounts the memory it allocates to a MemoryCategory
+ */
+template<typename T, MemoryCategory category>
+class CountingAllocator {
+  public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef CountingAllocator<U, category> other;
+    };
+
+    CountingAllocator() noexcept = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U, category> &) noexcept {} // NOLINT(google-explicit-constructor)
+
+    T *allocate(size_t n) {
+        T *pointer = std::allocator<T>().allocate(n);
+        MemoryAccounting::allocated(category, n * sizeof(T));
+        return pointer;
+    }
+
+    void deallocate(T *pointer, size_t n) noexcept {
+        MemoryAccounting::released(category, n * sizeof(T));
+        std::allocator<T>().deallocate(pointer, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U, category> &) const noexcept {
+        return true;
+    }
+};
+
+template<typename T, MemoryCategory category>
+using CountedVector = std::vector<T, CountingAllocator<T, category>>;
+
+template<typename Key, typename Value, MemoryCategory category, typename Hash = std::hash<Key>>
+using CountedMap = std::unordered_map<Key, Value, Hash, std::equal_to<Key>,
+        CountingAllocator<std::pair<const Key, Value>, category>>;
+
+template<typename Key, MemoryCategory category>
+using CountedSet = std::unordered_set<Key, std::hash<Key>, std::equal_to<Key>, CountingAllocator<Key, category>>;
+
+#endif //RAILWAYMANAGEMENT_MEMORYACCOUNTING_H
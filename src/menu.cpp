@@ -4,21 +4,46 @@
 
 #include "menu.h"
 #include "station.h"
+#include "queryStats.h"
+#include "memoryAccounting.h"
 
 using namespace std;
 
 unsigned const Menu::COLUMN_WIDTH = 50;
 unsigned const Menu::COLUMNS_PER_LINE = 3;
-string const Menu::stationsFilePath = "../dataset/stations.csv";
-string const Menu::networkFilePath = "../dataset/network.csv";
 
-Menu::Menu() = default;
+/**
+ * Creates a menu over a network, which is loaded when the menu is initialized
+ * @param network - Network the menu queries
+ */
+Menu::Menu(RailwayNetwork &network) : network(network), dataRepository(network.getDataRepository()),
+                                      residualGraph(network.getResidualGraph()), graph(network.getGraph()),
+                                      contractedGraph(network.getContractedGraph()),
+                                      bridgeDecomposition(network.getBridgeDecomposition()),
+                                      flowNetwork(network.getFlowNetwork()),
+                                      widestPathTree(network.getWidestPathTree()) {}
+
+/**
+ * Chooses whether a summary of the work done by the algorithms (see QueryStats) is printed after each operation. Only
+ * has an effect if the project was built with instrumentation
+ * @param show - True to print the summaries, false otherwise
+ */
+void Menu::setShowStats(bool show) {
+    showStats = show && QueryStats::ENABLED;
+}
+
+/**
+ * Prints the work counted during the last operation, if summaries are enabled and there was any
+ */
+void Menu::printQueryStats() const {
+    if (showStats && !QueryStats::current().empty()) QueryStats::current().print(cout);
+}
 
 /**
  * Delegates initialization of the menu, calling the appropriate functions for information extraction and output
  */
 void Menu::initializeMenu() {
-    extractFileInfo();
+    network.load();
     mainMenu();
 }
 
@@ -108,6 +133,7 @@ void Menu::edmondsKarpExample() {
     residual9->setCorrespondingEdge(regular9);
     residualReverse9->setCorrespondingEdge(regularReverse9);
 
+    network.preprocessNetwork();
     mainMenu();
 }
 
@@ -197,6 +223,7 @@ void Menu::minCostExample() {
     residual9->setCorrespondingEdge(regular9);
     residualReverse9->setCorrespondingEdge(regularReverse9);
 
+    network.preprocessNetwork();
     mainMenu();
 }
 
@@ -262,19 +289,11 @@ void Menu::incomingFlowExample() {
     residual6->setCorrespondingEdge(regular6);
     residualReverse6->setCorrespondingEdge(regularReverse6);
 
+    network.preprocessNetwork();
     mainMenu();
 }
 
 
-/**
- * Delegates extracting file info, calling the appropriate functions for each file
- * Time Complexity: O(n*v), where n is the number of lines of network.csv and v is the number of lines in stations.csv
- */
-void Menu::extractFileInfo() {
-    extractStationsFile();
-    extractNetworkFile();
-}
-
 /**
  * Checks if the input given by the user is appropriate or not
  * Time Complexity: O(1)
@@ -335,7 +354,8 @@ void Menu::mainMenu() {
             cout << setw(COLUMN_WIDTH) << setfill(' ') << "Basic Service Metrics: [1]" << setw(COLUMN_WIDTH)
                  << "Operation Cost Optimization: [2]" << setw(COLUMN_WIDTH)
                  << "Reliability and Sensitivity to Line Failures: [3]" << endl;
-            cout << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
+            cout << setw(COLUMN_WIDTH) << "Apply Network Changes: [4]" << setw(COLUMN_WIDTH) << "Memory Usage: [5]"
+                 << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
         }
         cout << endl << "Press the appropriate key to the function you'd like to access: ";
         cin >> commandIn;
@@ -356,6 +376,18 @@ void Menu::mainMenu() {
                 commandIn = failuresMenu();
                 break;
             }
+            case '4': {
+                string path;
+                cout << "Enter the path of the file of changes: ";
+                getline(cin, path);
+                auto [applied, skipped] = network.applyDeltaFile(path);
+                cout << applied << " change(s) applied, " << skipped << " invalid line(s) skipped." << endl;
+                break;
+            }
+            case '5': {
+                MemoryAccounting::printReport(cout);
+                break;
+            }
             case 'q': {
                 cout << "Thank you for using our Railway Network Management System!";
                 break;
@@ -368,139 +400,6 @@ void Menu::mainMenu() {
     }
 }
 
-/**
- * Extracts and stores the information of stations.csv
- * Time Complexity: 0(n) (average case) | O(n²) (worst case), where n is the number of lines of stations.csv
- */
-void Menu::extractStationsFile() {
-    {
-        ifstream stations(stationsFilePath);
-
-        string currentParam, currentLine;
-        string name, district, municipality, township, line;
-
-        int counter = 0;
-
-        getline(stations, currentParam); //Ignore first line with just descriptors
-
-        while (getline(stations, currentLine)) {
-            currentLine.erase(currentLine.end() - 1); //Remove \r
-            istringstream iss(currentLine);
-            while (getline(iss, currentParam, ',')) {
-                if (currentParam.find('"') != string::npos) { //If the line contains "
-                    string leftover;
-                    currentParam.erase(currentParam.begin()); //Erase first "
-                    if (currentParam.find('"') != string::npos) { //Closing " already in string
-                        currentParam.erase(currentParam.end() - 1); //Remove last "
-                    } else {
-                        getline(iss, leftover, '"'); //Get leftover string until closing "
-                        currentParam.append(leftover);
-                        getline(iss, leftover, ','); //Remove trailing ,
-                    }
-                }
-                switch (counter++) {
-                    case 0: {
-                        name = currentParam;
-                        break;
-                    }
-                    case 1: {
-                        district = currentParam;
-                        break;
-                    }
-                    case 2: {
-                        municipality = currentParam;
-                        break;
-                    }
-                    case 3: {
-                        township = currentParam;
-                        break;
-                    }
-                    case 4: {
-                        line = currentParam;
-                        counter = 0;
-                        break;
-                    }
-                }
-                if (counter == 0) {
-                    if (!graph.addVertex(name)) break;
-                    if (!residualGraph.addVertex(name)) break;
-                    Station newStation = dataRepository.addStationEntry(name, district, municipality, township, line);
-                    dataRepository.addStationToMunicipalityEntry(municipality, newStation);
-                    dataRepository.addStationToDistrictEntry(district, newStation);
-                    dataRepository.addStationToTownshipEntry(township, newStation);
-                }
-            }
-        }
-    }
-}
-
-
-/**
- * Extracts and stores the information of flights.csv
- * Time Complexity: 0(n*v), where n is the number of lines of network.csv and v is the number of nodes in graph
- */
-void Menu::extractNetworkFile() {
-
-    ifstream network(networkFilePath);
-
-    string currentParam, currentLine;
-    string sourceName, targetName;
-    Service service;
-    unsigned int capacity;
-
-    int counter = 0;
-
-    getline(network, currentParam); //Ignore first line with just descriptors
-
-    while (getline(network, currentLine)) {
-        currentLine.erase(currentLine.end() - 1); //Remove \r
-        istringstream iss(currentLine);
-        while (getline(iss, currentParam, ',')) {
-            if (currentParam.find('"') != string::npos) { //If the line contains "
-                string leftover;
-                currentParam.erase(currentParam.begin()); //Erase first "
-                if (currentParam.find('"') != string::npos) { //Closing " already in string
-                    currentParam.erase(currentParam.end() - 1); //Remove last "
-                } else {
-                    getline(iss, leftover, '"'); //Get leftover string until closing "
-                    currentParam.append(leftover);
-                    getline(iss, leftover, ','); //Remove trailing ,
-                }
-            }
-            switch (counter++) {
-                case 0: {
-                    sourceName = currentParam;
-                    break;
-                }
-                case 1: {
-                    targetName = currentParam;
-                    break;
-                }
-                case 2: {
-                    capacity = stoul(currentParam);
-                    break;
-                }
-                case 3: {
-                    service = currentParam == "STANDARD" ? Service::STANDARD : Service::ALFA_PENDULAR;
-                    counter = 0;
-                    break;
-                }
-            }
-            if (counter == 0) {
-                auto [regular, regularReverse] = graph.addAndGetBidirectionalEdge(sourceName, targetName, capacity,
-                                                                                  service);
-                auto [residual, residualReverse] = residualGraph.addAndGetBidirectionalEdge(sourceName, targetName,
-                                                                                            capacity, service);
-                regular->setCorrespondingEdge(residual);
-                regularReverse->setCorrespondingEdge(residualReverse);
-                residual->setCorrespondingEdge(regular);
-                residualReverse->setCorrespondingEdge(regularReverse);
-            }
-        }
-    }
-}
-
-
 /**
  * Outputs basic service metrics menu screen and decides graph function calls according to user input
  * @return - Last inputted command, or '\0' for previous menu command
@@ -518,7 +417,9 @@ unsigned int Menu::serviceMetricsMenu() {
                  << endl;
             cout << setw(COLUMN_WIDTH) << setfill(' ') << "Top districts: [4]" << setw(COLUMN_WIDTH)
                  << "Top townships: [5]" << setw(COLUMN_WIDTH) << "Top municipalities: [6]" << endl;
-            cout << setw(COLUMN_WIDTH) << "Back: [b]" << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
+            cout << setw(COLUMN_WIDTH) << "Top lines: [7]" << setw(COLUMN_WIDTH) << "Best single route: [8]"
+                 << setw(COLUMN_WIDTH) << "Back: [b]" << endl;
+            cout << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
         }
 
         while (commandIn != 'q') {
@@ -529,6 +430,7 @@ unsigned int Menu::serviceMetricsMenu() {
                 commandIn = '\0';
                 continue;
             }
+            QueryStats::current().reset();
             switch (commandIn) {
                 case '1': {
                     string departureName;
@@ -550,7 +452,7 @@ unsigned int Menu::serviceMetricsMenu() {
                         stationDoesntExist();
                         break;
                     }
-                    cout << graph.edmondsKarp({departureName}, arrivalName, residualGraph)
+                    cout << bridgeDecomposition.maxFlow(departureName, arrivalName)
                          << " trains can simultaneously travel between "
                          << departureName
                          << " and " << arrivalName << "." << endl;
@@ -576,7 +478,7 @@ unsigned int Menu::serviceMetricsMenu() {
                         break;
                     }
                     cout
-                            << graph.incomingFlux(arrivalName, residualGraph) << " trains can simultaneously arrive at "
+                            << bridgeDecomposition.incomingFlux(arrivalName) << " trains can simultaneously arrive at "
                             << arrivalName << "." << endl;
                     break;
                 }
@@ -585,18 +487,18 @@ unsigned int Menu::serviceMetricsMenu() {
                     cout << "Enter the number of districts you'd like to see: ";
                     cin >> numDistricts;
                     if (!checkInput()) break;
-                    if (numDistricts > dataRepository.getDistrictToStations().size()) {
-                        cout << "The network only has " << dataRepository.getDistrictToStations().size()
+                    if (numDistricts > dataRepository.getNumGroups(Grouping::DISTRICT)) {
+                        cout << "The network only has " << dataRepository.getNumGroups(Grouping::DISTRICT)
                              << " districts!" << endl;
                         break;
                     }
                     std::vector<std::pair<std::string, double>> result = graph.topGroupings(
-                            dataRepository.getDistrictToStations(), residualGraph);
+                            dataRepository, Grouping::DISTRICT, numDistricts, residualGraph);
 
                     cout << endl << setw(COLUMN_WIDTH) << setfill(' ')
                          << "List of districts by average number of incoming trains capacity" << endl;
 
-                    for (int i = 0; i < numDistricts; i++) {
+                    for (unsigned int i = 0; i < numDistricts; i++) {
                         stringstream value;
                         value << fixed << setprecision(2) << result[i].second;
 
@@ -612,18 +514,18 @@ unsigned int Menu::serviceMetricsMenu() {
                     cout << "Enter the number of townships you'd like to see: ";
                     cin >> numTownships;
                     if (!checkInput()) break;
-                    if (numTownships > dataRepository.getTownshipToStations().size()) {
-                        cout << "The network only has " << dataRepository.getTownshipToStations().size()
+                    if (numTownships > dataRepository.getNumGroups(Grouping::TOWNSHIP)) {
+                        cout << "The network only has " << dataRepository.getNumGroups(Grouping::TOWNSHIP)
                              << " townships!" << endl;
                         break;
                     }
                     std::vector<std::pair<std::string, double>> result = graph.topGroupings(
-                            dataRepository.getTownshipToStations(), residualGraph);
+                            dataRepository, Grouping::TOWNSHIP, numTownships, residualGraph);
 
                     cout << endl << setw(COLUMN_WIDTH) << setfill(' ')
                          << "List of townships by average number of incoming trains capacity" << endl;
 
-                    for (int i = 0; i < numTownships; i++) {
+                    for (unsigned int i = 0; i < numTownships; i++) {
                         stringstream value;
                         value << fixed << setprecision(2) << result[i].second;
 
@@ -639,18 +541,18 @@ unsigned int Menu::serviceMetricsMenu() {
                     cout << "Enter the number of municipalities you'd like to see: ";
                     cin >> numMunicipalities;
                     if (!checkInput()) break;
-                    if (numMunicipalities > dataRepository.getMunicipalityToStations().size()) {
-                        cout << "The network only has " << dataRepository.getMunicipalityToStations().size()
+                    if (numMunicipalities > dataRepository.getNumGroups(Grouping::MUNICIPALITY)) {
+                        cout << "The network only has " << dataRepository.getNumGroups(Grouping::MUNICIPALITY)
                              << " municipalities!" << endl;
                         break;
                     }
                     std::vector<std::pair<std::string, double>> result = graph.topGroupings(
-                            dataRepository.getMunicipalityToStations(), residualGraph);
+                            dataRepository, Grouping::MUNICIPALITY, numMunicipalities, residualGraph);
 
                     cout << endl << setw(COLUMN_WIDTH) << setfill(' ')
                          << "List of municipalities by average number of incoming trains capacity" << endl;
 
-                    for (int i = 0; i < numMunicipalities; i++) {
+                    for (unsigned int i = 0; i < numMunicipalities; i++) {
                         stringstream value;
                         value << fixed << setprecision(2) << result[i].second;
 
@@ -661,6 +563,64 @@ unsigned int Menu::serviceMetricsMenu() {
 
                     break;
                 }
+                case '7': {
+                    unsigned int numLines;
+                    cout << "Enter the number of lines you'd like to see: ";
+                    cin >> numLines;
+                    if (!checkInput()) break;
+                    if (numLines > dataRepository.getNumGroups(Grouping::LINE)) {
+                        cout << "The network only has " << dataRepository.getNumGroups(Grouping::LINE)
+                             << " lines!" << endl;
+                        break;
+                    }
+                    std::vector<std::pair<std::string, double>> result = graph.topGroupings(
+                            dataRepository, Grouping::LINE, numLines, residualGraph);
+
+                    cout << endl << setw(COLUMN_WIDTH) << setfill(' ')
+                         << "List of lines by average number of incoming trains capacity" << endl;
+
+                    for (unsigned int i = 0; i < numLines; i++) {
+                        stringstream value;
+                        value << fixed << setprecision(2) << result[i].second;
+
+                        if (result[i].first.empty()) result[i].first = "NO LINE";
+                        cout << setw(4) << to_string(i + 1) << setw(COLUMN_WIDTH / 2) << left
+                             << " | " + value.str() + " trains" << result[i].first << endl;
+                    }
+
+                    break;
+                }
+                case '8': {
+                    string departureName;
+                    cout << "Enter the name of the departure station: ";
+                    getline(cin, departureName);
+                    if (!checkInput()) break;
+                    unsigned int departure = flowNetwork.findStation(departureName);
+                    if (departure == FlowNetwork::NOT_FOUND) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    string arrivalName;
+                    cout << "Enter the name of the arrival station: ";
+                    getline(cin, arrivalName);
+                    if (!checkInput()) break;
+                    unsigned int arrival = flowNetwork.findStation(arrivalName);
+                    if (arrival == FlowNetwork::NOT_FOUND) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    unsigned int capacity = widestPathTree.widestCapacity(departure, arrival);
+                    if (capacity == 0) {
+                        cout << "No single route connects " << departureName << " and " << arrivalName << "." << endl;
+                        break;
+                    }
+                    cout << "The best single route between " << departureName << " and " << arrivalName
+                         << " can take " << capacity << " trains:" << endl;
+                    printRoute(departure, widestPathTree.widestPath(departure, arrival));
+                    break;
+                }
                 case 'b': {
                     return '\0';
                 }
@@ -672,6 +632,7 @@ unsigned int Menu::serviceMetricsMenu() {
                     cout << "Please press one of listed keys." << endl;
                     break;
             }
+            printQueryStats();
         }
     }
     return commandIn;
@@ -690,7 +651,8 @@ unsigned int Menu::costOptMenu() {
             //Header
             cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << setfill('-') << right << "OPERATION COST";
             cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << left << " OPTIMIZATION" << endl;
-            cout << setw(COLUMN_WIDTH) << setfill(' ') << "Two specific stations: [1]" << setw(COLUMN_WIDTH) << endl;
+            cout << setw(COLUMN_WIDTH) << setfill(' ') << "Two specific stations: [1]" << setw(COLUMN_WIDTH)
+                 << "Cheapest route: [2]" << setw(COLUMN_WIDTH) << "Route with fewest rails: [3]" << endl;
             cout << setw(COLUMN_WIDTH) << "Back: [b]" << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
         }
 
@@ -702,6 +664,7 @@ unsigned int Menu::costOptMenu() {
                 commandIn = '\0';
                 continue;
             }
+            QueryStats::current().reset();
             switch (commandIn) {
                 case '1': {
                     string departureName;
@@ -723,14 +686,53 @@ unsigned int Menu::costOptMenu() {
                         stationDoesntExist();
                         break;
                     }
-                    pair<unsigned int, unsigned int> result = graph.minCostMaxFlow(departureName, arrivalName,
-                                                                                   residualGraph);
+                    pair<unsigned int, unsigned int> result = contractedGraph.minCostMaxFlow(departureName,
+                                                                                             arrivalName);
 
                     cout << "Maintaining the network active at its maximum, " << result.first
                          << " trains can travel simultaneously between " << departureName << " and " << arrivalName
                          << ", at a minimum cost of " << result.second << "€." << endl;
                     break;
                 }
+                case '2':
+                case '3': {
+                    string departureName;
+                    cout << "Enter the name of the departure station: ";
+                    getline(cin, departureName);
+                    if (!checkInput()) break;
+                    unsigned int departure = flowNetwork.findStation(departureName);
+                    if (departure == FlowNetwork::NOT_FOUND) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    string arrivalName;
+                    cout << "Enter the name of the arrival station: ";
+                    getline(cin, arrivalName);
+                    if (!checkInput()) break;
+                    unsigned int arrival = flowNetwork.findStation(arrivalName);
+                    if (arrival == FlowNetwork::NOT_FOUND) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    RouteMetric metric = commandIn == '2' ? RouteMetric::COST : RouteMetric::HOPS;
+                    pair<unsigned int, vector<unsigned int>> route = network.getContractionHierarchy(
+                            metric).shortestPath(departure, arrival);
+                    if (route.first == FlowNetwork::NOT_FOUND) {
+                        cout << "No route connects " << departureName << " and " << arrivalName << "." << endl;
+                        break;
+                    }
+                    if (metric == RouteMetric::COST) {
+                        cout << "The cheapest route between " << departureName << " and " << arrivalName << " costs "
+                             << route.first << "€ per train:" << endl;
+                    } else {
+                        cout << "The route between " << departureName << " and " << arrivalName << " with the fewest "
+                             << "rails has " << route.first << " rails:" << endl;
+                    }
+                    printRoute(departure, route.second);
+                    break;
+                }
                 case 'b': {
                     return '\0';
                 }
@@ -742,6 +744,7 @@ unsigned int Menu::costOptMenu() {
                     cout << "Please press one of listed keys." << endl;
                     break;
             }
+            printQueryStats();
         }
     }
     return commandIn;
@@ -760,7 +763,12 @@ unsigned int Menu::failuresMenu() {
             cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << setfill('-') << right << "LINE FA";
             cout << setw(COLUMN_WIDTH * COLUMNS_PER_LINE / 2) << left << "ILURES" << endl;
             cout << setw(COLUMN_WIDTH) << setfill(' ') << "Two specific stations: [1]" << setw(COLUMN_WIDTH)
-                 << "Top affected stations: [2]" << endl;
+                 << "Top affected stations: [2]" << setw(COLUMN_WIDTH) << "Weakest point of the network: [3]" << endl;
+            cout << setw(COLUMN_WIDTH) << "Critical rails between two stations: [4]" << setw(COLUMN_WIDTH)
+                 << "Critical rails for a specific station: [5]" << setw(COLUMN_WIDTH)
+                 << "Worst combined rail failures: [6]" << endl;
+            cout << setw(COLUMN_WIDTH) << "Closed stations between two stations: [7]" << setw(COLUMN_WIDTH)
+                 << "Top station closures: [8]" << endl;
             cout << setw(COLUMN_WIDTH) << "Back: [b]" << setw(COLUMN_WIDTH) << "Quit: [q]" << endl;
         }
 
@@ -773,6 +781,7 @@ unsigned int Menu::failuresMenu() {
                 commandIn = '\0';
                 continue;
             }
+            QueryStats::current().reset();
             switch (commandIn) {
                 case '1': {
                     string departureName;
@@ -798,9 +807,12 @@ unsigned int Menu::failuresMenu() {
                     vector<Edge *> deactivatedEdges = edgeFailureMenu();
                     if (deactivatedEdges.empty()) break;
 
-                    pair<unsigned int, unsigned int> result =
-                            graph.maxFlowDeactivatedEdges(deactivatedEdges, {departureName}, arrivalName,
-                                                          residualGraph);
+                    pair<unsigned int, unsigned int> result;
+                    if (bridgeDecomposition.disconnects(deactivatedEdges, departureName, arrivalName))
+                        result = {contractedGraph.edmondsKarp({departureName}, arrivalName), 0};
+                    else
+                        result = contractedGraph.maxFlowDeactivatedEdges(deactivatedEdges, {departureName},
+                                                                         arrivalName);
                     double reductionValue = result.first == 0 ? 0 : 100 - ((result.second * 1.0) / result.first) * 100;
                     cout << "The maximum number of trains travelling between "
                          << departureName
@@ -834,7 +846,7 @@ unsigned int Menu::failuresMenu() {
                          << "REDUCED";
                     cout << "STATION" << endl;
 
-                    for (int i = 0; i < numStations; i++) {
+                    for (unsigned int i = 0; i < numStations; i++) {
                         stringstream original;
                         original << fixed << setprecision(2) << result[i].second.first;
                         stringstream reduced;
@@ -854,6 +866,161 @@ unsigned int Menu::failuresMenu() {
                     }
                     break;
                 }
+                case '3': {
+                    MinCut cut = graph.globalMinCut();
+                    list<string> &smallerSide = cut.sideA.size() <= cut.sideB.size() ? cut.sideA : cut.sideB;
+                    list<string> &largerSide = cut.sideA.size() <= cut.sideB.size() ? cut.sideB : cut.sideA;
+
+                    cout << "Losing " << cut.rails.size() << " rail(s), with a total capacity of " << cut.capacity
+                         << " trains, splits the network in two:" << endl;
+                    for (Edge const *e: cut.rails) e->print();
+                    cout << endl << "Stations cut off from the other " << largerSide.size() << " stations:" << endl;
+                    for (const string &station: smallerSide) cout << station << endl;
+                    break;
+                }
+                case '4': {
+                    string departureName;
+                    cout << "Enter the name of the departure station: ";
+                    getline(cin, departureName);
+                    if (!checkInput()) break;
+                    if (!dataRepository.findStation(departureName).has_value()) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    string arrivalName;
+                    cout << "Enter the name of the arrival station: ";
+                    getline(cin, arrivalName);
+                    if (!checkInput()) break;
+                    if (!dataRepository.findStation(arrivalName).has_value()) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    printCriticalRails(flowNetwork.criticalRails({flowNetwork.findStation(departureName)},
+                                                                 flowNetwork.findStation(arrivalName)));
+                    break;
+                }
+                case '5': {
+                    string arrivalName;
+                    cout << "Enter the name of the arrival station: ";
+                    getline(cin, arrivalName);
+                    if (!checkInput()) break;
+                    if (!dataRepository.findStation(arrivalName).has_value()) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    unsigned int station = flowNetwork.findStation(arrivalName);
+                    printCriticalRails(flowNetwork.criticalRails(flowNetwork.superSource(station), station));
+                    break;
+                }
+                case '6': {
+                    string arrivalName;
+                    cout << "Enter the name of the arrival station: ";
+                    getline(cin, arrivalName);
+                    if (!checkInput()) break;
+                    if (!dataRepository.findStation(arrivalName).has_value()) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    unsigned int numFailures;
+                    cout << "Enter how many rails fail at the same time (1 to 3): ";
+                    cin >> numFailures;
+                    if (!checkInput()) break;
+                    if (numFailures < 1 || numFailures > 3) {
+                        cout << "Please enter a number between 1 and 3." << endl;
+                        break;
+                    }
+
+                    unsigned int numCombinations;
+                    cout << "Enter the number of combinations you'd like to see: ";
+                    cin >> numCombinations;
+                    if (!checkInput()) break;
+
+                    unsigned int station = flowNetwork.findStation(arrivalName);
+                    vector<unsigned int> superSource = flowNetwork.superSource(station);
+                    unsigned int regular = flowNetwork.maxFlow(superSource, station);
+                    vector<pair<vector<Edge *>, unsigned int>> result = flowNetwork.worstFailures(
+                            superSource, station, numFailures, numCombinations);
+
+                    if (result.empty()) {
+                        cout << "No rail failure can reduce the " << regular << " trains arriving at " << arrivalName
+                             << "." << endl;
+                        break;
+                    }
+                    cout << setw(COLUMN_WIDTH) << setfill(' ')
+                         << "List of rail failures by reduction of the number of trains arriving at " + arrivalName
+                         << endl << endl;
+                    for (size_t i = 0; i < result.size(); i++) {
+                        double reductionValue = 100 - ((result[i].second * 1.0) / regular) * 100;
+                        cout << setw(4) << to_string(i + 1) << " | " << fixed << setprecision(2) << reductionValue
+                             << " % (" << regular << " to " << result[i].second << " trains)" << endl;
+                        for (Edge const *e: result[i].first) {
+                            cout << setw(7) << "";
+                            e->print();
+                        }
+                    }
+                    break;
+                }
+                case '7': {
+                    string departureName;
+                    cout << "Enter the name of the departure station: ";
+                    getline(cin, departureName);
+                    if (!checkInput()) break;
+                    if (!dataRepository.findStation(departureName).has_value()) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    string arrivalName;
+                    cout << "Enter the name of the arrival station: ";
+                    getline(cin, arrivalName);
+                    if (!checkInput()) break;
+                    if (!dataRepository.findStation(arrivalName).has_value()) {
+                        stationDoesntExist();
+                        break;
+                    }
+
+                    vector<string> closedStations = stationClosureMenu();
+                    if (closedStations.empty()) break;
+
+                    pair<unsigned int, unsigned int> result =
+                            graph.maxFlowDeactivatedVertices(closedStations, {departureName}, arrivalName,
+                                                             residualGraph);
+                    double reductionValue = result.first == 0 ? 0 : 100 - ((result.second * 1.0) / result.first) * 100;
+                    cout << "The maximum number of trains travelling between "
+                         << departureName
+                         << " and " << arrivalName << " was altered from " << result.first << " to " << result.second
+                         << ", in a " << fixed << setprecision(2) << reductionValue << "% reduction." << endl;
+                    break;
+                }
+                case '8': {
+                    unsigned int numStations;
+                    cout << "Enter the number of stations you'd like to see: ";
+                    cin >> numStations;
+                    if (!checkInput()) break;
+                    if (numStations > flowNetwork.getNumStations()) {
+                        cout << "The network only has " << flowNetwork.getNumStations() << " stations!" << endl;
+                        break;
+                    }
+
+                    vector<pair<string, pair<unsigned long long, unsigned int>>> result =
+                            flowNetwork.topStationClosures();
+
+                    cout << setw(COLUMN_WIDTH) << setfill(' ')
+                         << "List of stations by pairs of stations disconnected when closed" << endl << endl;
+                    cout << setw(4) << "NUM" << setw(COLUMN_WIDTH / 2 + 10) << left << " | DISCONNECTED PAIRS";
+                    cout << setw(COLUMN_WIDTH / 2) << "RAIL CAPACITY" << "STATION" << endl;
+
+                    for (unsigned int i = 0; i < numStations; i++) {
+                        cout << setw(4) << to_string(i + 1) << setw(COLUMN_WIDTH / 2 + 10) << left
+                             << " | " + to_string(result[i].second.first);
+                        cout << setw(COLUMN_WIDTH / 2) << result[i].second.second << result[i].first << endl;
+                    }
+                    break;
+                }
                 case 'b': {
                     return '\0';
                 }
@@ -865,12 +1032,61 @@ unsigned int Menu::failuresMenu() {
                     cout << "Please press one of listed keys." << endl;
                     break;
             }
+            printQueryStats();
         }
     }
     return commandIn;
 }
 
 
+/**
+ * Outputs a route as the stations it goes through
+ * @param source - Index of the station the route starts at
+ * @param rails - Rails of the route, in order from the source
+ */
+void Menu::printRoute(unsigned int source, const vector<unsigned int> &rails) const {
+    cout << flowNetwork.getStationName(source);
+    for (unsigned int station = source; unsigned int rail: rails) {
+        unsigned int tail = flowNetwork.arcTail(2 * rail);
+        station = tail == station ? flowNetwork.arcHead(2 * rail) : tail;
+        cout << " -> " << flowNetwork.getStationName(station);
+    }
+    cout << endl;
+}
+
+/**
+ * Asks the user how many rails to show and outputs a ranking of rails by the reduction their failure causes
+ * @param rails - Vector of rails and the max flow before and after their failure, by decreasing reduction
+ */
+void Menu::printCriticalRails(const vector<pair<Edge *, pair<unsigned int, unsigned int>>> &rails) {
+    unsigned int numRails;
+    cout << "Enter the number of rails you'd like to see: ";
+    cin >> numRails;
+    if (!checkInput()) return;
+    if (numRails > rails.size()) {
+        cout << "The network only has " << rails.size() << " rails!" << endl;
+        return;
+    }
+
+    cout << setw(COLUMN_WIDTH) << setfill(' ') << "List of rails by reduction of the number of trains when failing"
+         << endl << endl;
+    cout << setw(4) << "NUM" << setw(COLUMN_WIDTH / 2 + 10) << left << " | REDUCTION";
+    cout << setw(COLUMN_WIDTH / 2) << "REGULAR" << setw(COLUMN_WIDTH / 2) << left << "REDUCED";
+    cout << "RAIL" << endl;
+
+    for (unsigned int i = 0; i < numRails; i++) {
+        auto [edge, flows] = rails[i];
+        double reductionValue = flows.first == 0 ? 0 : 100 - ((flows.second * 1.0) / flows.first) * 100;
+        stringstream reduction;
+        reduction << fixed << setprecision(2) << reductionValue;
+
+        cout << setw(4) << to_string(i + 1) << setw(10) << " | " + reduction.str() << setw(COLUMN_WIDTH / 2) << left
+             << " %";
+        cout << setw(COLUMN_WIDTH / 2) << flows.first << setw(COLUMN_WIDTH / 2) << left << flows.second;
+        edge->print();
+    }
+}
+
 /**
  * Outputs edge failure selection menu screen and returns a vector containing all the select edges for the given inputs
  * @return - vector<Edge*> containing all the Edges to be deactivated
@@ -967,3 +1183,31 @@ vector<Edge *> Menu::edgeFailureMenu() {
         }
     }
 }
+
+/**
+ * Outputs station closure selection screen and returns the names of all the stations given as input
+ * @return - vector<string> containing the names of all the stations to be closed
+ */
+vector<string> Menu::stationClosureMenu() {
+    vector<string> closedStations;
+
+    while (true) {
+        string stationName;
+        cout << "Enter the name of a station to close, or q to finish: ";
+        getline(cin, stationName);
+        if (!checkInput()) break;
+
+        if (stationName == "q") break;
+
+        if (!dataRepository.findStation(stationName).has_value()) {
+            stationDoesntExist();
+            continue;
+        }
+        closedStations.push_back(stationName);
+    }
+    if (!closedStations.empty()) {
+        cout << "Closing the following stations: " << endl;
+        for (const string &station: closedStations) cout << station << endl;
+    } else cout << "Please provide stations to close!" << endl;
+    return closedStations;
+}
@@ -14,27 +14,32 @@
 #include <sstream>
 #include <cmath>
 #include <unordered_set>
-#include "graph.h"
-#include "dataRepository.h"
+#include "railwayNetwork.h"
 
 class Menu {
 private:
-    DataRepository dataRepository;
-    Graph residualGraph;
-    Graph graph;
-    std::string static const stationsFilePath;
-    std::string static const networkFilePath;
+    RailwayNetwork &network;
+    DataRepository &dataRepository;
+    Graph &residualGraph;
+    Graph &graph;
+    ContractedGraph &contractedGraph;
+    BridgeDecomposition &bridgeDecomposition;
+    const FlowNetwork &flowNetwork;
+    const WidestPathTree &widestPathTree;
+    bool showStats = false;
     unsigned static const COLUMN_WIDTH;
     unsigned static const COLUMNS_PER_LINE;
 
-public:
-    Menu();
+    void printQueryStats() const;
+
+    void printRoute(unsigned int source, const std::vector<unsigned int> &rails) const;
 
-    void extractStationsFile();
+    void printCriticalRails(const std::vector<std::pair<Edge *, std::pair<unsigned int, unsigned int>>> &rails);
 
-    void extractNetworkFile();
+public:
+    explicit Menu(RailwayNetwork &network);
 
-    void extractFileInfo();
+    void setShowStats(bool show);
 
     void initializeMenu();
 
@@ -48,6 +53,8 @@ public:
 
     std::vector<Edge *> edgeFailureMenu();
 
+    std::vector<std::string> stationClosureMenu();
+
     static bool checkInput(unsigned int checkLength = 0);
 
     static void stationDoesntExist();
@@ -0,0 +1,175 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "metricsExporter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+#ifndef _WIN32
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif
+
+/**
+ * Stops exporting, writing the file one last time
+ */
+MetricsExporter::~MetricsExporter() {
+    stop();
+#ifndef _WIN32
+    if (listener >= 0) close(listener);
+#endif
+}
+
+/**
+ * Chooses the file where the metrics are written
+ * @param path - Path of the file, empty for none
+ * @param period - Time between two writes
+ */
+void MetricsExporter::setFile(const std::string &path, std::chrono::milliseconds period) {
+    filePath = path;
+    interval = period;
+}
+
+/**
+ * Starts listening for scrapes on a TCP port of the loopback interface
+ * @param port - Port number, 0 meaning any free port
+ * @return True if the exporter is listening, false otherwise
+ */
+bool MetricsExporter::listenHttp(unsigned short port) {
+#ifndef _WIN32
+    if (listener >= 0) return false;
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, (sockaddr *) &address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Starts the background thread, if there is a file or a port to export to
+ */
+void MetricsExporter::start() {
+    if (worker.joinable() || (filePath.empty() && listener < 0)) return;
+    stopping = false;
+    worker = std::thread(&MetricsExporter::exportPeriodically, this);
+}
+
+/**
+ * Stops the background thread and writes the file one last time
+ */
+void MetricsExporter::stop() {
+    if (!worker.joinable()) return;
+    stopping = true;
+    worker.join();
+    if (!filePath.empty()) writeFile();
+}
+
+/**
+ * Writes the metrics to the file, through a temporary file renamed over it
+ * @return True if the file was replaced, false otherwise
+ */
+bool MetricsExporter::writeFile() const {
+    std::string temporaryPath = filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        if (!file) return false;
+        OperationMetrics::writePrometheus(file);
+        MemoryAccounting::writePrometheus(file);
+        if (!file.flush()) return false;
+    }
+    return std::rename(temporaryPath.c_str(), filePath.c_str()) == 0;
+}
+
+/**
+ * Body of the background thread: answers scrapes as they arrive and rewrites the file every interval, until stopped
+ */
+void MetricsExporter::exportPeriodically() {
+    auto nextWrite = std::chrono::steady_clock::now();
+    while (!stopping) {
+        if (!filePath.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+            writeFile();
+            nextWrite = std::chrono::steady_clock::now() + interval;
+        }
+#ifndef _WIN32
+        if (listener < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            continue;
+        }
+        pollfd waiting{listener, POLLIN, 0};
+        if (poll(&waiting, 1, 200) <= 0 || !(waiting.revents & POLLIN)) continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        answerScrape(client);
+        close(client);
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+#endif
+    }
+}
+
+/**
+ * Answers an HTTP request: the metrics for GET /metrics, 404 for any other path and 405 for any other method. Clients
+ * that don't send their request headers within a second are dropped, so a stalled client can't block the exporter
+ * @param client - Socket of the client
+ */
+void MetricsExporter::answerScrape(int client) const {
+#ifndef _WIN32
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos &&
+           request.size() < 16384) {
+        pollfd waiting{client, POLLIN, 0};
+        if (poll(&waiting, 1, 1000) <= 0) return;
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) return;
+        request.append(buffer, (size_t) received);
+    }
+
+    std::string status = "200 OK";
+    std::ostringstream body;
+    std::string path = request.substr(0, request.find_first_of("\r\n"));
+    if (path.rfind("GET ", 0) != 0) {
+        status = "405 Method Not Allowed";
+    } else {
+        path = path.substr(4, path.find(' ', 4) - 4);
+        if (path == "/metrics" || path.rfind("/metrics?", 0) == 0) {
+            OperationMetrics::writePrometheus(body);
+            MemoryAccounting::writePrometheus(body);
+        } else {
+            status = "404 Not Found";
+        }
+    }
+    std::string content = body.str();
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                           "Content-Length: " + std::to_string(content.size()) + "\r\nConnection: close\r\n\r\n" +
+                           content;
+    std::string_view remaining = response;
+    while (!remaining.empty()) {
+        ssize_t sent = send(client, remaining.data(), remaining.size(), MSG_NOSIGNAL);
+        if (sent <= 0) return;
+        remaining.remove_prefix((size_t) sent);
+    }
+#endif
+}
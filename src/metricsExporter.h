@@ -0,0 +1,55 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_METRICSEXPORTER_H
+#define RAILWAYMANAGEMENT_METRICSEXPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "operationMetrics.h"
+#include "memoryAccounting.h"
+
+/**
+ * Publishes the OperationMetrics and the MemoryAccounting in the Prometheus text format from a background thread, by rewriting a file
+ * periodically (for instance for node_exporter's textfile collector) and/or by answering GET /metrics on a TCP port of
+ * the loopback interface. The file is replaced atomically, so readers never see it half written, and is written one
+ * last time when the exporter stops
+ */
+class MetricsExporter {
+  private:
+    std::string filePath;
+    std::chrono::milliseconds interval{10000};
+    int listener = -1;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+
+    void exportPeriodically();
+
+    void answerScrape(int client) const;
+
+  public:
+    MetricsExporter() = default;
+
+    MetricsExporter(const MetricsExporter &) = delete;
+
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+    ~MetricsExporter();
+
+    void setFile(const std::string &path, std::chrono::milliseconds period);
+
+    bool listenHttp(unsigned short port);
+
+    void start();
+
+    void stop();
+
+    bool writeFile() const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_METRICSEXPORTER_H
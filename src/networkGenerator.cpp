@@ -0,0 +1,105 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "networkGenerator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <vector>
+
+NetworkGenerator::NetworkGenerator(const GeneratorOptions &options) : options(options) {}
+
+/**
+ * Name of a generated station
+ * @param station - Index of the station, in the order it was generated
+ * @return Name of the station
+ */
+std::string NetworkGenerator::stationName(unsigned int station) {
+    return "Station " + std::to_string(station);
+}
+
+/**
+ * Generates a network and writes it to a pair of CSV files. The same options always generate the same network
+ * Time Complexity: O(n), n being the number of stations
+ * @param stationsFilePath - Path of the stations file
+ * @param networkFilePath - Path of the network file
+ * @return True if both files were written, false otherwise
+ */
+bool NetworkGenerator::write(const std::string &stationsFilePath, const std::string &networkFilePath) const {
+    std::ofstream stations(stationsFilePath);
+    std::ofstream network(networkFilePath);
+    if (!stations || !network) return false;
+    stations << "Name,District,Municipality,Township,Line\n";
+    network << "Station_A,Station_B,Capacity,Service\n";
+
+    std::mt19937 random(options.seed);
+    auto uniform = [&random](unsigned int n) { //Uniform in [0, n)
+        return std::uniform_int_distribution<unsigned int>(0, n - 1)(random);
+    };
+    auto chance = [&random](double probability) {
+        return std::uniform_real_distribution<double>(0, 1)(random) < probability;
+    };
+
+    const unsigned int meanLength = std::max(1u, options.meanLineLength);
+    const unsigned int perTownship = std::max(1u, options.stationsPerTownship);
+    const unsigned int perMunicipality = std::max(1u, options.townshipsPerMunicipality);
+    const unsigned int perDistrict = std::max(1u, options.municipalitiesPerDistrict);
+    std::vector<unsigned int> junctions; //A station appears once per line through it, so hubs are picked more often
+    unsigned int next = 0;
+
+    auto addStation = [&](unsigned int line) {
+        unsigned int township = next / perTownship;
+        unsigned int municipality = township / perMunicipality;
+        stations << stationName(next) << ",DISTRICT " << municipality / perDistrict << ",MUNICIPALITY "
+                 << municipality << ",Township " << township << ",Line " << line << '\n';
+        return next++;
+    };
+    auto addRail = [&](unsigned int source, unsigned int target, unsigned int capacity, bool alfaPendular) {
+        network << stationName(source) << ',' << stationName(target) << ',' << capacity << ','
+                << (alfaPendular ? "ALFA PENDULAR" : "STANDARD") << '\n';
+    };
+
+    for (unsigned int line = 0; next < options.numStations; line++) {
+        bool trunk = line == 0;
+        bool spur = !trunk && chance(options.spurFraction);
+        unsigned int length = trunk ? 2 * meanLength : spur ? std::max(1u, meanLength / 4) :
+                                                       meanLength / 2 + uniform(meanLength + 1);
+        length = std::max(1u, std::min(length, options.numStations - next));
+        bool alfaPendular = !spur && (trunk || chance(options.alfaPendularFraction));
+        unsigned int capacity = trunk ? 10 : spur ? 2 : 2 * (1 + uniform(4));
+        unsigned int firstStation = next;
+
+        unsigned int previous = 0;
+        if (!trunk) { //Every other line branches off the network already generated
+            previous = !junctions.empty() && chance(options.hubAffinity) ? junctions[uniform(junctions.size())]
+                                                                         : uniform(next);
+            junctions.push_back(previous);
+        }
+        for (unsigned int i = 0; i < length; i++) {
+            unsigned int station = addStation(line);
+            if (!trunk || i > 0) {
+                //Some sections of a line are single track, with a lower capacity
+                unsigned int railCapacity = capacity > 2 && chance(0.1) ? capacity - 2 : capacity;
+                addRail(previous, station, railCapacity, alfaPendular);
+            }
+            previous = station;
+        }
+
+        if (!trunk && !spur && firstStation > 0 && chance(options.loopFraction)) {
+            unsigned int end = uniform(firstStation); //Join a station of an earlier line
+            addRail(previous, end, capacity, false);
+            junctions.push_back(end);
+            junctions.push_back(previous);
+        }
+        if (trunk) {
+            junctions.push_back(0);
+            junctions.push_back(previous);
+        }
+    }
+
+    stations.flush();
+    network.flush();
+    return stations.good() && network.good();
+}
@@ -0,0 +1,47 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_NETWORKGENERATOR_H
+#define RAILWAYMANAGEMENT_NETWORKGENERATOR_H
+
+#include <string>
+
+/**
+ * Shape of a generated railway network
+ */
+struct GeneratorOptions {
+    unsigned int numStations = 10000;
+    unsigned int seed = 1;
+    unsigned int meanLineLength = 30; // stations per main line, spurs are a quarter as long
+    double spurFraction = 0.35; // fraction of the lines that are short dead-end branches
+    double loopFraction = 0.3; // fraction of the main lines whose far end joins another junction
+    double hubAffinity = 0.7; // probability of a new line starting at an existing junction rather than anywhere
+    double alfaPendularFraction = 0.05; // fraction of the main lines with ALFA PENDULAR service
+    unsigned int stationsPerTownship = 6;
+    unsigned int townshipsPerMunicipality = 4;
+    unsigned int municipalitiesPerDistrict = 10;
+};
+
+/**
+ * Generator of synthetic railway networks shaped like the real one: a trunk line, long chains of degree-2 stations,
+ * junction hubs where many lines meet (a new line is more likely to start at a station that is already a junction),
+ * short dead-end spurs, loops between lines, mostly STANDARD service with a few ALFA PENDULAR main lines, and districts
+ * split into municipalities split into townships along the lines. The output has the format of the dataset's
+ * stations.csv and network.csv, and is streamed to the files, so networks of millions of stations only need memory
+ * for the junctions
+ */
+class NetworkGenerator {
+  private:
+    GeneratorOptions options;
+
+  public:
+    explicit NetworkGenerator(const GeneratorOptions &options);
+
+    bool write(const std::string &stationsFilePath, const std::string &networkFilePath) const;
+
+    static std::string stationName(unsigned int station);
+};
+
+
+#endif //RAILWAYMANAGEMENT_NETWORKGENERATOR_H
@@ -0,0 +1,401 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "networkSnapshot.h"
+#include "flowNetwork.h"
+#include "bridgeDecomposition.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+const uint32_t NetworkSnapshot::VERSION = 5;
+
+static const char MAGIC[4] = {'R', 'W', 'N', 'S'};
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * Memory-maps a snapshot file read-only and checks that it is well-formed
+ * Time Complexity: O(S+R), S being the number of stations and R the number of rails
+ * @param path - Path of the snapshot file
+ */
+NetworkSnapshot::NetworkSnapshot(const std::string &path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && (size_t) info.st_size >= sizeof(Header)) {
+        void *mapping = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char *>(mapping);
+            size = (size_t) info.st_size;
+        }
+    }
+    close(fd);
+    if (data != nullptr && !validate()) {
+        munmap(const_cast<char *>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+#endif
+}
+
+NetworkSnapshot::~NetworkSnapshot() {
+#ifndef _WIN32
+    if (data != nullptr) munmap(const_cast<char *>(data), size);
+#endif
+}
+
+/**
+ * Checks the header of the mapped file and that every section and index stays inside it, setting the section pointers
+ * Time Complexity: O(S+R), S being the number of stations and R the number of rails
+ * @return True if the snapshot can be used, false otherwise
+ */
+bool NetworkSnapshot::validate() {
+    header = reinterpret_cast<const Header *>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+        header->byteOrder != BYTE_ORDER_MARK || header->fileSize != size)
+        return false;
+
+    auto fits = [this](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % alignof(uint64_t) == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+
+    if (!fits(header->stringsOffset, (uint64_t) header->numStrings + 1, sizeof(uint32_t))) return false;
+    stringOffsets = reinterpret_cast<const uint32_t *>(data + header->stringsOffset);
+    uint64_t charactersOffset = header->stringsOffset + ((uint64_t) header->numStrings + 1) * sizeof(uint32_t);
+    if (stringOffsets[header->numStrings] > size - charactersOffset) return false;
+    characters = data + charactersOffset;
+    for (uint32_t i = 0; i < header->numStrings; i++)
+        if (stringOffsets[i] > stringOffsets[i + 1]) return false;
+
+    if (!fits(header->stationsOffset, header->numStations, sizeof(SnapshotStation))) return false;
+    stations = reinterpret_cast<const SnapshotStation *>(data + header->stationsOffset);
+    for (uint32_t i = 0; i < header->numStations; i++) {
+        const SnapshotStation &s = stations[i];
+        for (uint32_t id: {s.name, s.district, s.municipality, s.township, s.line})
+            if (id >= header->numStrings) return false;
+    }
+
+    if (!fits(header->railsOffset, header->numRails, sizeof(SnapshotRail))) return false;
+    rails = reinterpret_cast<const SnapshotRail *>(data + header->railsOffset);
+    for (uint32_t i = 0; i < header->numRails; i++) {
+        const SnapshotRail &r = rails[i];
+        if (r.source >= header->numStations || r.target >= header->numStations ||
+            r.service > (uint32_t) Service::VERY_EXPENSIVE)
+            return false;
+    }
+
+    for (unsigned int i = 0; i < NUM_INDEX_ARRAYS; i++) {
+        if (!fits(header->indexOffsets[i], header->indexSizes[i], sizeof(uint32_t))) return false;
+        indexArrays[i] = reinterpret_cast<const uint32_t *>(data + header->indexOffsets[i]);
+    }
+    return validateIndexArrays();
+}
+
+/**
+ * Checks that every index array has the size its structure requires and that every index it holds stays inside the
+ * array it refers to, so that the structures built from them never read out of bounds
+ * Time Complexity: O(S+R+G), S being the number of stations, R the number of rails and G the number of groups
+ * @return True if the index arrays can be used, false otherwise
+ */
+bool NetworkSnapshot::validateIndexArrays() const {
+    uint64_t numEdges = 2 * (uint64_t) header->numRails;
+    auto below = [this](unsigned int array, uint64_t bound) {
+        std::span<const uint32_t> values = getIndexArray(array);
+        return std::all_of(values.begin(), values.end(), [bound](uint32_t value) { return value < bound; });
+    };
+    //Offsets of a CSR, from 0 up to the size of the array they index
+    auto offsets = [this](unsigned int array, uint64_t count, uint64_t total) {
+        std::span<const uint32_t> values = getIndexArray(array);
+        if (values.size() != count + 1 || values.front() != 0 || values.back() != total) return false;
+        return std::is_sorted(values.begin(), values.end());
+    };
+
+    if (!offsets(FIRST_ARCS, header->numStations, numEdges) || header->indexSizes[ADJACENT_ARCS] != numEdges ||
+        !below(ADJACENT_ARCS, numEdges) || header->indexSizes[ARC_HEADS] != numEdges ||
+        !below(ARC_HEADS, header->numStations) || header->indexSizes[RAIL_EDGES] != header->numRails ||
+        !below(RAIL_EDGES, numEdges))
+        return false;
+
+    if (header->indexSizes[COMPONENT_OFFSETS] == 0 ||
+        !offsets(COMPONENT_OFFSETS, header->indexSizes[COMPONENT_OFFSETS] - 1, header->numStations) ||
+        header->indexSizes[COMPONENT_STATIONS] != header->numStations ||
+        !below(COMPONENT_STATIONS, header->numStations) || !below(BRIDGES, numEdges))
+        return false;
+
+    for (unsigned int g = 0; g < DataRepository::NUM_GROUPINGS; g++) {
+        if (!below(GROUP_NAMES + g, header->numStrings) ||
+            !offsets(GROUP_OFFSETS + g, header->indexSizes[GROUP_NAMES + g], header->indexSizes[GROUP_STATIONS + g]) ||
+            !below(GROUP_STATIONS + g, header->numStations))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Gets the size and the modification time of a file a snapshot is written from. It must be taken before the file is
+ * parsed, so that a change made while parsing it is not recorded as already stored in the snapshot
+ * Time Complexity: O(1)
+ * @param path - Path of the file
+ * @param source - Set to the size and the modification time of the file
+ * @return True if the file exists, false otherwise
+ */
+bool NetworkSnapshot::describeSource(const std::string &path, SnapshotSource &source) {
+    std::error_code error;
+    uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error) return false;
+    auto time = std::filesystem::last_write_time(path, error);
+    if (error) return false;
+    source = {(uint64_t) fileSize, (int64_t) time.time_since_epoch().count()};
+    return true;
+}
+
+/**
+ * Writes a snapshot of a network, of the attributes and groupings of its stations and of the structures derived from
+ * it. The rails are stored in an order that keeps the order of every station's adjacency list, so the Graph loaded back
+ * from the snapshot is traversed exactly like the original one, and each from its Edge with the lower address, the
+ * direction the FlowNetwork built from a Graph gives it
+ * Time Complexity: O(S+R+G) (average case), S being the number of stations, R the number of rails and G the number of
+ * groups
+ * @param path - Path of the snapshot file. It is written next to it first and only then renamed over it, so that a
+ * crash or a concurrent load never sees a partly written snapshot
+ * @param sources - Files the network was loaded from, as described before parsing them
+ * @param network - Network to store
+ * @param dataRepository - Attributes of the network's stations, with their groupings built
+ * @param flowNetwork - FlowNetwork built from the network
+ * @param bridgeDecomposition - BridgeDecomposition built from the network
+ * @return True if the file was written, false otherwise
+ */
+bool NetworkSnapshot::write(const std::string &path, const std::array<SnapshotSource, NUM_SOURCES> &sources,
+                            const Graph &network, const DataRepository &dataRepository, const FlowNetwork &flowNetwork,
+                            const BridgeDecomposition &bridgeDecomposition) {
+    std::vector<uint32_t> stringOffsets{0};
+    std::string characters;
+    std::unordered_map<std::string, uint32_t> stringIds;
+    auto intern = [&](const std::string &s) {
+        auto [it, inserted] = stringIds.emplace(s, (uint32_t) stringIds.size());
+        if (inserted) {
+            characters += s;
+            stringOffsets.push_back((uint32_t) characters.size());
+        }
+        return it->second;
+    };
+
+    std::vector<Vertex *> vertices = network.getVertexSet();
+    std::unordered_map<std::string, uint32_t> stationIndex;
+    std::vector<SnapshotStation> stations;
+    for (Vertex const *v: vertices) {
+        stationIndex[v->getId()] = (uint32_t) stations.size();
+        std::optional<Station> station = dataRepository.findStation(v->getId());
+        if (!station.has_value()) {
+            uint32_t none = intern("");
+            stations.push_back({intern(v->getId()), none, none, none, none});
+            continue;
+        }
+        stations.push_back({intern(v->getId()), intern(dataRepository.getString(station->getDistrict())),
+                            intern(dataRepository.getString(station->getMunicipality())),
+                            intern(dataRepository.getString(station->getTownship())),
+                            intern(dataRepository.getString(station->getLine()))});
+    }
+
+    //Every adjacency list orders the rails it contains, so any topological order of these constraints keeps them all
+    std::unordered_map<const Edge *, uint32_t> railIndex;
+    std::vector<Edge *> railEdges;
+    for (Vertex const *v: vertices) {
+        for (Edge *e: v->getAdj()) {
+            if (railIndex.count(e)) continue;
+            railIndex[e] = railIndex[e->getReverse()] = (uint32_t) railEdges.size();
+            railEdges.push_back(e);
+        }
+    }
+    std::vector<std::vector<uint32_t>> successors(railEdges.size());
+    std::vector<uint32_t> predecessors(railEdges.size(), 0);
+    for (Vertex const *v: vertices) {
+        std::vector<Edge *> adj = v->getAdj();
+        for (size_t i = 1; i < adj.size(); i++) {
+            successors[railIndex[adj[i - 1]]].push_back(railIndex[adj[i]]);
+            predecessors[railIndex[adj[i]]]++;
+        }
+    }
+    //The smallest rail index is taken first, so the rails of each station stay together as they were in the CSV file,
+    //and the Edges loaded back from the snapshot are allocated, and later traversed, with the same locality
+    std::vector<SnapshotRail> rails;
+    std::vector<Edge *> storedEdges;
+    std::unordered_map<const Edge *, uint32_t> edgeIndex;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> ready;
+    for (uint32_t r = 0; r < railEdges.size(); r++)
+        if (predecessors[r] == 0) ready.push(r);
+    while (!ready.empty()) {
+        uint32_t next = ready.top();
+        ready.pop();
+        Edge *e = railEdges[next];
+        if (!std::less<Edge *>()(e, e->getReverse())) e = e->getReverse();
+        edgeIndex[e] = 2 * (uint32_t) rails.size();
+        edgeIndex[e->getReverse()] = 2 * (uint32_t) rails.size() + 1;
+        storedEdges.push_back(e);
+        rails.push_back({stationIndex[e->getOrig()->getId()], stationIndex[e->getDest()->getId()], e->getCapacity(),
+                         (uint32_t) e->getService()});
+        for (uint32_t r: successors[next])
+            if (--predecessors[r] == 0) ready.push(r);
+    }
+    if (rails.size() != railEdges.size()) return false; //Adjacency lists not built by addBidirectionalEdge
+
+    //The FlowNetwork must have been built from this Graph, with its stations in the same order
+    std::vector<uint32_t> indexArrays[NUM_INDEX_ARRAYS];
+    if (flowNetwork.getNumStations() != stations.size() || flowNetwork.getNumRails() != rails.size()) return false;
+    for (unsigned int station = 0; station < flowNetwork.getNumStations(); station++) {
+        auto it = stationIndex.find(flowNetwork.getStationName(station));
+        if (it == stationIndex.end() || it->second != station) return false;
+    }
+    std::span<const unsigned int> arcs = flowNetwork.getFirstArcs();
+    indexArrays[FIRST_ARCS].assign(arcs.begin(), arcs.end());
+    arcs = flowNetwork.getAdjacentArcs();
+    indexArrays[ADJACENT_ARCS].assign(arcs.begin(), arcs.end());
+    for (unsigned int arc = 0; arc < 2 * flowNetwork.getNumRails(); arc++)
+        indexArrays[ARC_HEADS].push_back(flowNetwork.arcHead(arc));
+    for (unsigned int rail = 0; rail < flowNetwork.getNumRails(); rail++)
+        indexArrays[RAIL_EDGES].push_back(edgeIndex.at(flowNetwork.getRailEdge(rail)));
+
+    indexArrays[COMPONENT_OFFSETS].push_back(0);
+    for (unsigned int component = 0; component < bridgeDecomposition.getNumComponents(); component++) {
+        for (Vertex const *v: bridgeDecomposition.getComponentStations(component))
+            indexArrays[COMPONENT_STATIONS].push_back(stationIndex.at(v->getId()));
+        indexArrays[COMPONENT_OFFSETS].push_back((uint32_t) indexArrays[COMPONENT_STATIONS].size());
+    }
+    for (uint32_t rail = 0; rail < storedEdges.size(); rail++)
+        if (bridgeDecomposition.isBridge(storedEdges[rail])) indexArrays[BRIDGES].push_back(2 * rail);
+
+    for (unsigned int g = 0; g < DataRepository::NUM_GROUPINGS; g++) {
+        auto grouping = (Grouping) g;
+        indexArrays[GROUP_OFFSETS + g].push_back(0);
+        for (unsigned int group = 0; group < dataRepository.getNumGroups(grouping); group++) {
+            indexArrays[GROUP_NAMES + g].push_back(
+                    intern(dataRepository.getString(dataRepository.getGroupName(grouping, group))));
+            for (unsigned int station: dataRepository.getGroupStations(grouping, group)) {
+                const std::string &name = dataRepository.getString(dataRepository.getStations()[station].getName());
+                indexArrays[GROUP_STATIONS + g].push_back(stationIndex.at(name));
+            }
+            indexArrays[GROUP_OFFSETS + g].push_back((uint32_t) indexArrays[GROUP_STATIONS + g].size());
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.numStrings = (uint32_t) stringIds.size();
+    header.numStations = (uint32_t) stations.size();
+    header.numRails = (uint32_t) rails.size();
+    for (unsigned int i = 0; i < NUM_SOURCES; i++) header.sources[i] = sources[i];
+
+    auto align = [](uint64_t offset) { return (offset + alignof(uint64_t) - 1) / alignof(uint64_t) * alignof(uint64_t); };
+    header.stringsOffset = align(sizeof(Header));
+    header.stationsOffset = align(header.stringsOffset + stringOffsets.size() * sizeof(uint32_t) + characters.size());
+    header.railsOffset = align(header.stationsOffset + stations.size() * sizeof(SnapshotStation));
+    uint64_t end = header.railsOffset + rails.size() * sizeof(SnapshotRail);
+    for (unsigned int i = 0; i < NUM_INDEX_ARRAYS; i++) {
+        header.indexOffsets[i] = align(end);
+        header.indexSizes[i] = (uint32_t) indexArrays[i].size();
+        end = header.indexOffsets[i] + indexArrays[i].size() * sizeof(uint32_t);
+    }
+    header.fileSize = end;
+
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    auto put = [&file](uint64_t offset, const void *bytes, size_t count) {
+        static const char padding[alignof(uint64_t)] = {};
+        file.write(padding, (std::streamsize) (offset - (uint64_t) file.tellp()));
+        file.write(static_cast<const char *>(bytes), (std::streamsize) count);
+    };
+    put(0, &header, sizeof(Header));
+    put(header.stringsOffset, stringOffsets.data(), stringOffsets.size() * sizeof(uint32_t));
+    file.write(characters.data(), (std::streamsize) characters.size());
+    put(header.stationsOffset, stations.data(), stations.size() * sizeof(SnapshotStation));
+    put(header.railsOffset, rails.data(), rails.size() * sizeof(SnapshotRail));
+    for (unsigned int i = 0; i < NUM_INDEX_ARRAYS; i++)
+        put(header.indexOffsets[i], indexArrays[i].data(), indexArrays[i].size() * sizeof(uint32_t));
+    file.close();
+
+    std::error_code error;
+    if (file) std::filesystem::rename(temporaryPath, path, error);
+    if (!file || error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Checks if the snapshot was mapped and is well-formed
+ * @return True if the snapshot can be used, false otherwise
+ */
+bool NetworkSnapshot::isValid() const {
+    return data != nullptr;
+}
+
+/**
+ * Checks if the snapshot was written from files of the same sizes and modification times as the given ones
+ * Time Complexity: O(1)
+ * @param sources - Files the network would be loaded from
+ * @return True if the snapshot is up to date with them, false otherwise
+ */
+bool NetworkSnapshot::matchesSources(const std::array<SnapshotSource, NUM_SOURCES> &sources) const {
+    for (unsigned int i = 0; i < NUM_SOURCES; i++) {
+        if (header->sources[i].size != sources[i].size ||
+            header->sources[i].modificationTime != sources[i].modificationTime)
+            return false;
+    }
+    return true;
+}
+
+uint32_t NetworkSnapshot::getNumStations() const {
+    return header->numStations;
+}
+
+uint32_t NetworkSnapshot::getNumRails() const {
+    return header->numRails;
+}
+
+/**
+ * Gets a string of the string table, without copying it
+ * Time Complexity: O(1)
+ * @param id - Index of the string
+ * @return View of the string, valid for the lifetime of the snapshot
+ */
+std::string_view NetworkSnapshot::getString(uint32_t id) const {
+    return {characters + stringOffsets[id], stringOffsets[id + 1] - stringOffsets[id]};
+}
+
+const SnapshotStation &NetworkSnapshot::getStation(uint32_t station) const {
+    return stations[station];
+}
+
+const SnapshotRail &NetworkSnapshot::getRail(uint32_t rail) const {
+    return rails[rail];
+}
+
+/**
+ * Gets one of the index arrays of the snapshot, without copying it
+ * Time Complexity: O(1)
+ * @param array - IndexArray to get
+ * @return Span with the array, valid for the lifetime of the snapshot
+ */
+std::span<const uint32_t> NetworkSnapshot::getIndexArray(unsigned int array) const {
+    return {indexArrays[array], header->indexSizes[array]};
+}
@@ -0,0 +1,144 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_NETWORKSNAPSHOT_H
+#define RAILWAYMANAGEMENT_NETWORKSNAPSHOT_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graph.h"
+#include "dataRepository.h"
+
+class FlowNetwork;
+
+class BridgeDecomposition;
+
+/**
+ * Station record of a snapshot. Every attribute is an index into the snapshot's string table
+ */
+struct SnapshotStation {
+    uint32_t name;
+    uint32_t district;
+    uint32_t municipality;
+    uint32_t township;
+    uint32_t line;
+};
+
+/**
+ * Rail record of a snapshot, between two station indexes. Its Edge from source to target is edge 2r of the snapshot,
+ * and the reverse Edge is edge 2r + 1
+ */
+struct SnapshotRail {
+    uint32_t source;
+    uint32_t target;
+    uint32_t capacity;
+    uint32_t service;
+};
+
+/**
+ * Size and modification time of one of the files a snapshot was written from, to tell if the snapshot is still up to
+ * date
+ */
+struct SnapshotSource {
+    uint64_t size;
+    int64_t modificationTime;
+};
+
+/**
+ * Read-only, memory-mapped view of a binary snapshot of a railway network, written after a CSV load so that later
+ * launches don't have to parse the CSV files again. The file holds a versioned header, a string table, the station
+ * and rail arrays, and the index arrays of the structures derived from the network: the CSR of the FlowNetwork, the
+ * bridge tree of the BridgeDecomposition and the CSR of every grouping of the DataRepository. The Graph is still built
+ * from the mapping station by station and rail by rail, but those structures are built by copying their arrays
+ * instead of being computed again. The ContractedGraph and everything built from the FlowNetwork are not stored.
+ * Numbers are stored in the byte order of the machine that wrote the file
+ */
+class NetworkSnapshot {
+  public:
+    static const unsigned int NUM_SOURCES = 2; // stations file and network file
+
+    /**
+     * Index arrays of the snapshot, each an array of uint32_t. Rails are referred to by their index in the snapshot and
+     * Edges by their edge index (see SnapshotRail)
+     */
+    enum IndexArray : unsigned int {
+        FIRST_ARCS, ADJACENT_ARCS, ARC_HEADS, RAIL_EDGES, // FlowNetwork, with the Edge of each of its rails
+        COMPONENT_OFFSETS, COMPONENT_STATIONS, BRIDGES, // stations of each component, and one Edge of each bridge
+        GROUP_NAMES, // string of each group, for every grouping in the order of Grouping
+        GROUP_OFFSETS = GROUP_NAMES + DataRepository::NUM_GROUPINGS,
+        GROUP_STATIONS = GROUP_OFFSETS + DataRepository::NUM_GROUPINGS,
+        NUM_INDEX_ARRAYS = GROUP_STATIONS + DataRepository::NUM_GROUPINGS
+    };
+
+  private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t numStrings;
+        uint32_t numStations;
+        uint32_t numRails;
+        SnapshotSource sources[NUM_SOURCES];
+        uint64_t stringsOffset;
+        uint64_t stationsOffset;
+        uint64_t railsOffset;
+        uint64_t indexOffsets[NUM_INDEX_ARRAYS];
+        uint32_t indexSizes[NUM_INDEX_ARRAYS];
+        uint64_t fileSize;
+    };
+
+    const char *data = nullptr;
+    size_t size = 0;
+    const Header *header = nullptr;
+    const uint32_t *stringOffsets = nullptr;
+    const char *characters = nullptr;
+    const SnapshotStation *stations = nullptr;
+    const SnapshotRail *rails = nullptr;
+    const uint32_t *indexArrays[NUM_INDEX_ARRAYS] = {};
+
+    bool validate();
+
+    [[nodiscard]] bool validateIndexArrays() const;
+
+  public:
+    static const uint32_t VERSION;
+
+    explicit NetworkSnapshot(const std::string &path);
+
+    NetworkSnapshot(const NetworkSnapshot &) = delete;
+
+    NetworkSnapshot &operator=(const NetworkSnapshot &) = delete;
+
+    ~NetworkSnapshot();
+
+    static bool describeSource(const std::string &path, SnapshotSource &source);
+
+    static bool write(const std::string &path, const std::array<SnapshotSource, NUM_SOURCES> &sources,
+                      const Graph &network, const DataRepository &dataRepository, const FlowNetwork &flowNetwork,
+                      const BridgeDecomposition &bridgeDecomposition);
+
+    [[nodiscard]] bool isValid() const;
+
+    [[nodiscard]] bool matchesSources(const std::array<SnapshotSource, NUM_SOURCES> &sources) const;
+
+    [[nodiscard]] uint32_t getNumStations() const;
+
+    [[nodiscard]] uint32_t getNumRails() const;
+
+    [[nodiscard]] std::string_view getString(uint32_t id) const;
+
+    [[nodiscard]] const SnapshotStation &getStation(uint32_t station) const;
+
+    [[nodiscard]] const SnapshotRail &getRail(uint32_t rail) const;
+
+    [[nodiscard]] std::span<const uint32_t> getIndexArray(unsigned int array) const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_NETWORKSNAPSHOT_H
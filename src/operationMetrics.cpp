@@ -0,0 +1,269 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "operationMetrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * Index of the bucket of a value
+ * Time Complexity: O(1)
+ * @param nanoseconds - Value, clamped to MAX_VALUE
+ * @return Index of the bucket, in [0, NUM_BUCKETS)
+ */
+unsigned int LatencyHistogram::bucketIndex(uint64_t nanoseconds) {
+    nanoseconds = std::min(nanoseconds, MAX_VALUE);
+    unsigned int magnitude = 63 - (unsigned int) std::countl_zero(nanoseconds | 1);
+    if (magnitude < SUB_BUCKET_BITS) return (unsigned int) nanoseconds;
+    unsigned int shift = magnitude - SUB_BUCKET_BITS + 1;
+    return (shift << (SUB_BUCKET_BITS - 1)) + (unsigned int) (nanoseconds >> shift);
+}
+
+/**
+ * Smallest value above a bucket
+ * Time Complexity: O(1)
+ * @param index - Index of the bucket
+ * @return Exclusive upper bound of the bucket's values
+ */
+uint64_t LatencyHistogram::bucketUpperBound(unsigned int index) {
+    const unsigned int half = 1u << (SUB_BUCKET_BITS - 1);
+    if (index < 2 * half) return index + 1;
+    unsigned int shift = index / half - 1;
+    return (uint64_t) (index % half + half + 1) << shift;
+}
+
+/**
+ * Counts a value. Must only be called by the thread that owns the histogram
+ * Time Complexity: O(1)
+ * @param nanoseconds - Value to count
+ */
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    std::atomic<uint64_t> &bucket = buckets[bucketIndex(nanoseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+    if (nanoseconds > max.load(std::memory_order_relaxed)) max.store(nanoseconds, std::memory_order_relaxed);
+}
+
+/**
+ * Adds the values counted by another histogram to this one, which no other thread may be writing
+ * Time Complexity: O(NUM_BUCKETS)
+ * @param other - Histogram to add, possibly being written by its owner
+ */
+void LatencyHistogram::add(const LatencyHistogram &other) {
+    for (unsigned int i = 0; i < NUM_BUCKETS; i++)
+        buckets[i].fetch_add(other.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    count.fetch_add(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint64_t otherMax = other.max.load(std::memory_order_relaxed);
+    if (otherMax > max.load(std::memory_order_relaxed)) max.store(otherMax, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getSum() const {
+    return sum.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+/**
+ * Counts the values below a bound, exactly if the bound is a power of two
+ * Time Complexity: O(NUM_BUCKETS)
+ * @param nanoseconds - Bound
+ * @return Number of values in buckets entirely below the bound
+ */
+uint64_t LatencyHistogram::countBelow(uint64_t nanoseconds) const {
+    uint64_t below = 0;
+    for (unsigned int i = 0; i < NUM_BUCKETS && bucketUpperBound(i) <= nanoseconds; i++)
+        below += buckets[i].load(std::memory_order_relaxed);
+    return below;
+}
+
+/**
+ * Estimates a quantile of the values, as the upper end of the bucket where it falls
+ * Time Complexity: O(NUM_BUCKETS)
+ * @param q - Quantile, in [0, 1]
+ * @return Estimate of the quantile, never above the largest value, or 0 if nothing was counted
+ */
+uint64_t LatencyHistogram::quantile(double q) const {
+    uint64_t total = getCount();
+    if (total == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t) (q * (double) total + 0.5));
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketUpperBound(i) - 1, getMax());
+    }
+    return getMax();
+}
+
+std::atomic<bool> OperationMetrics::enabled(false);
+
+namespace {
+    struct ThreadHistograms;
+
+    /**
+     * Operations registered so far, histograms of the running threads and merged histograms of the finished ones
+     */
+    struct MetricsRegistry {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, std::string>> operations;
+        std::unordered_set<ThreadHistograms *> threads;
+        std::unique_ptr<LatencyHistogram> finished[OperationMetrics::MAX_OPERATIONS];
+    };
+
+    /**
+     * Never destroyed, as threads may still finish while static objects are destroyed at exit
+     */
+    MetricsRegistry &registry() {
+        static auto *metricsRegistry = new MetricsRegistry();
+        return *metricsRegistry;
+    }
+
+    /**
+     * Histograms written by a single thread, allocated the first time the thread runs each operation
+     */
+    struct ThreadHistograms {
+        std::atomic<LatencyHistogram *> histograms[OperationMetrics::MAX_OPERATIONS] = {};
+
+        ThreadHistograms() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().threads.insert(this);
+        }
+
+        ~ThreadHistograms() {
+            MetricsRegistry &metricsRegistry = registry();
+            std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+            metricsRegistry.threads.erase(this);
+            for (unsigned int i = 0; i < OperationMetrics::MAX_OPERATIONS; i++) {
+                LatencyHistogram *histogram = histograms[i].load(std::memory_order_relaxed);
+                if (histogram == nullptr) continue;
+                if (!metricsRegistry.finished[i]) metricsRegistry.finished[i] = std::make_unique<LatencyHistogram>();
+                metricsRegistry.finished[i]->add(*histogram);
+                delete histogram;
+            }
+        }
+    };
+}
+
+/**
+ * Registers an operation, or finds it if it was already registered
+ * Time Complexity: O(n), n being the number of operations registered
+ * @param component - Component the operation belongs to
+ * @param operation - Name of the operation
+ * @return Identifier of the operation, or NOT_REGISTERED if MAX_OPERATIONS were already registered
+ */
+unsigned int OperationMetrics::registerOperation(const std::string &component, const std::string &operation) {
+    MetricsRegistry &metricsRegistry = registry();
+    std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+    for (unsigned int i = 0; i < metricsRegistry.operations.size(); i++)
+        if (metricsRegistry.operations[i].first == component && metricsRegistry.operations[i].second == operation)
+            return i;
+    if (metricsRegistry.operations.size() == MAX_OPERATIONS) return NOT_REGISTERED;
+    metricsRegistry.operations.emplace_back(component, operation);
+    return (unsigned int) metricsRegistry.operations.size() - 1;
+}
+
+/**
+ * Turns recording on or off. Values recorded before are kept
+ * @param enable - True to record the operations from now on, false to stop
+ */
+void OperationMetrics::setEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+/**
+ * Records a run of an operation in the calling thread's histograms
+ * Time Complexity: O(1)
+ * @param operation - Identifier of the operation, as returned by registerOperation
+ * @param nanoseconds - Wall time of the run
+ */
+void OperationMetrics::record(unsigned int operation, uint64_t nanoseconds) {
+    if (operation >= MAX_OPERATIONS) return;
+    thread_local ThreadHistograms threadHistograms;
+    LatencyHistogram *histogram = threadHistograms.histograms[operation].load(std::memory_order_relaxed);
+    if (histogram == nullptr) {
+        histogram = new LatencyHistogram();
+        threadHistograms.histograms[operation].store(histogram, std::memory_order_release);
+    }
+    histogram->record(nanoseconds);
+}
+
+/**
+ * Formats a number of nanoseconds as seconds
+ */
+static std::string seconds(uint64_t nanoseconds) {
+    std::ostringstream text;
+    text.precision(12);
+    text << (double) nanoseconds / 1e9;
+    return text.str();
+}
+
+/**
+ * Writes the metrics of every registered operation in the Prometheus text exposition format: a histogram of its wall
+ * time (railway_operation_duration_seconds), whose count is the number of runs, and gauges with estimates of some of
+ * its quantiles and its maximum. The histogram's buckets are powers of four, from about 1 µs to about 69 s
+ * Time Complexity: O(n·t·b), n being the number of operations, t the number of threads and b NUM_BUCKETS
+ * @param out - Stream where the metrics are written
+ */
+void OperationMetrics::writePrometheus(std::ostream &out) {
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    std::vector<std::string> labels;
+    std::vector<std::unique_ptr<LatencyHistogram>> merged;
+    {
+        MetricsRegistry &metricsRegistry = registry();
+        std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+        for (unsigned int i = 0; i < metricsRegistry.operations.size(); i++) {
+            labels.push_back("component=\"" + metricsRegistry.operations[i].first + "\",operation=\"" +
+                             metricsRegistry.operations[i].second + "\"");
+            merged.push_back(std::make_unique<LatencyHistogram>());
+            if (metricsRegistry.finished[i]) merged[i]->add(*metricsRegistry.finished[i]);
+            for (ThreadHistograms *thread: metricsRegistry.threads) {
+                LatencyHistogram *histogram = thread->histograms[i].load(std::memory_order_acquire);
+                if (histogram != nullptr) merged[i]->add(*histogram);
+            }
+        }
+    }
+
+    std::ostringstream text;
+    text << "# HELP railway_operation_duration_seconds Wall time of the operations\n"
+         << "# TYPE railway_operation_duration_seconds histogram\n";
+    for (size_t i = 0; i < merged.size(); i++) {
+        for (unsigned int exponent = 10; exponent <= 36; exponent += 2)
+            text << "railway_operation_duration_seconds_bucket{" << labels[i] << ",le=\""
+                 << seconds(uint64_t(1) << exponent) << "\"} " << merged[i]->countBelow(uint64_t(1) << exponent)
+                 << '\n';
+        text << "railway_operation_duration_seconds_bucket{" << labels[i] << ",le=\"+Inf\"} "
+             << merged[i]->getCount() << '\n'
+             << "railway_operation_duration_seconds_sum{" << labels[i] << "} " << seconds(merged[i]->getSum()) << '\n'
+             << "railway_operation_duration_seconds_count{" << labels[i] << "} " << merged[i]->getCount() << '\n';
+    }
+
+    text << "# HELP railway_operation_duration_quantile_seconds Estimated quantiles of the wall time of the operations\n"
+         << "# TYPE railway_operation_duration_quantile_seconds gauge\n";
+    for (size_t i = 0; i < merged.size(); i++) {
+        if (merged[i]->getCount() == 0) continue;
+        for (double q: quantiles)
+            text << "railway_operation_duration_quantile_seconds{" << labels[i] << ",quantile=\"" << q << "\"} "
+                 << seconds(merged[i]->quantile(q)) << '\n';
+    }
+
+    text << "# HELP railway_operation_duration_max_seconds Longest wall time of the operations\n"
+         << "# TYPE railway_operation_duration_max_seconds gauge\n";
+    for (size_t i = 0; i < merged.size(); i++)
+        text << "railway_operation_duration_max_seconds{" << labels[i] << "} " << seconds(merged[i]->getMax()) << '\n';
+    out << text.str();
+}
@@ -0,0 +1,116 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_OPERATIONMETRICS_H
+#define RAILWAYMANAGEMENT_OPERATIONMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * Latency histogram with HDR-style log-linear buckets: values below 2^SUB_BUCKET_BITS nanoseconds have a bucket each,
+ * and every power of two above is split into 2^(SUB_BUCKET_BITS - 1) equal buckets, so a value is known within 1/32 of
+ * itself (about 3.1%), the error of taking a bucket's upper bound. Values above MAX_VALUE (about 18 minutes) are
+ * clamped. Buckets are atomics that only one thread writes, with plain loads and stores, so they can be read while
+ * they are written without locking the writer
+ */
+class LatencyHistogram {
+  public:
+    static const unsigned int SUB_BUCKET_BITS = 6;
+    static const unsigned int MAX_VALUE_BITS = 40;
+    static const uint64_t MAX_VALUE = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+    static const unsigned int NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) << (SUB_BUCKET_BITS - 1);
+
+  private:
+    std::atomic<uint64_t> buckets[NUM_BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+
+  public:
+    static unsigned int bucketIndex(uint64_t nanoseconds);
+
+    static uint64_t bucketUpperBound(unsigned int index);
+
+    void record(uint64_t nanoseconds);
+
+    void add(const LatencyHistogram &other);
+
+    [[nodiscard]] uint64_t getCount() const;
+
+    [[nodiscard]] uint64_t getSum() const;
+
+    [[nodiscard]] uint64_t getMax() const;
+
+    [[nodiscard]] uint64_t countBelow(uint64_t nanoseconds) const;
+
+    [[nodiscard]] uint64_t quantile(double q) const;
+};
+
+/**
+ * Latency of every instrumented operation, for operational monitoring of long-running processes. Operations are named
+ * by a component ("graph", "query") and an operation name, and registered once, the first time they run. Each thread
+ * records into its own histograms, without locks; the histograms of all threads are merged when the metrics are
+ * exported, and those of finished threads are folded into a shared set. Recording is off until setEnabled is called,
+ * in which case an instrumented operation only costs a relaxed atomic load
+ */
+class OperationMetrics {
+  public:
+    static const unsigned int MAX_OPERATIONS = 128;
+    static const unsigned int NOT_REGISTERED = (unsigned int) -1;
+
+    static unsigned int registerOperation(const std::string &component, const std::string &operation);
+
+    static void setEnabled(bool enable);
+
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void record(unsigned int operation, uint64_t nanoseconds);
+
+    static void writePrometheus(std::ostream &out);
+
+  private:
+    static std::atomic<bool> enabled;
+};
+
+/**
+ * Records the wall time of its own lifetime as one run of an operation, if metrics are enabled
+ */
+class OperationTimer {
+  private:
+    unsigned int operation = OperationMetrics::NOT_REGISTERED;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    explicit OperationTimer(unsigned int operation) {
+        if (!OperationMetrics::isEnabled()) return;
+        this->operation = operation;
+        start = std::chrono::steady_clock::now();
+    }
+
+    OperationTimer(const OperationTimer &) = delete;
+
+    OperationTimer &operator=(const OperationTimer &) = delete;
+
+    ~OperationTimer() {
+        if (operation == OperationMetrics::NOT_REGISTERED) return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        OperationMetrics::record(operation, (uint64_t) elapsed.count());
+    }
+};
+
+/**
+ * Times the rest of the enclosing scope as a run of an operation. The operation is registered the first time the
+ * scope is entered
+ */
+#define TIME_OPERATION(component, operation) \
+    static const unsigned int operationMetricsId = OperationMetrics::registerOperation(component, operation); \
+    OperationTimer operationTimer(operationMetricsId)
+
+#endif //RAILWAYMANAGEMENT_OPERATIONMETRICS_H
@@ -0,0 +1,77 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_PARALLEL_H
+#define RAILWAYMANAGEMENT_PARALLEL_H
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+
+#include "queryStats.h"
+
+/**
+ * Number of worker threads to use by default, i.e. one per hardware thread
+ * @return Number of threads, at least 1
+ */
+inline unsigned int defaultThreadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Runs body(i, worker) for every i in [0, count), distributing the indexes dynamically over a pool of threads. Each
+ * worker has a distinct index in [0, threads), so it can own its scratch data. With instrumentation, the work counted by
+ * the other threads is added to the calling thread's QueryStats. If body throws, the remaining indexes are abandoned and
+ * the first exception is rethrown to the caller once every thread has stopped
+ * Time Complexity: O(count * T(body) / threads)
+ * @param count - Number of iterations
+ * @param body - Callable receiving the iteration index and the worker index
+ * @param threads - Number of threads to use, 0 meaning defaultThreadCount()
+ */
+template<typename Body>
+void parallelFor(size_t count, Body &&body, unsigned int threads = 0) {
+    if (threads == 0) threads = defaultThreadCount();
+    threads = (unsigned int) std::min<size_t>(threads, count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; i++) body(i, 0u);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto run = [&next, &body, count, &failure, &failureMutex](unsigned int workerIndex) {
+        try {
+            for (size_t i = next++; i < count; i = next++) body(i, workerIndex);
+        } catch (...) {
+            next = count;
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+        }
+    };
+#ifdef RAILWAY_INSTRUMENTATION
+    QueryStats &callerStats = QueryStats::current();
+    std::mutex statsMutex;
+    auto worker = [&run, &callerStats, &statsMutex](unsigned int workerIndex) {
+        if (workerIndex > 0) QueryStats::current().reset();
+        run(workerIndex);
+        if (workerIndex == 0) return;
+        std::lock_guard<std::mutex> lock(statsMutex);
+        callerStats.merge(QueryStats::current());
+    };
+#else
+    auto &worker = run;
+#endif
+
+    std::vector<std::thread> pool;
+    for (unsigned int w = 1; w < threads; w++) pool.emplace_back(worker, w);
+    worker(0);
+    for (std::thread &t: pool) t.join();
+    if (failure) std::rethrow_exception(failure);
+}
+
+#endif //RAILWAYMANAGEMENT_PARALLEL_H
@@ -0,0 +1,482 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "queryEngine.h"
+#include "parallel.h"
+#include "csvReader.h"
+#include "queryStats.h"
+#include "operationMetrics.h"
+#include "memoryAccounting.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <new>
+#include <sstream>
+#include <iomanip>
+
+// Names of the queries, whose operations are registered once per engine (see OperationMetrics)
+static const char *const QUERY_NAMES[] = {"max_flow", "incoming_flux", "min_cost", "widest_path", "cheapest_route",
+                                          "shortest_route", "failure_max_flow", "closure_max_flow", "critical_rails",
+                                          "worst_failures", "top_groupings", "top_closures", "memory_usage"};
+
+QueryEngine::QueryEngine(const DataRepository &dataRepository, const FlowNetwork &flowNetwork,
+                         const WidestPathTree *widestPathTree, const ContractionHierarchy *costHierarchy,
+                         const ContractionHierarchy *hopHierarchy) : dataRepository(dataRepository),
+                                                                     flowNetwork(flowNetwork),
+                                                                     widestPathTree(widestPathTree),
+                                                                     costHierarchy(costHierarchy),
+                                                                     hopHierarchy(hopHierarchy) {
+    for (const char *name: QUERY_NAMES)
+        queryOperations.emplace(name, OperationMetrics::registerOperation("query", name));
+}
+
+/**
+ * Chooses whether results include the work counters of their query (see QueryStats), as a "stats" member. Only has an
+ * effect if the project was built with instrumentation
+ * @param include - True to include the counters, false otherwise
+ */
+void QueryEngine::setIncludeStats(bool include) {
+    includeStats = include && QueryStats::ENABLED;
+}
+
+/**
+ * Escapes a string as a JSON string literal
+ * Time Complexity: O(n), n being the length of the string
+ * @param string - String to escape
+ * @return JSON string, including the surrounding quotes
+ */
+std::string QueryEngine::jsonString(std::string_view string) {
+    std::string result = "\"";
+    for (char c: string) {
+        switch (c) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                if ((unsigned char) c < 0x20) {
+                    std::ostringstream escaped;
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c;
+                    result += escaped.str();
+                } else {
+                    result += c;
+                }
+        }
+    }
+    return result + "\"";
+}
+
+/**
+ * Finds the index of a station in the flow network, by name
+ * Time Complexity: O(n) (average case), n being the length of the name
+ * @param name - Name of the station
+ * @param error - Set to a description of the problem if there is no such station
+ * @return Index of the station, or FlowNetwork::NOT_FOUND
+ */
+unsigned int QueryEngine::findStation(std::string_view name, std::string &error) const {
+    unsigned int station = flowNetwork.findStation(std::string(name));
+    if (station == FlowNetwork::NOT_FOUND) error = "unknown station " + std::string(name);
+    return station;
+}
+
+/**
+ * Takes out of service, in a mask, the rails between the pairs of stations listed from a given field of a query on
+ * Time Complexity: O(n·d), n being the number of pairs and d the maximum degree of a station
+ * @param query - Fields of the query
+ * @param first - Index of the first field of the pairs
+ * @param mask - Mask where the rails are taken out of service
+ * @param error - Set to a description of the problem if the pairs aren't valid
+ * @return True if every pair named existing rails, false otherwise
+ */
+bool QueryEngine::failRails(const std::vector<std::string> &query, size_t first, FailureMask &mask,
+                            std::string &error) const {
+    if ((query.size() - first) % 2 != 0) {
+        error = "rails must be given as pairs of stations";
+        return false;
+    }
+    mask.rails.assign(flowNetwork.getNumRails(), false);
+    for (size_t i = first; i < query.size(); i += 2) {
+        unsigned int station1 = findStation(query[i], error);
+        unsigned int station2 = findStation(query[i + 1], error);
+        if (!error.empty()) return false;
+        std::vector<unsigned int> rails = flowNetwork.findRails(station1, station2);
+        if (rails.empty()) {
+            error = "no rail between " + query[i] + " and " + query[i + 1];
+            return false;
+        }
+        for (unsigned int rail: rails) mask.rails[rail] = true;
+    }
+    return true;
+}
+
+/**
+ * Describes a rail as the JSON array of its two stations
+ * @param edge - Edge of the rail
+ * @return JSON array
+ */
+std::string QueryEngine::railJson(const Edge *edge) const {
+    std::string result = "[";
+    result += jsonString(edge->getOrig()->getId());
+    result += ",";
+    result += jsonString(edge->getDest()->getId());
+    return result + "]";
+}
+
+/**
+ * Describes a route as the JSON array of the stations it goes through
+ * @param source - Index of the station the route starts at
+ * @param rails - Rails of the route, in order from the source
+ * @return JSON array, empty if the route has no rails
+ */
+std::string QueryEngine::routeJson(unsigned int source, const std::vector<unsigned int> &rails) const {
+    if (rails.empty()) return "[]";
+    std::string result = "[";
+    result += jsonString(flowNetwork.getStationName(source));
+    for (unsigned int station = source; unsigned int rail: rails) {
+        unsigned int tail = flowNetwork.arcTail(2 * rail);
+        station = tail == station ? flowNetwork.arcHead(2 * rail) : tail;
+        result += ',';
+        result += jsonString(flowNetwork.getStationName(station));
+    }
+    return result + "]";
+}
+
+/**
+ * Parses an optional count argument of a query
+ * @param query - Fields of the query
+ * @param index - Index of the argument
+ * @param fallback - Value to use when the query doesn't have the argument
+ * @param value - Where the count is stored
+ * @return True if the argument is missing or a valid count, false otherwise
+ */
+static bool parseCount(const std::vector<std::string> &query, size_t index, unsigned int fallback,
+                       unsigned int &value) {
+    value = fallback;
+    if (index >= query.size()) return true;
+    const std::string &field = query[index];
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return error == std::errc() && end == field.data() + field.size();
+}
+
+/**
+ * Runs a query
+ * @param query - Fields of the query
+ * @param threads - Number of threads the query may use
+ * @param error - Set to a description of the problem if the query isn't valid
+ * @return JSON value of the result, meaningless if error was set
+ */
+std::string QueryEngine::run(const std::vector<std::string> &query, unsigned int threads, std::string &error) const {
+    const std::string &name = query[0];
+    std::ostringstream result;
+    auto expect = [&query, &error](size_t minimum, size_t maximum) {
+        if (query.size() - 1 >= minimum && query.size() - 1 <= maximum) return true;
+        error = "wrong number of arguments";
+        return false;
+    };
+    const size_t any = (size_t) -1;
+
+    if (name == "max_flow" || name == "min_cost" || name == "failure_max_flow" || name == "closure_max_flow" ||
+        name == "critical_rails" || name == "worst_failures" || name == "widest_path" ||
+        name == "cheapest_route" || name == "shortest_route") {
+        if (!expect(2, any)) return "";
+        unsigned int source = findStation(query[1], error);
+        unsigned int target = findStation(query[2], error);
+        if (!error.empty()) return "";
+
+        if (name == "max_flow") {
+            if (!expect(2, 2)) return "";
+            result << "{\"flow\":" << flowNetwork.maxFlow({source}, target) << "}";
+        } else if (name == "min_cost") {
+            if (!expect(2, 2)) return "";
+            auto [flow, cost] = flowNetwork.minCostMaxFlow(source, target);
+            result << "{\"flow\":" << flow << ",\"cost\":" << cost << "}";
+        } else if (name == "widest_path") {
+            if (!expect(2, 2)) return "";
+            std::pair<unsigned int, std::vector<unsigned int>> path;
+            if (widestPathTree != nullptr) {
+                path = {widestPathTree->widestCapacity(source, target), widestPathTree->widestPath(source, target)};
+            } else {
+                path = flowNetwork.widestPath(source, target);
+            }
+            result << "{\"capacity\":" << path.first << ",\"route\":" << routeJson(source, path.second) << "}";
+        } else if (name == "cheapest_route" || name == "shortest_route") {
+            if (!expect(2, 2)) return "";
+            RouteMetric metric = name == "cheapest_route" ? RouteMetric::COST : RouteMetric::HOPS;
+            const ContractionHierarchy *hierarchy = metric == RouteMetric::COST ? costHierarchy : hopHierarchy;
+            std::pair<unsigned int, std::vector<unsigned int>> path = hierarchy != nullptr ?
+                                                                      hierarchy->shortestPath(source, target) :
+                                                                      flowNetwork.shortestPath(source, target, metric);
+            result << (metric == RouteMetric::COST ? "{\"cost\":" : "{\"rails\":");
+            if (path.first == FlowNetwork::NOT_FOUND) result << "null";
+            else result << path.first;
+            result << ",\"route\":" << routeJson(source, path.second) << "}";
+        } else if (name == "failure_max_flow") {
+            FailureMask mask;
+            if (!failRails(query, 3, mask, error)) return "";
+            result << "{\"flow\":" << flowNetwork.maxFlow({source}, target, mask) << ",\"original\":"
+                   << flowNetwork.maxFlow({source}, target) << "}";
+        } else if (name == "closure_max_flow") {
+            FailureMask mask;
+            mask.stations.assign(flowNetwork.getNumStations(), false);
+            for (size_t i = 3; i < query.size(); i++) {
+                unsigned int station = findStation(query[i], error);
+                if (!error.empty()) return "";
+                mask.stations[station] = true;
+            }
+            result << "{\"flow\":" << flowNetwork.maxFlow({source}, target, mask) << ",\"original\":"
+                   << flowNetwork.maxFlow({source}, target) << "}";
+        } else if (name == "critical_rails") {
+            unsigned int n;
+            if (!expect(2, 3)) return "";
+            if (!parseCount(query, 3, 10, n)) {
+                error = "invalid number of rails";
+                return "";
+            }
+            auto rails = flowNetwork.criticalRails({source}, target, threads);
+            result << "{\"original\":" << (rails.empty() ? 0 : rails[0].second.first) << ",\"rails\":[";
+            for (size_t i = 0; i < std::min<size_t>(n, rails.size()); i++) {
+                result << (i ? "," : "") << "{\"rail\":" << railJson(rails[i].first) << ",\"capacity\":"
+                       << rails[i].first->getCapacity() << ",\"flow\":" << rails[i].second.second << "}";
+            }
+            result << "]}";
+        } else {
+            unsigned int k, n;
+            if (!expect(3, 4)) return "";
+            if (!parseCount(query, 3, 1, k) || k == 0 || k > MAX_FAILURES || !parseCount(query, 4, 5, n)) {
+                error = "invalid number of failures";
+                return "";
+            }
+            auto failures = flowNetwork.worstFailures({source}, target, k, n, threads);
+            result << "{\"original\":" << flowNetwork.maxFlow({source}, target) << ",\"failures\":[";
+            for (size_t i = 0; i < failures.size(); i++) {
+                result << (i ? "," : "") << "{\"rails\":[";
+                for (size_t j = 0; j < failures[i].first.size(); j++)
+                    result << (j ? "," : "") << railJson(failures[i].first[j]);
+                result << "],\"flow\":" << failures[i].second << "}";
+            }
+            result << "]}";
+        }
+    } else if (name == "incoming_flux") {
+        if (!expect(1, 1)) return "";
+        unsigned int station = findStation(query[1], error);
+        if (!error.empty()) return "";
+        result << "{\"flow\":" << flowNetwork.maxFlow(flowNetwork.superSource(station), station) << "}";
+    } else if (name == "top_groupings") {
+        if (!expect(2, 2)) return "";
+        const std::vector<std::pair<std::string, Grouping>> groupings = {
+                {"district",     Grouping::DISTRICT},
+                {"municipality", Grouping::MUNICIPALITY},
+                {"township",     Grouping::TOWNSHIP},
+                {"line",         Grouping::LINE}};
+        auto grouping = std::find_if(groupings.begin(), groupings.end(),
+                                     [&query](const auto &g) { return g.first == query[1]; });
+        unsigned int k;
+        if (grouping == groupings.end()) {
+            error = "unknown grouping " + query[1];
+            return "";
+        }
+        if (!parseCount(query, 2, 0, k)) {
+            error = "invalid number of groups";
+            return "";
+        }
+
+        //Groups are evaluated lazily, in decreasing order of an upper bound of their average (see topGroups). Each
+        //batch evaluates one group per thread, whose stations are spread over the threads
+        Grouping attribute = grouping->second;
+        auto stationIndex = [this](unsigned int s) {
+            return flowNetwork.findStation(dataRepository.getString(dataRepository.getStations()[s].getName()));
+        };
+        auto incidentCapacity = [this, &stationIndex](unsigned int s) {
+            unsigned int station = stationIndex(s);
+            return station == FlowNetwork::NOT_FOUND ? 0.0 : (double) flowNetwork.incidentCapacity(station);
+        };
+        auto averageFluxes = [&](const std::vector<unsigned int> &groups) {
+            std::vector<unsigned int> batchStations;
+            for (unsigned int group: groups) {
+                auto stations = dataRepository.getGroupStations(attribute, group);
+                batchStations.insert(batchStations.end(), stations.begin(), stations.end());
+            }
+            std::vector<unsigned int> incoming(batchStations.size());
+            parallelFor(batchStations.size(), [&](size_t i, unsigned int) {
+                unsigned int station = stationIndex(batchStations[i]);
+                incoming[i] = station == FlowNetwork::NOT_FOUND ? 0 : flowNetwork.maxFlow(
+                        flowNetwork.superSource(station), station);
+            }, threads);
+
+            std::vector<double> averages;
+            size_t i = 0;
+            for (unsigned int group: groups) {
+                double sum = 0;
+                size_t size = dataRepository.getGroupStations(attribute, group).size();
+                for (size_t j = 0; j < size; j++) sum += incoming[i++];
+                averages.push_back(sum / (double) size);
+            }
+            return averages;
+        };
+        std::vector<std::pair<std::string, double>> averages = dataRepository.topGroups(
+                attribute, k, incidentCapacity, averageFluxes, threads == 0 ? defaultThreadCount() : threads);
+
+        result << "{\"groups\":[";
+        for (size_t i = 0; i < std::min<size_t>(k, averages.size()); i++)
+            result << (i ? "," : "") << "{\"name\":" << jsonString(averages[i].first) << ",\"average\":"
+                   << averages[i].second << "}";
+        result << "]}";
+    } else if (name == "top_closures") {
+        unsigned int n;
+        if (!expect(0, 1)) return "";
+        if (!parseCount(query, 1, 10, n)) {
+            error = "invalid number of stations";
+            return "";
+        }
+        auto closures = flowNetwork.topStationClosures(threads);
+        result << "{\"stations\":[";
+        for (size_t i = 0; i < std::min<size_t>(n, closures.size()); i++)
+            result << (i ? "," : "") << "{\"name\":" << jsonString(closures[i].first) << ",\"pairs_lost\":"
+                   << closures[i].second.first << ",\"capacity\":" << closures[i].second.second << "}";
+        result << "]}";
+    } else if (name == "memory_usage") {
+        if (!expect(0, 0)) return "";
+        result << MemoryAccounting::toJson();
+    } else {
+        error = "unknown query " + name;
+    }
+    return result.str();
+}
+
+/**
+ * Runs a query and describes its outcome as a line of JSON with the query's id, name and arguments, and either its
+ * result or an error. A query that throws, e.g. because it runs out of memory, is answered with an error too, so that
+ * the batch and server modes survive it. With OperationMetrics enabled, the wall time of valid queries is recorded by
+ * query name
+ * @param query - Fields of the query
+ * @param id - JSON value identifying the query
+ * @param threads - Number of threads the query may use, 0 meaning one per hardware thread
+ * @return JSON object, without a trailing line break
+ */
+std::string QueryEngine::execute(const std::vector<std::string> &query, const std::string &id,
+                                 unsigned int threads) const {
+    bool succeeded;
+    return execute(query, id, succeeded, threads);
+}
+
+/**
+ * Runs a query and describes its outcome as a line of JSON, like execute above
+ * @param query - Fields of the query
+ * @param id - JSON value identifying the query
+ * @param succeeded - Set to true if the line has the query's result, false if it has an error
+ * @param threads - Number of threads the query may use, 0 meaning one per hardware thread
+ * @return JSON object, without a trailing line break
+ */
+std::string QueryEngine::execute(const std::vector<std::string> &query, const std::string &id, bool &succeeded,
+                                 unsigned int threads) const {
+    succeeded = false;
+    std::string line = "{\"id\":" + id;
+    if (query.empty()) return line + ",\"error\":\"empty query\"}";
+
+    line += ",\"query\":" + jsonString(query[0]) + ",\"args\":[";
+    for (size_t i = 1; i < query.size(); i++) {
+        if (i > 1) line += ',';
+        line += jsonString(query[i]);
+    }
+    line += "]";
+
+    std::string error;
+    QueryStats::current().reset();
+    bool timed = OperationMetrics::isEnabled();
+    auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    std::string result;
+    try {
+        result = run(query, threads, error);
+    } catch (const std::bad_alloc &) {
+        error = "out of memory";
+    } catch (const std::exception &exception) {
+        error = std::string("internal error: ") + exception.what();
+    }
+    if (!error.empty()) return line + ",\"error\":" + jsonString(error) + "}";
+    succeeded = true;
+    auto operation = queryOperations.find(query[0]);
+    if (timed && operation != queryOperations.end()) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        OperationMetrics::record(operation->second, (uint64_t) elapsed.count());
+    }
+    if (includeStats) return line + ",\"result\":" + result + ",\"stats\":" + QueryStats::current().toJson() + "}";
+    return line + ",\"result\":" + result + "}";
+}
+
+/**
+ * Runs independent queries in parallel, each on a single thread. A single query gets all the threads instead
+ * Time Complexity: O(sum of the queries' complexities / threads)
+ * @param queries - Fields of each query
+ * @param threads - Number of threads to use, 0 meaning one per hardware thread
+ * @return Vector with the JSON line of each query, in the same order, identified by their position starting at 1
+ */
+std::vector<std::string> QueryEngine::executeAll(const std::vector<std::vector<std::string>> &queries,
+                                                 unsigned int threads) const {
+    unsigned int numFailed;
+    return executeAll(queries, numFailed, threads);
+}
+
+/**
+ * Runs independent queries in parallel, like executeAll above, and counts the ones that failed
+ * Time Complexity: O(sum of the queries' complexities / threads)
+ * @param queries - Fields of each query
+ * @param numFailed - Set to the number of queries whose line has an error
+ * @param threads - Number of threads to use, 0 meaning one per hardware thread
+ * @return Vector with the JSON line of each query, in the same order, identified by their position starting at 1
+ */
+std::vector<std::string> QueryEngine::executeAll(const std::vector<std::vector<std::string>> &queries,
+                                                 unsigned int &numFailed, unsigned int threads) const {
+    std::vector<std::string> results(queries.size());
+    std::vector<char> succeeded(queries.size(), false); //not vector<bool>, whose elements can't be set concurrently
+    if (queries.size() == 1) {
+        bool querySucceeded;
+        results[0] = execute(queries[0], "1", querySucceeded, threads);
+        succeeded[0] = querySucceeded;
+    } else {
+        parallelFor(queries.size(), [&](size_t i, unsigned int) {
+            bool querySucceeded;
+            results[i] = execute(queries[i], std::to_string(i + 1), querySucceeded);
+            succeeded[i] = querySucceeded;
+        }, threads);
+    }
+    numFailed = (unsigned int) std::count(succeeded.begin(), succeeded.end(), false);
+    return results;
+}
+
+/**
+ * Runs a query script. Every non-empty line of the script that doesn't start with # is a query in CSV format, and its
+ * result is written to the output as a line of JSON, in the same order. Independent queries run in parallel
+ * Time Complexity: O(n + sum of the queries' complexities / threads), n being the length of the script
+ * @param script - Contents of the script
+ * @param out - Stream where the results are written
+ * @param threads - Number of threads to use, 0 meaning one per hardware thread
+ * @return 0 if every query succeeded, 1 if some query failed
+ */
+int QueryEngine::runScript(std::string_view script, std::ostream &out, unsigned int threads) const {
+    std::vector<std::vector<std::string>> queries;
+    CsvReader reader(script.data(), script.size());
+    std::vector<std::string_view> fields;
+    while (reader.nextRecord(fields)) {
+        if (fields[0].starts_with('#')) continue;
+        queries.emplace_back(fields.begin(), fields.end());
+    }
+
+    unsigned int numFailed;
+    for (const std::string &result: executeAll(queries, numFailed, threads)) out << result << '\n';
+    out.flush();
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_QUERYENGINE_H
+#define RAILWAYMANAGEMENT_QUERYENGINE_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "dataRepository.h"
+#include "flowNetwork.h"
+#include "widestPathTree.h"
+#include "contractionHierarchy.h"
+
+/**
+ * Non-interactive front end to the flow queries of a loaded network. A query is a list of fields, the first being its
+ * name and the others its arguments:
+ *   max_flow,A,B                      max number of trains between stations A and B
+ *   incoming_flux,A                   max number of trains arriving at station A from the ends of its lines
+ *   min_cost,A,B                      max flow between A and B and its minimum cost
+ *   widest_path,A,B                   the single route between A and B that can take the most trains, and its capacity
+ *   cheapest_route,A,B                the route between A and B with the lowest cost of services, and its cost
+ *   shortest_route,A,B                the route between A and B with the fewest rails, and their number
+ *   failure_max_flow,A,B,X1,Y1,...    max flow between A and B with the rails between Xi and Yi out of service
+ *   closure_max_flow,A,B,S1,...       max flow between A and B with stations S1, ... closed
+ *   critical_rails,A,B[,n]            the n rails whose failure reduces the max flow between A and B the most
+ *   worst_failures,A,B,k[,n]          the n worst combinations of up to k (1 to 3) rail failures between A and B
+ *   top_groupings,G,k                 the k districts, municipalities, townships or lines (G) with most incoming trains
+ *   top_closures[,n]                  the n stations whose closure disconnects the most pairs of stations
+ *   memory_usage                      memory of the network's structures (see MemoryAccounting)
+ * Every result is a single line of JSON, optionally with the query's QueryStats. Only thread-safe FlowNetwork queries
+ * are used, so independent queries run in parallel. Widest paths and routes are answered by a WidestPathTree and a
+ * ContractionHierarchy per RouteMetric if they are given, and searched in the FlowNetwork otherwise
+ */
+class QueryEngine {
+  private:
+    static const unsigned int MAX_FAILURES = 3; // most simultaneous failures of a worst_failures query, as in the menu
+
+    const DataRepository &dataRepository;
+    const FlowNetwork &flowNetwork;
+    const WidestPathTree *widestPathTree;
+    const ContractionHierarchy *costHierarchy;
+    const ContractionHierarchy *hopHierarchy;
+    bool includeStats = false;
+    // OperationMetrics identifier of each query, registered by the constructor
+    std::unordered_map<std::string, unsigned int> queryOperations;
+
+    unsigned int findStation(std::string_view name, std::string &error) const;
+
+    bool failRails(const std::vector<std::string> &query, size_t first, FailureMask &mask, std::string &error) const;
+
+    [[nodiscard]] std::string railJson(const Edge *edge) const;
+
+    [[nodiscard]] std::string routeJson(unsigned int source, const std::vector<unsigned int> &rails) const;
+
+    std::string run(const std::vector<std::string> &query, unsigned int threads, std::string &error) const;
+
+  public:
+    QueryEngine(const DataRepository &dataRepository, const FlowNetwork &flowNetwork,
+                const WidestPathTree *widestPathTree = nullptr, const ContractionHierarchy *costHierarchy = nullptr,
+                const ContractionHierarchy *hopHierarchy = nullptr);
+
+    void setIncludeStats(bool include);
+
+    [[nodiscard]] std::string execute(const std::vector<std::string> &query, const std::string &id,
+                                      unsigned int threads = 1) const;
+
+    std::string execute(const std::vector<std::string> &query, const std::string &id, bool &succeeded,
+                        unsigned int threads = 1) const;
+
+    [[nodiscard]] std::vector<std::string> executeAll(const std::vector<std::vector<std::string>> &queries,
+                                                      unsigned int threads = 0) const;
+
+    std::vector<std::string> executeAll(const std::vector<std::vector<std::string>> &queries,
+                                        unsigned int &numFailed, unsigned int threads = 0) const;
+
+    int runScript(std::string_view script, std::ostream &out, unsigned int threads = 0) const;
+
+    static std::string jsonString(std::string_view string);
+};
+
+
+#endif //RAILWAYMANAGEMENT_QUERYENGINE_H
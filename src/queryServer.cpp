@@ -0,0 +1,470 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "queryServer.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#endif
+
+const size_t QueryServer::MAX_LINE_LENGTH = 1 << 20;
+const size_t QueryServer::MAX_CLIENTS = 64;
+const size_t QueryServer::MAX_WAITING = 256;
+
+QueryServer::QueryServer(const QueryEngine &queryEngine) : queryEngine(queryEngine) {}
+
+/**
+ * Stops listening, removing the Unix-domain socket if there is one
+ */
+QueryServer::~QueryServer() {
+#ifndef _WIN32
+    if (listener >= 0) close(listener);
+    if (!socketPath.empty()) unlink(socketPath.c_str());
+#endif
+}
+
+/**
+ * Starts listening on a Unix-domain socket, replacing any stale socket at the same path
+ * @param path - Path of the socket
+ * @return True if the server is listening, false otherwise
+ */
+bool QueryServer::listenUnix(const std::string &path) {
+#ifndef _WIN32
+    sockaddr_un address{};
+    if (listener >= 0 || path.size() >= sizeof(address.sun_path)) return false;
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    unlink(path.c_str());
+    if (bind(listener, (sockaddr *) &address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    socketPath = path;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Starts listening on a TCP port of the loopback interface, so that only local clients can connect
+ * @param port - Port number, 0 meaning any free port
+ * @return True if the server is listening, false otherwise
+ */
+bool QueryServer::listenTcp(unsigned short port) {
+#ifndef _WIN32
+    if (listener >= 0) return false;
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, (sockaddr *) &address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Accepts clients until stop is set, handing each one to an idle worker, or to a new one while there are fewer than
+ * MAX_CLIENTS. Before returning, the connections still open are shut down, those still waiting are closed and every
+ * worker is joined
+ * Time Complexity: O(1) per connection, plus the complexity of the queries
+ * @param stop - Flag checked periodically, for instance set by a signal handler
+ */
+void QueryServer::run(const std::atomic<bool> &stop) {
+#ifndef _WIN32
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        stopping = false;
+    }
+    while (!stop && listener >= 0) {
+        pollfd polled{listener, POLLIN, 0};
+        if (poll(&polled, 1, 200) <= 0 || !(polled.revents & POLLIN)) continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+
+        std::unique_lock<std::mutex> lock(clientsMutex);
+        if (waiting.size() >= MAX_WAITING) {
+            lock.unlock();
+            sendAll(client, "{\"id\":null,\"error\":\"server busy\"}\n");
+            close(client);
+            continue;
+        }
+        waiting.push_back(client);
+        if (idleWorkers == 0 && workers.size() < MAX_CLIENTS) workers.emplace_back(&QueryServer::work, this);
+        else clientWaiting.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        stopping = true;
+        for (int client: clients) shutdown(client, SHUT_RDWR);
+        for (int client: waiting) close(client);
+        waiting.clear();
+    }
+    clientWaiting.notify_all();
+    for (std::thread &worker: workers) worker.join();
+    workers.clear();
+#endif
+}
+
+/**
+ * Serves the waiting clients one at a time, until the server stops
+ */
+void QueryServer::work() {
+#ifndef _WIN32
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    while (true) {
+        idleWorkers++;
+        clientWaiting.wait(lock, [this] { return stopping || !waiting.empty(); });
+        idleWorkers--;
+        if (stopping) return;
+        int client = waiting.front();
+        waiting.pop_front();
+        clients.insert(client);
+
+        lock.unlock();
+        serveClient(client);
+        lock.lock();
+        clients.erase(client);
+        close(client); //Only once it can't be shut down, as its descriptor may be reused
+    }
+#endif
+}
+
+/**
+ * Writes all of a buffer to a socket
+ * @param client - Socket of the client
+ * @param data - Data to send
+ * @return True if everything was sent, false if the connection was lost
+ */
+bool QueryServer::sendAll(int client, std::string_view data) {
+#ifndef _WIN32
+    while (!data.empty()) {
+        ssize_t sent = send(client, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data.remove_prefix((size_t) sent);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Answers every line a client sends until it closes the connection. Lines longer than MAX_LINE_LENGTH are answered
+ * with an error and end the connection
+ * @param client - Socket of the client
+ */
+void QueryServer::serveClient(int client) {
+#ifndef _WIN32
+    std::string pending;
+    char buffer[1 << 16];
+    bool open = true;
+    while (open) {
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        pending.append(buffer, (size_t) received);
+
+        size_t start = 0;
+        for (size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start)) {
+            std::string_view line(pending.data() + start, end - start);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.find_first_not_of(" \t") != std::string_view::npos && !sendAll(client, answer(line) + '\n')) {
+                open = false;
+                break;
+            }
+            start = end + 1;
+        }
+        pending.erase(0, start);
+        if (open && pending.size() > MAX_LINE_LENGTH) {
+            sendAll(client, "{\"id\":null,\"error\":\"request too long\"}\n");
+            open = false;
+        }
+    }
+#endif
+}
+
+/**
+ * Answers a request line
+ * @param line - Request, without the line break
+ * @return JSON line with the result, or with an error if the request is malformed, without a trailing line break
+ */
+std::string QueryServer::answer(std::string_view line) const {
+    std::string id, error;
+    std::vector<std::string> query;
+    if (!parseRequest(line, id, query, error))
+        return "{\"id\":" + id + ",\"error\":" + QueryEngine::jsonString(error) + "}";
+    return queryEngine.execute(query, id);
+}
+
+static void skipSpaces(std::string_view text, size_t &position) {
+    while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\r' ||
+                                      text[position] == '\n'))
+        position++;
+}
+
+/**
+ * Appends a Unicode code point to a string, encoded in UTF-8
+ */
+static void appendUtf8(std::string &string, unsigned int codePoint) {
+    if (codePoint < 0x80) {
+        string += (char) codePoint;
+    } else if (codePoint < 0x800) {
+        string += (char) (0xC0 | (codePoint >> 6));
+        string += (char) (0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        string += (char) (0xE0 | (codePoint >> 12));
+        string += (char) (0x80 | ((codePoint >> 6) & 0x3F));
+        string += (char) (0x80 | (codePoint & 0x3F));
+    } else {
+        string += (char) (0xF0 | (codePoint >> 18));
+        string += (char) (0x80 | ((codePoint >> 12) & 0x3F));
+        string += (char) (0x80 | ((codePoint >> 6) & 0x3F));
+        string += (char) (0x80 | (codePoint & 0x3F));
+    }
+}
+
+static bool parseHex4(std::string_view text, size_t &position, unsigned int &value) {
+    if (position + 4 > text.size()) return false;
+    value = 0;
+    for (size_t end = position + 4; position < end; position++) {
+        char c = text[position];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+/**
+ * Parses a JSON string literal starting at position, leaving position after its closing quote
+ * @return True if the literal is valid, false otherwise
+ */
+static bool parseString(std::string_view text, size_t &position, std::string &string) {
+    if (position >= text.size() || text[position] != '"') return false;
+    position++;
+    string.clear();
+    while (position < text.size()) {
+        char c = text[position++];
+        if (c == '"') return true;
+        if ((unsigned char) c < 0x20) return false;
+        if (c != '\\') {
+            string += c;
+            continue;
+        }
+        if (position >= text.size()) return false;
+        char escape = text[position++];
+        unsigned int codePoint;
+        switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                string += escape;
+                break;
+            case 'b':
+                string += '\b';
+                break;
+            case 'f':
+                string += '\f';
+                break;
+            case 'n':
+                string += '\n';
+                break;
+            case 'r':
+                string += '\r';
+                break;
+            case 't':
+                string += '\t';
+                break;
+            case 'u':
+                if (!parseHex4(text, position, codePoint)) return false;
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) { //High surrogate, must be followed by a low one
+                    unsigned int low;
+                    if (text.substr(position, 2) != "\\u") return false;
+                    position += 2;
+                    if (!parseHex4(text, position, low) || low < 0xDC00 || low >= 0xE000) return false;
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(string, codePoint);
+                break;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks if a text is a number, i.e. if it is parsed as a double as a whole. Unlike JSON, leading zeros are accepted
+ * Time Complexity: O(n), n being the length of the text
+ * @param text - Text to check
+ * @return True if the text is a number, false otherwise
+ */
+static bool isNumber(std::string_view text) {
+    //from_chars also parses "inf" and "nan", which aren't JSON numbers
+    size_t digit = !text.empty() && text.front() == '-' ? 1 : 0;
+    if (digit >= text.size() || !std::isdigit((unsigned char) text[digit])) return false;
+    double number;
+    std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), number);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+/**
+ * Parses a JSON scalar (string, number, true, false or null) starting at position
+ * @param raw - Set to the scalar's JSON text, as it appears in the request
+ * @param value - Set to the scalar's value as text: the contents of a string, or the raw text of anything else
+ * @return True if the scalar is valid, false otherwise
+ */
+static bool parseScalar(std::string_view text, size_t &position, std::string &raw, std::string &value) {
+    size_t start = position;
+    if (position < text.size() && text[position] == '"') {
+        if (!parseString(text, position, value)) return false;
+    } else {
+        while (position < text.size() && text[position] != ',' && text[position] != '}' && text[position] != ']' &&
+               text[position] != ' ' && text[position] != '\t')
+            position++;
+        value = text.substr(start, position - start);
+        if (!isNumber(value) && value != "true" && value != "false" && value != "null") return false;
+    }
+    raw = text.substr(start, position - start);
+    return true;
+}
+
+/**
+ * Parses a request, i.e. a JSON object with a "query" string, an optional "args" array of strings or numbers and an
+ * optional "id" scalar, which is echoed back in the answer. Other members are ignored as long as they are scalars
+ * Time Complexity: O(n), n being the length of the line
+ * @param line - Request line
+ * @param id - Set to the JSON text of the request's id, or null if it has none
+ * @param query - Set to the query's name followed by its arguments
+ * @param error - Set to a description of the problem if the request is malformed
+ * @return True if the request is well-formed, false otherwise
+ */
+bool QueryServer::parseRequest(std::string_view line, std::string &id, std::vector<std::string> &query,
+                               std::string &error) {
+    id = "null";
+    query.assign(1, "");
+    bool hasQuery = false;
+    size_t position = 0;
+    std::string key, raw, value;
+
+    skipSpaces(line, position);
+    if (position >= line.size() || line[position++] != '{') {
+        error = "request must be a JSON object";
+        return false;
+    }
+    skipSpaces(line, position);
+    if (position < line.size() && line[position] == '}') position++;
+    else {
+        while (true) {
+            skipSpaces(line, position);
+            if (!parseString(line, position, key)) {
+                error = "invalid member name";
+                return false;
+            }
+            skipSpaces(line, position);
+            if (position >= line.size() || line[position++] != ':') {
+                error = "expected : after " + key;
+                return false;
+            }
+            skipSpaces(line, position);
+
+            if (key == "args") {
+                if (position >= line.size() || line[position++] != '[') {
+                    error = "args must be an array";
+                    return false;
+                }
+                query.resize(1);
+                skipSpaces(line, position);
+                if (position < line.size() && line[position] == ']') position++;
+                else {
+                    while (true) {
+                        skipSpaces(line, position);
+                        if (!parseScalar(line, position, raw, value)) {
+                            error = "invalid argument";
+                            return false;
+                        }
+                        query.push_back(value);
+                        skipSpaces(line, position);
+                        if (position < line.size() && line[position] == ',') {
+                            position++;
+                            continue;
+                        }
+                        if (position < line.size() && line[position] == ']') {
+                            position++;
+                            break;
+                        }
+                        error = "expected , or ] in args";
+                        return false;
+                    }
+                }
+            } else {
+                if (!parseScalar(line, position, raw, value)) {
+                    error = "invalid value of " + key;
+                    return false;
+                }
+                if (key == "id") id = raw;
+                else if (key == "query") {
+                    if (raw.front() != '"') {
+                        error = "query must be a string";
+                        return false;
+                    }
+                    query[0] = value;
+                    hasQuery = true;
+                }
+            }
+
+            skipSpaces(line, position);
+            if (position < line.size() && line[position] == ',') {
+                position++;
+                continue;
+            }
+            if (position < line.size() && line[position] == '}') {
+                position++;
+                break;
+            }
+            error = "expected , or } in request";
+            return false;
+        }
+    }
+    skipSpaces(line, position);
+    if (position != line.size()) {
+        error = "unexpected text after request";
+        return false;
+    }
+    if (!hasQuery) {
+        error = "missing query";
+        return false;
+    }
+    return true;
+}
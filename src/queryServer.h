@@ -0,0 +1,74 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_QUERYSERVER_H
+#define RAILWAYMANAGEMENT_QUERYSERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "queryEngine.h"
+
+/**
+ * Long-lived server answering queries over a local socket, either a Unix-domain socket or a TCP port bound to the
+ * loopback interface. The protocol is line-delimited JSON: every request is a line holding an object such as
+ *   {"id": 7, "query": "max_flow", "args": ["Porto Campanhã", "Lisboa Oriente"]}
+ * and is answered with a single line, as in QueryEngine::execute. Each client is served by one of up to MAX_CLIENTS
+ * worker threads, all sharing the same read-only QueryEngine, so the network is only loaded once. Clients accepted while
+ * every worker is busy wait for one, and beyond MAX_WAITING of them are turned away
+ */
+class QueryServer {
+  private:
+    static const size_t MAX_LINE_LENGTH;
+    static const size_t MAX_CLIENTS;
+    static const size_t MAX_WAITING;
+
+    const QueryEngine &queryEngine;
+    int listener = -1;
+    std::string socketPath; // path of the Unix-domain socket, removed when the server stops
+    // guards the sockets and the workers' state below
+    std::mutex clientsMutex;
+    std::condition_variable clientWaiting;
+    std::deque<int> waiting; // sockets of the clients accepted but not yet served
+    std::unordered_set<int> clients; // sockets of the clients being served
+    std::vector<std::thread> workers;
+    size_t idleWorkers = 0;
+    bool stopping = false;
+
+    void work();
+
+    void serveClient(int client);
+
+    static bool sendAll(int client, std::string_view data);
+
+  public:
+    explicit QueryServer(const QueryEngine &queryEngine);
+
+    QueryServer(const QueryServer &) = delete;
+
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    ~QueryServer();
+
+    bool listenUnix(const std::string &path);
+
+    bool listenTcp(unsigned short port);
+
+    void run(const std::atomic<bool> &stop);
+
+    [[nodiscard]] std::string answer(std::string_view line) const;
+
+    static bool parseRequest(std::string_view line, std::string &id, std::vector<std::string> &query,
+                             std::string &error);
+};
+
+
+#endif //RAILWAYMANAGEMENT_QUERYSERVER_H
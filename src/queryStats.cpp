@@ -0,0 +1,89 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "queryStats.h"
+
+#include <iomanip>
+#include <sstream>
+
+#ifdef RAILWAY_INSTRUMENTATION
+const bool QueryStats::ENABLED = true;
+#else
+const bool QueryStats::ENABLED = false;
+#endif
+
+static const char *const PHASE_NAMES[QueryStats::NUM_PHASES] = {"max_flow", "min_cost", "failure_scan"};
+
+/**
+ * Counters of the calling thread
+ * @return Reference to the counters, valid for the lifetime of the thread
+ */
+QueryStats &QueryStats::current() {
+    thread_local QueryStats stats;
+    return stats;
+}
+
+void QueryStats::reset() {
+    *this = QueryStats();
+}
+
+/**
+ * Adds another set of counters to these
+ * @param other - Counters to add
+ */
+void QueryStats::merge(const QueryStats &other) {
+    searches += other.searches;
+    arcsScanned += other.arcsScanned;
+    augmentations += other.augmentations;
+    relaxations += other.relaxations;
+    cyclesCancelled += other.cyclesCancelled;
+    for (unsigned int i = 0; i < NUM_PHASES; i++) phaseMilliseconds[i] += other.phaseMilliseconds[i];
+}
+
+/**
+ * Checks if no work was counted
+ * @return True if every counter is zero, false otherwise
+ */
+bool QueryStats::empty() const {
+    if (searches || arcsScanned || augmentations || relaxations || cyclesCancelled) return false;
+    for (double milliseconds: phaseMilliseconds)
+        if (milliseconds > 0) return false;
+    return true;
+}
+
+/**
+ * Describes the counters as a JSON object
+ * @return JSON object with every counter, and the time of each phase in milliseconds
+ */
+std::string QueryStats::toJson() const {
+    std::ostringstream json;
+    json << "{\"searches\":" << searches << ",\"arcs_scanned\":" << arcsScanned << ",\"augmentations\":"
+         << augmentations << ",\"relaxations\":" << relaxations << ",\"cycles_cancelled\":" << cyclesCancelled
+         << ",\"phase_ms\":{" << std::fixed << std::setprecision(3);
+    for (unsigned int i = 0; i < NUM_PHASES; i++)
+        json << (i ? "," : "") << '"' << PHASE_NAMES[i] << "\":" << phaseMilliseconds[i];
+    json << "}}";
+    return json.str();
+}
+
+/**
+ * Prints a one-line summary of the counters, leaving out phases that didn't run
+ * @param out - Stream where the summary is written
+ */
+void QueryStats::print(std::ostream &out) const {
+    std::ostringstream line;
+    line << "[stats] " << searches << " searches, " << arcsScanned << " arcs scanned, " << augmentations
+         << " augmentations, " << relaxations << " relaxations, " << cyclesCancelled << " cycles cancelled"
+         << std::fixed << std::setprecision(3);
+    for (unsigned int i = 0; i < NUM_PHASES; i++)
+        if (phaseMilliseconds[i] > 0) line << ", " << PHASE_NAMES[i] << " " << phaseMilliseconds[i] << " ms";
+    out << line.str() << std::endl;
+}
+
+QueryPhaseTimer::QueryPhaseTimer(QueryPhase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+
+QueryPhaseTimer::~QueryPhaseTimer() {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    QueryStats::current().phaseMilliseconds[(unsigned int) phase] += elapsed.count();
+}
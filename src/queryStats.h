@@ -0,0 +1,76 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_QUERYSTATS_H
+#define RAILWAYMANAGEMENT_QUERYSTATS_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * Phases of a query whose wall time is measured. Phases may nest (a min-cost query runs a max flow first), in which
+ * case the outer phase's time includes the inner one's
+ */
+enum class QueryPhase : unsigned int {
+    MAX_FLOW, MIN_COST, FAILURE_SCAN
+};
+
+/**
+ * Counters of the work done by the flow algorithms during a query, kept per thread. Work done by the workers of
+ * parallelFor is added to the counters of the thread that called it, so a parallel query's times are the sum over its
+ * threads. The counters only exist if the project is built with RAILWAY_INSTRUMENTATION (the CMake option of the same
+ * name); otherwise the QUERY_STATS macros compile to nothing and the counters stay at zero
+ */
+struct QueryStats {
+    static const unsigned int NUM_PHASES = 3;
+    static const bool ENABLED;
+
+    unsigned long long searches = 0; // searches for an augmenting path (BFS, Bellman-Ford)
+    unsigned long long arcsScanned = 0; // arcs examined by those searches
+    unsigned long long augmentations = 0; // augmenting paths applied
+    unsigned long long relaxations = 0; // distance labels improved by shortest path searches
+    unsigned long long cyclesCancelled = 0; // negative cycles cancelled by cycle-cancelling min cost flow
+    double phaseMilliseconds[NUM_PHASES] = {};
+
+    static QueryStats &current();
+
+    void reset();
+
+    void merge(const QueryStats &other);
+
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] std::string toJson() const;
+
+    void print(std::ostream &out) const;
+};
+
+/**
+ * Adds the wall time of its own lifetime to a phase of the current thread's QueryStats
+ */
+class QueryPhaseTimer {
+  private:
+    QueryPhase phase;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    explicit QueryPhaseTimer(QueryPhase phase);
+
+    QueryPhaseTimer(const QueryPhaseTimer &) = delete;
+
+    QueryPhaseTimer &operator=(const QueryPhaseTimer &) = delete;
+
+    ~QueryPhaseTimer();
+};
+
+#ifdef RAILWAY_INSTRUMENTATION
+#define QUERY_STATS_ADD(counter, value) (QueryStats::current().counter += (value))
+#define QUERY_STATS_PHASE(phase) QueryPhaseTimer queryPhaseTimer(phase)
+#else
+#define QUERY_STATS_ADD(counter, value) ((void) 0)
+#define QUERY_STATS_PHASE(phase) ((void) 0)
+#endif
+
+#endif //RAILWAYMANAGEMENT_QUERYSTATS_H
@@ -0,0 +1,31 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_RAILWAYMANAGEMENT_H
+#define RAILWAYMANAGEMENT_RAILWAYMANAGEMENT_H
+
+/**
+ * Public header of the railway management library. A typical client loads a network and queries it:
+ *   RailwayNetwork network("stations.csv", "network.csv");
+ *   network.load();
+ *   QueryEngine queryEngine(network.getDataRepository(), network.getFlowNetwork(), &network.getWidestPathTree(),
+ *                           &network.getContractionHierarchy(RouteMetric::COST),
+ *                           &network.getContractionHierarchy(RouteMetric::HOPS));
+ *   std::cout << queryEngine.execute({"max_flow", "Porto Campanhã", "Lisboa Oriente"}, "1") << std::endl;
+ * The flow engines (Graph, ContractedGraph, BridgeDecomposition, FlowNetwork and WidestPathTree) and the route engine
+ * (ContractionHierarchy) are also available directly, through the RailwayNetwork's getters. Only FlowNetwork,
+ * WidestPathTree, ContractionHierarchy and QueryEngine may be queried from several threads at once.
+ * NetworkGenerator writes synthetic networks of any size in the same CSV format, and MetricsExporter publishes the
+ * latency of the operations (see OperationMetrics) for monitoring
+ */
+
+#include "railwayNetwork.h"
+#include "queryEngine.h"
+#include "queryServer.h"
+#include "networkGenerator.h"
+#include "queryStats.h"
+#include "metricsExporter.h"
+#include "memoryAccounting.h"
+
+#endif //RAILWAYMANAGEMENT_RAILWAYMANAGEMENT_H
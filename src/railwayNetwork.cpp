@@ -0,0 +1,440 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "railwayNetwork.h"
+#include "csvReader.h"
+#include "parallel.h"
+
+#include <charconv>
+#include <filesystem>
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * Creates an empty network, to be loaded from the given CSV files. Its binary snapshot is kept next to the network file,
+ * with the .snapshot extension
+ * @param stationsFilePath - Path of the stations file
+ * @param networkFilePath - Path of the network file
+ */
+RailwayNetwork::RailwayNetwork(string stationsFilePath, string networkFilePath) : stationsFilePath(
+        std::move(stationsFilePath)), networkFilePath(std::move(networkFilePath)) {
+    snapshotFilePath = filesystem::path(this->networkFilePath).replace_extension(".snapshot").string();
+}
+
+/**
+ * Changes where the binary snapshot of the network is kept, before loading it
+ * @param path - Path of the snapshot, or empty to always parse the CSV files and never write a snapshot
+ */
+void RailwayNetwork::setSnapshotFilePath(std::string path) {
+    snapshotFilePath = std::move(path);
+}
+
+DataRepository &RailwayNetwork::getDataRepository() {
+    return dataRepository;
+}
+
+Graph &RailwayNetwork::getGraph() {
+    return graph;
+}
+
+Graph &RailwayNetwork::getResidualGraph() {
+    return residualGraph;
+}
+
+ContractedGraph &RailwayNetwork::getContractedGraph() {
+    return contractedGraph;
+}
+
+BridgeDecomposition &RailwayNetwork::getBridgeDecomposition() {
+    return bridgeDecomposition;
+}
+
+const FlowNetwork &RailwayNetwork::getFlowNetwork() const {
+    return flowNetwork;
+}
+
+const WidestPathTree &RailwayNetwork::getWidestPathTree() const {
+    return widestPathTree;
+}
+
+const ContractionHierarchy &RailwayNetwork::getContractionHierarchy(RouteMetric metric) const {
+    return metric == RouteMetric::COST ? costHierarchy : hopHierarchy;
+}
+
+/**
+ * Loads the network and builds the auxiliary structures used by the queries, loading the binary snapshot of the network
+ * if it was written from CSV files of the same sizes and modification times as the current ones, and parsing the CSV
+ * files (and writing a new snapshot) otherwise
+ * Time Complexity: O(n+v) (average case), where n is the number of lines of network.csv and v is the number of lines in
+ * stations.csv
+ * @param report - Stream where the load report is written
+ */
+void RailwayNetwork::load(ostream &report) {
+    auto start = chrono::steady_clock::now();
+    array<SnapshotSource, NetworkSnapshot::NUM_SOURCES> sources{};
+    bool sourcesFound = NetworkSnapshot::describeSource(stationsFilePath, sources[0]) &&
+                        NetworkSnapshot::describeSource(networkFilePath, sources[1]);
+    bool fromSnapshot = sourcesFound && loadSnapshot(sources);
+    unsigned int skippedRails = 0;
+    if (!fromSnapshot) {
+        extractStationsFile();
+        skippedRails = extractNetworkFile();
+    }
+    if (!fromSnapshot) preprocessNetwork();
+    chrono::duration<double, milli> loadTime = chrono::steady_clock::now() - start;
+    ostringstream time;
+    time << fixed << setprecision(1) << loadTime.count();
+    report << "Loaded " << graph.getNumVertex() << " stations and " << graph.getTotalEdges() << " rails from "
+           << (fromSnapshot ? "the network snapshot" : "the CSV files") << " in " << time.str() << " ms" << endl;
+    if (skippedRails > 0)
+        report << "Skipped " << skippedRails << " invalid line(s) of the network file" << endl;
+    if (!fromSnapshot && sourcesFound && !snapshotFilePath.empty()) //Best effort, the next launch parses again
+        NetworkSnapshot::write(snapshotFilePath, sources, graph, dataRepository, flowNetwork, bridgeDecomposition);
+}
+
+/**
+ * Loads the network from the binary snapshot, as long as it was written from the current CSV files. Its stations are
+ * resolved to the Vertices of both graphs once, so its rails are added without any lookup by name. The groupings, the
+ * FlowNetwork and the BridgeDecomposition are built from the index arrays of the snapshot, and the rest of the
+ * structures like in preprocessNetwork
+ * Time Complexity: O(n+v) (average case) plus the building of the ContractedGraph and the WidestPathTree, where n is
+ * the number of rails and v the number of stations
+ * @param sources - Stations file and network file, as described by NetworkSnapshot::describeSource
+ * @return True if the network was loaded, false if the snapshot is disabled, missing, outdated or invalid
+ */
+bool RailwayNetwork::loadSnapshot(const array<SnapshotSource, NetworkSnapshot::NUM_SOURCES> &sources) {
+    if (snapshotFilePath.empty()) return false;
+    NetworkSnapshot snapshot(snapshotFilePath);
+    if (!snapshot.isValid() || !snapshot.matchesSources(sources)) return false;
+
+    vector<Vertex *> vertices(snapshot.getNumStations());
+    vector<Vertex *> residualVertices(snapshot.getNumStations());
+    for (uint32_t i = 0; i < snapshot.getNumStations(); i++) {
+        const SnapshotStation &station = snapshot.getStation(i);
+        string name(snapshot.getString(station.name));
+        addStation(name, string(snapshot.getString(station.district)),
+                   string(snapshot.getString(station.municipality)), string(snapshot.getString(station.township)),
+                   string(snapshot.getString(station.line)));
+        vertices[i] = graph.findVertex(name);
+        residualVertices[i] = residualGraph.findVertex(name);
+    }
+    vector<Edge *> edges(2 * (size_t) snapshot.getNumRails());
+    for (uint32_t i = 0; i < snapshot.getNumRails(); i++) {
+        const SnapshotRail &rail = snapshot.getRail(i);
+        auto regular = graph.addAndGetBidirectionalEdge(vertices[rail.source], vertices[rail.target], rail.capacity,
+                                                        (Service) rail.service);
+        linkResidualEdges(regular, residualGraph.addAndGetBidirectionalEdge(residualVertices[rail.source],
+                                                                            residualVertices[rail.target],
+                                                                            rail.capacity, (Service) rail.service));
+        edges[2 * i] = regular.first;
+        edges[2 * i + 1] = regular.second;
+    }
+
+    dataRepository.loadGroupings(snapshot);
+    contractedGraph.build(graph);
+    bridgeDecomposition.build(graph, snapshot, vertices, edges);
+    flowNetwork = FlowNetwork(snapshot, edges);
+    widestPathTree.build(flowNetwork);
+    resetRouteHierarchies();
+    return true;
+}
+
+/**
+ * Extracts and stores the information of stations.csv
+ * Time Complexity: 0(n) (average case) | O(n²) (worst case), where n is the number of lines of stations.csv
+ */
+void RailwayNetwork::extractStationsFile() {
+    CsvReader stations(stationsFilePath);
+    vector<string_view> fields;
+
+    stations.nextRecord(fields); //Ignore first line with just descriptors
+
+    while (stations.nextRecord(fields)) {
+        if (fields.size() < 5) continue;
+        addStation(string(fields[0]), string(fields[1]), string(fields[2]), string(fields[3]), string(fields[4]));
+    }
+}
+
+/**
+ * Extracts and stores the information of network.csv. Large files are split into chunks of whole lines, parsed by
+ * several threads into separate buffers of rails whose station names are already resolved to indexes, and the rails of
+ * all the buffers are then added to the graphs in file order, without any further lookup by name. Lines with too few
+ * fields, an unknown station or a capacity that isn't a valid number are skipped
+ * Time Complexity: O(n/t + n) (average case), where n is the number of lines of network.csv and t the number of threads
+ * @return Number of lines skipped
+ */
+unsigned int RailwayNetwork::extractNetworkFile() {
+    struct ParsedRail {
+        unsigned int source;
+        unsigned int target;
+        unsigned int capacity;
+        Service service;
+    };
+    const size_t MIN_CHUNK_SIZE = 1 << 20; //Smaller files aren't worth the threads
+
+    CsvReader network(networkFilePath);
+    if (!network.isOpen()) return 0;
+    vector<string_view> fields;
+
+    network.nextRecord(fields); //Ignore first line with just descriptors
+
+    size_t start = min(network.getPosition(), network.getSize());
+    const char *body = network.getData() + start;
+    size_t length = network.getSize() - start;
+    auto threads = (unsigned int) min<size_t>(defaultThreadCount(), length / MIN_CHUNK_SIZE + 1);
+    vector<pair<size_t, size_t>> chunks = CsvReader::splitRecords(body, length, threads);
+
+    vector<Vertex *> vertices = graph.getVertexSet();
+    vector<Vertex *> residualVertices;
+    vector<string> names;
+    unordered_map<string_view, unsigned int> nameToIndex;
+    names.reserve(vertices.size());
+    for (Vertex const *v: vertices) {
+        names.push_back(v->getId());
+        residualVertices.push_back(residualGraph.findVertex(names.back()));
+    }
+    for (unsigned int i = 0; i < names.size(); i++) nameToIndex.emplace(names[i], i);
+
+    vector<vector<ParsedRail>> buffers(chunks.size());
+    vector<unsigned int> skipped(chunks.size(), 0);
+    parallelFor(chunks.size(), [&](size_t chunk, unsigned int) {
+        CsvReader reader(body + chunks[chunk].first, chunks[chunk].second - chunks[chunk].first);
+        vector<string_view> rail;
+        while (reader.nextRecord(rail)) {
+            if (rail.size() < 4) {
+                skipped[chunk]++;
+                continue;
+            }
+            auto source = nameToIndex.find(rail[0]);
+            auto target = nameToIndex.find(rail[1]);
+            unsigned int capacity = 0;
+            auto [end, error] = from_chars(rail[2].data(), rail[2].data() + rail[2].size(), capacity);
+            if (source == nameToIndex.end() || target == nameToIndex.end() || error != errc() ||
+                end != rail[2].data() + rail[2].size()) {
+                skipped[chunk]++;
+                continue;
+            }
+            Service service = rail[3] == "STANDARD" ? Service::STANDARD : Service::ALFA_PENDULAR;
+            buffers[chunk].push_back({source->second, target->second, capacity, service});
+        }
+    }, threads);
+
+    for (const vector<ParsedRail> &buffer: buffers) {
+        for (const ParsedRail &rail: buffer) {
+            if (residualVertices[rail.source] == nullptr || residualVertices[rail.target] == nullptr) continue;
+            linkResidualEdges(
+                    graph.addAndGetBidirectionalEdge(vertices[rail.source], vertices[rail.target], rail.capacity,
+                                                     rail.service),
+                    residualGraph.addAndGetBidirectionalEdge(residualVertices[rail.source],
+                                                             residualVertices[rail.target], rail.capacity,
+                                                             rail.service));
+        }
+    }
+    return accumulate(skipped.begin(), skipped.end(), 0u);
+}
+
+/**
+ * Adds a station to both graphs and to the data repository, unless a station with the same name already exists
+ * Time Complexity: O(1) (average case)
+ * @param name - Name of the station
+ * @param district - District of the station
+ * @param municipality - Municipality of the station
+ * @param township - Township of the station
+ * @param line - Line of the station
+ */
+void RailwayNetwork::addStation(const string &name, const string &district, const string &municipality,
+                                const string &township, const string &line) {
+    if (!graph.addVertex(name)) return;
+    if (!residualGraph.addVertex(name)) return;
+    dataRepository.addStationEntry(name, district, municipality, township, line);
+}
+
+/**
+ * Adds a rail to the graph and to the residual graph, linking each of its edges to the corresponding residual edge
+ * Time Complexity: O(1) (average case)
+ * @param source - Name of one of the stations of the rail
+ * @param target - Name of the other station of the rail
+ * @param capacity - Capacity of the rail
+ * @param service - Service of the rail
+ * @return Pointer to the new Edge from source to target, or nullptr if either station doesn't exist
+ */
+Edge *RailwayNetwork::addRail(const string &source, const string &target, unsigned int capacity, Service service) {
+    auto regular = graph.addAndGetBidirectionalEdge(source, target, capacity, service);
+    if (regular.first == nullptr) return nullptr; //Unknown station
+    linkResidualEdges(regular, residualGraph.addAndGetBidirectionalEdge(source, target, capacity, service));
+    return regular.first;
+}
+
+/**
+ * Links the two edges of a rail of the graph to the corresponding edges of the residual graph, and vice versa
+ * Time Complexity: O(1)
+ * @param regular - Pair containing the Edge of the graph and its reverse
+ * @param residual - Pair containing the Edge of the residual graph and its reverse
+ */
+void RailwayNetwork::linkResidualEdges(pair<Edge *, Edge *> regular, pair<Edge *, Edge *> residual) {
+    regular.first->setCorrespondingEdge(residual.first);
+    regular.second->setCorrespondingEdge(residual.second);
+    residual.first->setCorrespondingEdge(regular.first);
+    residual.second->setCorrespondingEdge(regular.second);
+}
+
+/**
+ * Builds the auxiliary structures derived from the loaded network, used to speed up the queries. The
+ * ContractionHierarchy of each RouteMetric is only built by its first route query, as few sessions need one
+ * Time Complexity: O(|E| log |E| + |V| log |V|)
+ */
+void RailwayNetwork::preprocessNetwork() {
+    dataRepository.buildGroupings();
+    contractedGraph.build(graph);
+    bridgeDecomposition.build(graph);
+    flowNetwork = FlowNetwork(graph);
+    widestPathTree.build(flowNetwork);
+    resetRouteHierarchies();
+}
+
+/**
+ * Discards the ContractionHierarchy of each RouteMetric, to be built from the FlowNetwork by its next route query
+ * Time Complexity: O(1)
+ */
+void RailwayNetwork::resetRouteHierarchies() {
+    costHierarchy.buildLazily(flowNetwork, RouteMetric::COST);
+    hopHierarchy.buildLazily(flowNetwork, RouteMetric::HOPS);
+}
+
+/**
+ * Applies a file of changes to the loaded network, without rereading its CSV files. Each line of the file is one
+ * change:
+ *   ADD_STATION,name,district,municipality,township,line
+ *   ADD_RAIL,station A,station B,capacity,service
+ *   UPDATE_RAIL,station A,station B,capacity,service
+ *   REMOVE_RAIL,station A,station B
+ * UPDATE_RAIL and REMOVE_RAIL apply to every rail between the two stations. The graph, the residual graph, the data
+ * repository, the ContractedGraph and the BridgeDecomposition are patched in place, change by change (see applyDelta).
+ * The groupings are rebuilt only if stations were added. Stations added without rails and changes to capacities and
+ * services are also patched into the FlowNetwork, whereas adding or removing rails rebuilds it. The WidestPathTree is
+ * rebuilt and the ContractionHierarchy of each RouteMetric is left to the next route query if any rail changed
+ * Time Complexity: O(c) plus the patching of each change and the preprocessing of the rebuilt structures, c being the
+ * number of changes
+ * @param path - Path of the file of changes
+ * @return Pair containing the number of changes applied and the number of invalid lines skipped
+ */
+pair<unsigned int, unsigned int> RailwayNetwork::applyDeltaFile(const string &path) {
+    CsvReader changes(path);
+    vector<string_view> fields;
+    vector<Edge *> updatedRails;
+    vector<string> addedStations;
+    bool railsChanged = false;
+    pair<unsigned int, unsigned int> result = {0, 0};
+
+    while (changes.nextRecord(fields)) {
+        if (applyDelta(fields, updatedRails, addedStations, railsChanged)) result.first++;
+        else result.second++;
+    }
+
+    if (!addedStations.empty()) dataRepository.buildGroupings();
+    if (railsChanged) {
+        flowNetwork = FlowNetwork(graph);
+    } else {
+        for (const string &station: addedStations) flowNetwork.addStation(station);
+        for (Edge *rail: updatedRails) {
+            flowNetwork.setRailCapacity(flowNetwork.findRail(rail), rail->getCapacity());
+            flowNetwork.setRailCost(flowNetwork.findRail(rail), rail->getCost());
+        }
+    }
+    if (railsChanged || !updatedRails.empty()) {
+        widestPathTree.build(flowNetwork);
+        resetRouteHierarchies();
+    }
+    return result;
+}
+
+/**
+ * Applies a single change to the graph, the residual graph and the data repository, and patches it into the
+ * ContractedGraph and the BridgeDecomposition: only the chains of the stations of a rail are split, and only the
+ * 2-edge-connected components on its bridge tree route are regrouped
+ * Time Complexity: O(deg(A) + deg(B)) (average case) plus the patching (see ContractedGraph::addRail and
+ * BridgeDecomposition::addRail/removeRail), A and B being the stations of the change
+ * @param fields - Fields of the change, as described in applyDeltaFile
+ * @param updatedRails - Vector where the Edges whose capacity or service changed are added
+ * @param addedStations - Vector where the names of the added stations are added
+ * @param railsChanged - Set to true if a rail was added or removed
+ * @return True if the change was valid and applied, false otherwise
+ */
+bool RailwayNetwork::applyDelta(const vector<string_view> &fields, vector<Edge *> &updatedRails,
+                                vector<string> &addedStations, bool &railsChanged) {
+    if (fields.empty()) return false;
+    string_view operation = fields[0];
+
+    if (operation == "ADD_STATION") {
+        if (fields.size() < 6 || graph.findVertex(string(fields[1])) != nullptr) return false;
+        string name(fields[1]);
+        addStation(name, string(fields[2]), string(fields[3]), string(fields[4]), string(fields[5]));
+        contractedGraph.addStation(name);
+        bridgeDecomposition.addStation(graph.findVertex(name));
+        addedStations.push_back(name);
+        return true;
+    }
+
+    if (fields.size() < 3) return false;
+    string source(fields[1]);
+    string target(fields[2]);
+    Vertex *sourceVertex = graph.findVertex(source);
+    Vertex *targetVertex = graph.findVertex(target);
+    if (sourceVertex == nullptr || targetVertex == nullptr || sourceVertex == targetVertex) return false;
+
+    if (operation == "REMOVE_RAIL") {
+        vector<Edge *> rails;
+        for (Edge *e: sourceVertex->getAdj()) {
+            if (e->getDest() == targetVertex) rails.push_back(e);
+        }
+        if (rails.empty()) return false;
+        updatedRails.erase(remove_if(updatedRails.begin(), updatedRails.end(), [&](const Edge *e) {
+            return (e->getOrig() == sourceVertex && e->getDest() == targetVertex) ||
+                   (e->getOrig() == targetVertex && e->getDest() == sourceVertex);
+        }), updatedRails.end());
+        for (Edge *rail: rails) { //One at a time, so that parallel rails are handled correctly
+            contractedGraph.removeRail(rail);
+            bridgeDecomposition.removeRail(rail);
+            residualGraph.removeBidirectionalEdge(rail->getCorrespondingEdge());
+            graph.removeBidirectionalEdge(rail);
+        }
+        railsChanged = true;
+        return true;
+    }
+
+    if (fields.size() < 5) return false;
+    unsigned int capacity = 0;
+    auto [end, error] = from_chars(fields[3].data(), fields[3].data() + fields[3].size(), capacity);
+    if (error != errc() || end != fields[3].data() + fields[3].size()) return false;
+    Service service = fields[4] == "STANDARD" ? Service::STANDARD : Service::ALFA_PENDULAR;
+
+    if (operation == "ADD_RAIL") {
+        Edge *rail = addRail(source, target, capacity, service);
+        contractedGraph.addRail(rail);
+        bridgeDecomposition.addRail(rail);
+        railsChanged = true;
+        return true;
+    }
+
+    if (operation == "UPDATE_RAIL") {
+        bool found = false;
+        for (Edge *e: sourceVertex->getAdj()) {
+            if (e->getDest() != targetVertex) continue;
+            for (Edge *edge: {e, e->getReverse(), e->getCorrespondingEdge(), e->getReverse()->getCorrespondingEdge()}) {
+                edge->setCapacity(capacity);
+                edge->setService(service);
+                edge->initializeCost();
+            }
+            contractedGraph.updateRail(e);
+            updatedRails.push_back(e);
+            found = true;
+        }
+        return found;
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_RAILWAYNETWORK_H
+#define RAILWAYMANAGEMENT_RAILWAYNETWORK_H
+
+#include <array>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graph.h"
+#include "dataRepository.h"
+#include "contractedGraph.h"
+#include "bridgeDecomposition.h"
+#include "flowNetwork.h"
+#include "widestPathTree.h"
+#include "contractionHierarchy.h"
+#include "networkSnapshot.h"
+
+/**
+ * A railway network loaded from its CSV files (or from their binary snapshot), together with the auxiliary structures
+ * derived from it to speed up the queries. It owns every structure the queries run on, so the interactive menu, the
+ * batch and server modes and any other client share the same loading code
+ */
+class RailwayNetwork {
+  private:
+    DataRepository dataRepository;
+    Graph residualGraph;
+    Graph graph;
+    ContractedGraph contractedGraph;
+    BridgeDecomposition bridgeDecomposition;
+    FlowNetwork flowNetwork;
+    WidestPathTree widestPathTree;
+    ContractionHierarchy costHierarchy;
+    ContractionHierarchy hopHierarchy;
+    std::string stationsFilePath;
+    std::string networkFilePath;
+    std::string snapshotFilePath;
+
+    void extractStationsFile();
+
+    unsigned int extractNetworkFile();
+
+    bool loadSnapshot(const std::array<SnapshotSource, NetworkSnapshot::NUM_SOURCES> &sources);
+
+    void resetRouteHierarchies();
+
+    void addStation(const std::string &name, const std::string &district, const std::string &municipality,
+                    const std::string &township, const std::string &line);
+
+    Edge *addRail(const std::string &source, const std::string &target, unsigned int capacity, Service service);
+
+    static void linkResidualEdges(std::pair<Edge *, Edge *> regular, std::pair<Edge *, Edge *> residual);
+
+    bool applyDelta(const std::vector<std::string_view> &fields, std::vector<Edge *> &updatedRails,
+                    std::vector<std::string> &addedStations, bool &railsChanged);
+
+  public:
+    explicit RailwayNetwork(std::string stationsFilePath = "../dataset/stations.csv",
+                            std::string networkFilePath = "../dataset/network.csv");
+
+    void setSnapshotFilePath(std::string path);
+
+    void load(std::ostream &report = std::cout);
+
+    void preprocessNetwork();
+
+    std::pair<unsigned int, unsigned int> applyDeltaFile(const std::string &path);
+
+    DataRepository &getDataRepository();
+
+    Graph &getGraph();
+
+    Graph &getResidualGraph();
+
+    ContractedGraph &getContractedGraph();
+
+    BridgeDecomposition &getBridgeDecomposition();
+
+    [[nodiscard]] const FlowNetwork &getFlowNetwork() const;
+
+    [[nodiscard]] const WidestPathTree &getWidestPathTree() const;
+
+    [[nodiscard]] const ContractionHierarchy &getContractionHierarchy(RouteMetric metric) const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_RAILWAYNETWORK_H
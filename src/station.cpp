@@ -2,68 +2,51 @@
 // Created by rita on 28-02-2023.
 //
 
-#include <utility>
 #include "station.h"
 
 Station::Station() = default;
 
-Station::Station(std::string name, std::string district, std::string municipality,
-                 std::string township,
-                 std::string line) : name(std::move(name)), district(std::move(district)), municipality(std::move(municipality)),
-                                            township(std::move(township)), line(std::move(line)) {}
-
-Station::Station(std::string name) : name(std::move(name)) {}
+Station::Station(Symbol name, Symbol district, Symbol municipality, Symbol township, Symbol line)
+        : name(name), district(district), municipality(municipality), township(township), line(line) {}
 
 //Getters
 
-const std::string &Station::getName() const {
+Symbol Station::getName() const {
     return name;
 }
 
-const std::string &Station::getDistrict() const {
+Symbol Station::getDistrict() const {
     return district;
 }
 
-const std::string &Station::getMunicipality() const {
+Symbol Station::getMunicipality() const {
     return municipality;
 }
 
-const std::string &Station::getTownship() const {
+Symbol Station::getTownship() const {
     return township;
 }
 
-const std::string &Station::getLine() const {
+Symbol Station::getLine() const {
     return line;
 }
 
-void Station::setName(const std::string &name) {
+void Station::setName(Symbol name) {
     Station::name = name;
 }
 
-void Station::setDistrict(const std::string &district) {
+void Station::setDistrict(Symbol district) {
     Station::district = district;
 }
 
-void Station::setMunicipality(const std::string &municipality) {
+void Station::setMunicipality(Symbol municipality) {
     Station::municipality = municipality;
 }
 
-void Station::setTownship(const std::string &township) {
+void Station::setTownship(Symbol township) {
     Station::township = township;
 }
 
-void Station::setLine(const std::string &line) {
+void Station::setLine(Symbol line) {
     Station::line = line;
 }
-
-Station &Station::operator=(const Station &station) {
-    this->name = station.name;
-    this->district = station.district;
-    this->municipality = station.municipality;
-    this->line = station.line;
-    return *this;
-}
-
-
-
-
@@ -9,62 +9,44 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "symbolTable.h"
+
+/**
+ * Station of the network. Its attributes are Symbols of the DataRepository's symbol table, so a Station is a handful of
+ * integers and stations of the same district, municipality, township or line hold the same Symbol
+ */
 class Station {
 private:
-    std::string name;
-    std::string district;
-    std::string municipality;
-    std::string township;
-    std::string line;
+    Symbol name = 0;
+    Symbol district = 0;
+    Symbol municipality = 0;
+    Symbol township = 0;
+    Symbol line = 0;
 public:
     Station();
 
-    Station(std::string name, std::string district, std::string municipality,
-            std::string township,
-            std::string line);
-
-    explicit Station(std::string name);
-
-    [[nodiscard]] const std::string &getName() const;
-
-    [[nodiscard]] const std::string &getDistrict() const;
-
-    [[nodiscard]] const std::string &getMunicipality() const;
+    Station(Symbol name, Symbol district, Symbol municipality, Symbol township, Symbol line);
 
-    [[nodiscard]] const std::string &getTownship() const;
+    [[nodiscard]] Symbol getName() const;
 
-    [[nodiscard]] const std::string &getLine() const;
+    [[nodiscard]] Symbol getDistrict() const;
 
-    void setName(const std::string &name);
+    [[nodiscard]] Symbol getMunicipality() const;
 
-    void setDistrict(const std::string &district);
+    [[nodiscard]] Symbol getTownship() const;
 
-    void setMunicipality(const std::string &municipality);
+    [[nodiscard]] Symbol getLine() const;
 
-    void setTownship(const std::string &township);
+    void setName(Symbol name);
 
-    void setLine(const std::string &line);
-
-    Station &operator=(const Station &station);
-};
+    void setDistrict(Symbol district);
 
+    void setMunicipality(Symbol municipality);
 
-struct StationHash {
-    std::size_t operator()(const Station &Station) const {
-        return std::hash<std::string>()(Station.getName());
-    }
-};
+    void setTownship(Symbol township);
 
-struct StationEquals {
-    bool operator()(const Station &Station1, const Station &Station2) const {
-        return Station1.getName() == Station2.getName();
-    }
+    void setLine(Symbol line);
 };
 
-typedef std::unordered_set<Station, StationHash, StationEquals> stationTable;
-
-template<typename T>
-using StationMap = std::unordered_map<Station, T, StationHash, StationEquals>;
-
 
 #endif //RAILWAYMANAGEMENT_STATION_H
@@ -0,0 +1,83 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "symbolTable.h"
+
+const Symbol SymbolTable::NOT_FOUND = (Symbol) -1;
+
+SymbolTable::SymbolTable() = default;
+
+SymbolTable::SymbolTable(const SymbolTable &other) {
+    *this = other;
+}
+
+SymbolTable::~SymbolTable() {
+    accountStrings(false);
+}
+
+/**
+ * Accounts the memory of the strings whose contents don't fit in the string itself (see MemoryAccounting)
+ * Time Complexity: O(n), n being the number of strings
+ * @param allocate - True if the strings were just stored, false if they are about to be discarded
+ */
+void SymbolTable::accountStrings(bool allocate) const {
+    for (const std::string &string: strings) {
+        size_t bytes = MemoryAccounting::stringBytes(string);
+        if (bytes == 0) continue;
+        if (allocate) MemoryAccounting::allocated(MemoryCategory::SYMBOLS, bytes);
+        else MemoryAccounting::released(MemoryCategory::SYMBOLS, bytes);
+    }
+}
+
+/**
+ * Copies another table, rebuilding the index so that it refers to this table's own strings
+ * Time Complexity: O(n), n being the total length of the strings
+ * @param other - Table to copy
+ * @return This table
+ */
+SymbolTable &SymbolTable::operator=(const SymbolTable &other) {
+    if (this == &other) return *this;
+    accountStrings(false);
+    strings = other.strings;
+    accountStrings(true);
+    stringToSymbol.clear();
+    for (Symbol symbol = 0; symbol < strings.size(); symbol++) stringToSymbol.emplace(strings[symbol], symbol);
+    return *this;
+}
+
+/**
+ * Finds the Symbol of a string, adding the string to the table if it isn't there yet
+ * Time Complexity: O(n) (average case), n being the length of the string
+ * @param string - String to intern
+ * @return Symbol of the string
+ */
+Symbol SymbolTable::intern(std::string_view string) {
+    auto it = stringToSymbol.find(string);
+    if (it != stringToSymbol.end()) return it->second;
+    auto symbol = (Symbol) strings.size();
+    strings.emplace_back(string);
+    if (size_t bytes = MemoryAccounting::stringBytes(strings.back()))
+        MemoryAccounting::allocated(MemoryCategory::SYMBOLS, bytes);
+    stringToSymbol.emplace(strings.back(), symbol);
+    return symbol;
+}
+
+/**
+ * Finds the Symbol of a string, without adding it to the table
+ * Time Complexity: O(n) (average case), n being the length of the string
+ * @param string - String to find
+ * @return Symbol of the string, or NOT_FOUND if it was never interned
+ */
+Symbol SymbolTable::find(std::string_view string) const {
+    auto it = stringToSymbol.find(string);
+    return it == stringToSymbol.end() ? NOT_FOUND : it->second;
+}
+
+const std::string &SymbolTable::getString(Symbol symbol) const {
+    return strings[symbol];
+}
+
+unsigned int SymbolTable::size() const {
+    return (unsigned int) strings.size();
+}
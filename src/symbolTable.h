@@ -0,0 +1,50 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_SYMBOLTABLE_H
+#define RAILWAYMANAGEMENT_SYMBOLTABLE_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+
+#include "memoryAccounting.h"
+
+typedef unsigned int Symbol;
+
+/**
+ * Table of interned strings. Every distinct string is stored once and identified by a small integer Symbol, so equal
+ * strings can be compared, hashed and stored as integers
+ */
+class SymbolTable {
+  private:
+    // indexed by Symbol, never reallocated so the views below stay valid
+    std::deque<std::string, CountingAllocator<std::string, MemoryCategory::SYMBOLS>> strings;
+    CountedMap<std::string_view, Symbol, MemoryCategory::SYMBOLS> stringToSymbol;
+
+    void accountStrings(bool allocate) const;
+
+  public:
+    static const Symbol NOT_FOUND;
+
+    SymbolTable();
+
+    SymbolTable(const SymbolTable &other);
+
+    SymbolTable &operator=(const SymbolTable &other);
+
+    ~SymbolTable();
+
+    Symbol intern(std::string_view string);
+
+    [[nodiscard]] Symbol find(std::string_view string) const;
+
+    [[nodiscard]] const std::string &getString(Symbol symbol) const;
+
+    [[nodiscard]] unsigned int size() const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_SYMBOLTABLE_H
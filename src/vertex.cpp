@@ -6,7 +6,42 @@
 
 #include <utility>
 
-Vertex::Vertex(std::string id) : id(std::move(id)) {}
+/**
+ * Accounts the memory of an id whose contents don't fit in the string itself (see MemoryAccounting)
+ * @param id - Id of a Vertex
+ * @param allocate - True if the id was just stored, false if it is about to be discarded
+ */
+static void accountId(const std::string &id, bool allocate) {
+    size_t bytes = MemoryAccounting::stringBytes(id);
+    if (bytes == 0) return;
+    if (allocate) MemoryAccounting::allocated(MemoryCategory::VERTICES, bytes);
+    else MemoryAccounting::released(MemoryCategory::VERTICES, bytes);
+}
+
+Vertex::Vertex(std::string id) : id(std::move(id)) {
+    accountId(this->id, true);
+}
+
+/**
+ * Destroys the Vertex. Its edges are owned by the Graph, which deletes them first
+ */
+Vertex::~Vertex() {
+    accountId(id, false);
+}
+
+/**
+ * Allocates a Vertex, accounting its memory (see MemoryAccounting)
+ */
+void *Vertex::operator new(size_t size) {
+    void *pointer = ::operator new(size);
+    MemoryAccounting::allocated(MemoryCategory::VERTICES, size);
+    return pointer;
+}
+
+void Vertex::operator delete(void *pointer, size_t size) {
+    MemoryAccounting::released(MemoryCategory::VERTICES, size);
+    ::operator delete(pointer);
+}
 
 /**
  * Adds a new outgoing edge to the Vertex, with a given destination and capacity
@@ -55,12 +90,24 @@ bool Vertex::removeEdge(const std::string& destID) {
     return removedEdge;
 }
 
+/**
+ * Removes a single outgoing edge from the Vertex, leaving any other edges to the same destination in place
+ * Time Complexity: O(outdegree(v) + indegree(dest))
+ * @param edge - Pointer to an outgoing Edge of the Vertex, deleted by this call
+ */
+void Vertex::removeEdge(Edge *edge) {
+    adj.erase(std::find(adj.begin(), adj.end(), edge));
+    auto &destIncoming = edge->getDest()->incoming;
+    destIncoming.erase(std::find(destIncoming.begin(), destIncoming.end(), edge));
+    delete edge;
+}
+
 std::string Vertex::getId() const {
     return this->id;
 }
 
 std::vector<Edge *> Vertex::getAdj() const {
-    return this->adj;
+    return {adj.begin(), adj.end()};
 }
 
 bool Vertex::isVisited() const {
@@ -71,6 +118,10 @@ bool Vertex::isProcessing() const {
     return this->processing;
 }
 
+bool Vertex::isActive() const {
+    return this->active;
+}
+
 unsigned int Vertex::getIndegree() const {
     return this->indegree;
 }
@@ -84,11 +135,13 @@ Edge *Vertex::getPath() const {
 }
 
 std::vector<Edge *> Vertex::getIncoming() const {
-    return this->incoming;
+    return {incoming.begin(), incoming.end()};
 }
 
 void Vertex::setId(std::string id) {
+    accountId(this->id, false);
     this->id = std::move(id);
+    accountId(this->id, true);
 }
 
 void Vertex::setVisited(bool visited) {
@@ -99,6 +152,10 @@ void Vertex::setProcesssing(bool processing) {
     this->processing = processing;
 }
 
+void Vertex::setActive(bool active) {
+    this->active = active;
+}
+
 void Vertex::setIndegree(unsigned int indegree) {
     this->indegree = indegree;
 }
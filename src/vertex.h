@@ -11,6 +11,7 @@
 #include <limits>
 #include <algorithm>
 #include "edge.h"
+#include "memoryAccounting.h"
 
 #define INF std::numeric_limits<double>::max()
 
@@ -21,6 +22,16 @@ class Vertex {
 public:
     explicit Vertex(std::string id);
 
+    Vertex(const Vertex &) = delete;
+
+    Vertex &operator=(const Vertex &) = delete;
+
+    ~Vertex();
+
+    static void *operator new(size_t size);
+
+    static void operator delete(void *pointer, size_t size);
+
     [[nodiscard]] std::string getId() const;
 
     [[nodiscard]] std::vector<Edge *> getAdj() const;
@@ -29,6 +40,8 @@ public:
 
     [[nodiscard]] bool isProcessing() const;
 
+    [[nodiscard]] bool isActive() const;
+
     [[nodiscard]] unsigned int getIndegree() const;
 
     [[nodiscard]] int getCost() const;
@@ -43,6 +56,8 @@ public:
 
     void setProcesssing(bool processing);
 
+    void setActive(bool active);
+
     void setIndegree(unsigned int indegree);
 
     void setCost(int dist);
@@ -53,17 +68,20 @@ public:
 
     bool removeEdge(const std::string& destID);
 
+    void removeEdge(Edge *edge);
+
 private:
     std::string id;                // identifier
-    std::vector<Edge *> adj;  // outgoing edges
+    CountedVector<Edge *, MemoryCategory::ADJACENCY> adj;  // outgoing edges
 
     // auxiliary fields
     bool visited = false; // used by DFS, BFS, Prim ...
     bool processing = false; // used by isDAG (in addition to the visited attribute)
+    bool active = true; // false while the station is closed
     unsigned int indegree; // used by topsort
     int cost;
     Edge *path = nullptr;
-    std::vector<Edge *> incoming; // incoming edges
+    CountedVector<Edge *, MemoryCategory::ADJACENCY> incoming; // incoming edges
 
 };
 
@@ -0,0 +1,165 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "widestPathTree.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <numeric>
+
+WidestPathTree::WidestPathTree() = default;
+
+/**
+ * Builds the maximum spanning forest of a FlowNetwork with Kruskal's algorithm, taking the rails by decreasing
+ * capacity, roots each of its trees and fills the ancestor tables. Rails without capacity are left out, as no train can
+ * use them. Must be called again after the capacities of the FlowNetwork change
+ * Time Complexity: O(|E| log |E| + |V| log |V|)
+ * @param flowNetwork - Network whose stations and rails are spanned
+ */
+void WidestPathTree::build(const FlowNetwork &flowNetwork) {
+    numStations = flowNetwork.getNumStations();
+    levels = std::max(1u, (unsigned int) std::bit_width(numStations));
+
+    std::vector<unsigned int> rails(flowNetwork.getNumRails());
+    std::iota(rails.begin(), rails.end(), 0);
+    std::stable_sort(rails.begin(), rails.end(), [&flowNetwork](unsigned int rail1, unsigned int rail2) {
+        return flowNetwork.getRailCapacity(rail1) > flowNetwork.getRailCapacity(rail2);
+    });
+
+    //Union-find over the stations, with path halving
+    std::vector<unsigned int> component(numStations);
+    std::iota(component.begin(), component.end(), 0);
+    auto find = [&component](unsigned int station) {
+        while (component[station] != station) station = component[station] = component[component[station]];
+        return station;
+    };
+    std::vector<std::vector<unsigned int>> treeArcs(numStations);
+    for (unsigned int rail: rails) {
+        if (flowNetwork.getRailCapacity(rail) == 0) break;
+        unsigned int first = find(flowNetwork.arcTail(2 * rail)), second = find(flowNetwork.arcHead(2 * rail));
+        if (first == second) continue;
+        component[first] = second;
+        treeArcs[flowNetwork.arcTail(2 * rail)].push_back(2 * rail);
+        treeArcs[flowNetwork.arcHead(2 * rail)].push_back(2 * rail + 1);
+    }
+
+    //Roots every tree at its first station, in breadth-first order
+    depth.assign(numStations, 0);
+    treeRoot.assign(numStations, FlowNetwork::NOT_FOUND);
+    parentRail.assign(numStations, FlowNetwork::NOT_FOUND);
+    ancestor.assign((size_t) levels * numStations, 0);
+    narrowest.assign((size_t) levels * numStations, std::numeric_limits<unsigned int>::max());
+    std::vector<unsigned int> queue;
+    for (unsigned int root = 0; root < numStations; root++) {
+        if (treeRoot[root] != FlowNetwork::NOT_FOUND) continue;
+        treeRoot[root] = root;
+        ancestor[root] = root;
+        queue.assign(1, root);
+        for (size_t i = 0; i < queue.size(); i++) {
+            unsigned int station = queue[i];
+            for (unsigned int arc: treeArcs[station]) {
+                unsigned int child = flowNetwork.arcHead(arc);
+                if (treeRoot[child] != FlowNetwork::NOT_FOUND) continue;
+                treeRoot[child] = root;
+                depth[child] = depth[station] + 1;
+                parentRail[child] = arc >> 1;
+                ancestor[child] = station;
+                narrowest[child] = flowNetwork.getRailCapacity(arc >> 1);
+                queue.push_back(child);
+            }
+        }
+    }
+
+    for (unsigned int level = 1; level < levels; level++) {
+        size_t current = (size_t) level * numStations, previous = current - numStations;
+        for (unsigned int station = 0; station < numStations; station++) {
+            unsigned int halfway = ancestor[previous + station];
+            ancestor[current + station] = ancestor[previous + halfway];
+            narrowest[current + station] = std::min(narrowest[previous + station], narrowest[previous + halfway]);
+        }
+    }
+}
+
+/**
+ * Lifts two stations of the same tree to their lowest common ancestor
+ * Time Complexity: O(log |V|)
+ * @param station1 - Index of the first station
+ * @param station2 - Index of the second station
+ * @param width - Set to the capacity of the narrowest rail between the stations, or to the maximum unsigned int if
+ * they are the same station
+ * @return Index of the lowest common ancestor
+ */
+unsigned int WidestPathTree::lowestCommonAncestor(unsigned int station1, unsigned int station2,
+                                                  unsigned int &width) const {
+    width = std::numeric_limits<unsigned int>::max();
+    if (depth[station1] < depth[station2]) std::swap(station1, station2);
+    for (unsigned int level = 0, difference = depth[station1] - depth[station2]; difference > 0;
+         level++, difference >>= 1) {
+        if (!(difference & 1)) continue;
+        width = std::min(width, narrowest[(size_t) level * numStations + station1]);
+        station1 = ancestor[(size_t) level * numStations + station1];
+    }
+    if (station1 == station2) return station1;
+
+    for (unsigned int level = levels; level-- > 0;) {
+        size_t offset = (size_t) level * numStations;
+        if (ancestor[offset + station1] == ancestor[offset + station2]) continue;
+        width = std::min({width, narrowest[offset + station1], narrowest[offset + station2]});
+        station1 = ancestor[offset + station1];
+        station2 = ancestor[offset + station2];
+    }
+    width = std::min({width, narrowest[station1], narrowest[station2]});
+    return ancestor[station1];
+}
+
+/**
+ * Checks if two stations are joined by rails with capacity
+ * Time Complexity: O(1)
+ * @param station1 - Index of the first station
+ * @param station2 - Index of the second station
+ * @return True if both stations are in the same tree, false otherwise. Stations added to the FlowNetwork after the tree
+ * was built have no rails, so they are only connected to themselves
+ */
+bool WidestPathTree::connected(unsigned int station1, unsigned int station2) const {
+    if (station1 >= numStations || station2 >= numStations) return station1 == station2;
+    return treeRoot[station1] == treeRoot[station2];
+}
+
+/**
+ * Finds the capacity of the widest path between two stations, i.e. the number of trains that can use the best single
+ * route between them
+ * Time Complexity: O(log |V|)
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @return Capacity of the widest path, or 0 if the stations are the same or aren't connected
+ */
+unsigned int WidestPathTree::widestCapacity(unsigned int source, unsigned int target) const {
+    if (source == target || !connected(source, target)) return 0;
+    unsigned int width;
+    lowestCommonAncestor(source, target, width);
+    return width;
+}
+
+/**
+ * Finds a widest path between two stations, along the tree
+ * Time Complexity: O(log |V| + n), n being the number of rails of the path
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @return Rails of the FlowNetwork on the path, in order from source to target, or no rails if the stations are the
+ * same or aren't connected
+ */
+std::vector<unsigned int> WidestPathTree::widestPath(unsigned int source, unsigned int target) const {
+    if (source == target || !connected(source, target)) return {};
+    unsigned int width;
+    unsigned int meeting = lowestCommonAncestor(source, target, width);
+    std::vector<unsigned int> rails;
+    for (unsigned int station = source; station != meeting; station = ancestor[station])
+        rails.push_back(parentRail[station]);
+    size_t fromSource = rails.size();
+    for (unsigned int station = target; station != meeting; station = ancestor[station])
+        rails.push_back(parentRail[station]);
+    std::reverse(rails.begin() + (long) fromSource, rails.end());
+    return rails;
+}
@@ -0,0 +1,47 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#ifndef RAILWAYMANAGEMENT_WIDESTPATHTREE_H
+#define RAILWAYMANAGEMENT_WIDESTPATHTREE_H
+
+#include <vector>
+
+#include "flowNetwork.h"
+#include "memoryAccounting.h"
+
+/**
+ * Maximum spanning forest of a railway network, rooted in every connected component, with binary lifting tables over
+ * it. The tree path between two stations is a widest path between them, so the capacity of the best single route
+ * between any pair is the narrowest rail on their tree path, found in O(log V) by lifting both stations to their lowest
+ * common ancestor. A fast companion to FlowNetwork::widestPath, which also supports failures but searches the network
+ */
+class WidestPathTree {
+  private:
+    unsigned int numStations = 0;
+    unsigned int levels = 0; // ancestor levels, so that 2^levels exceeds the depth of any tree
+    CountedVector<unsigned int, MemoryCategory::WIDEST_PATHS> depth;
+    CountedVector<unsigned int, MemoryCategory::WIDEST_PATHS> treeRoot;
+    // rail of the FlowNetwork to the parent station, NOT_FOUND for roots
+    CountedVector<unsigned int, MemoryCategory::WIDEST_PATHS> parentRail;
+    // entry l·|V| + v: 2^l-th ancestor of station v (roots are their own ancestors)
+    CountedVector<unsigned int, MemoryCategory::WIDEST_PATHS> ancestor;
+    // entry l·|V| + v: capacity of the narrowest rail between station v and its 2^l-th ancestor
+    CountedVector<unsigned int, MemoryCategory::WIDEST_PATHS> narrowest;
+
+    unsigned int lowestCommonAncestor(unsigned int station1, unsigned int station2, unsigned int &width) const;
+
+  public:
+    WidestPathTree();
+
+    void build(const FlowNetwork &flowNetwork);
+
+    [[nodiscard]] bool connected(unsigned int station1, unsigned int station2) const;
+
+    [[nodiscard]] unsigned int widestCapacity(unsigned int source, unsigned int target) const;
+
+    [[nodiscard]] std::vector<unsigned int> widestPath(unsigned int source, unsigned int target) const;
+};
+
+
+#endif //RAILWAYMANAGEMENT_WIDESTPATHTREE_H
@@ -0,0 +1,428 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "railwayManagement.h"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * Counts the disagreements found and reports each of them with the query that caused it
+ */
+struct Checker {
+    std::string query;
+    unsigned int failures = 0;
+
+    void expect(bool condition, const std::string &what) {
+        if (condition) return;
+        if (failures < 50) std::cerr << "FAILED " << query << ": " << what << std::endl;
+        failures++;
+    }
+
+    void expectEqual(long long expected, long long actual, const std::string &what) {
+        expect(expected == actual, what + " is " + std::to_string(actual) + ", expected " + std::to_string(expected));
+    }
+};
+
+/**
+ * Checks that the flow left on the edges of a Graph is a valid flow of the given value: within the capacities, only on
+ * active edges and open stations, and conserved at every station except the sources and the target
+ * @param graph - Graph whose edges hold the flow
+ * @param sources - Ids of the source stations
+ * @param target - Id of the target station
+ * @param value - Value the flow should have
+ * @param checker - Checker where the violations are reported
+ * @param engine - Name of the engine that computed the flow
+ */
+static void checkGraphFlow(const Graph &graph, const std::list<std::string> &sources, const std::string &target,
+                           unsigned int value, Checker &checker, const std::string &engine) {
+    std::unordered_set<std::string> isSource(sources.begin(), sources.end());
+    long long sourcesOutflow = 0;
+    for (Vertex const *v: graph.getVertexSet()) {
+        long long outflow = 0;
+        for (Edge const *e: v->getAdj()) {
+            outflow += e->getFlow();
+            checker.expect(e->getFlow() <= e->getCapacity(),
+                           engine + " exceeds the capacity of a rail at " + v->getId());
+            checker.expect(e->getFlow() == 0 || (e->isSelected() && v->isActive() && e->getDest()->isActive()),
+                           engine + " sends flow through a failed rail or a closed station at " + v->getId());
+        }
+        for (Edge const *e: v->getIncoming()) outflow -= e->getFlow();
+        if (isSource.count(v->getId())) sourcesOutflow += outflow;
+        else if (v->getId() == target) checker.expect(-outflow == value, engine + " delivers a different flow");
+        else checker.expect(outflow == 0, engine + " doesn't conserve the flow at " + v->getId());
+    }
+    checker.expect(sourcesOutflow == value, engine + " sends a different flow out of the sources");
+}
+
+/**
+ * Checks that a flow of a FlowNetwork is valid: antisymmetric, within the capacities, only on rails in service and
+ * open stations, and conserved at every station except the sources and the target
+ * @param network - FlowNetwork the flow belongs to
+ * @param flow - Flow over the network's arcs
+ * @param sources - Indexes of the source stations
+ * @param target - Index of the target station
+ * @param mask - Rails out of service and closed stations
+ * @param value - Value the flow should have
+ * @param checker - Checker where the violations are reported
+ */
+static void checkArcFlow(const FlowNetwork &network, const std::vector<int> &flow,
+                         const std::vector<unsigned int> &sources, unsigned int target, const FailureMask &mask,
+                         unsigned int value, Checker &checker) {
+    std::vector<long long> outflow(network.getNumStations(), 0);
+    for (unsigned int rail = 0; rail < network.getNumRails(); rail++) {
+        int railFlow = flow[2 * rail];
+        checker.expect(flow[2 * rail + 1] == -railFlow, "flow_network's flow isn't antisymmetric");
+        checker.expect((unsigned int) std::abs(railFlow) <= network.getRailCapacity(rail),
+                       "flow_network exceeds the capacity of a rail");
+        unsigned int tail = network.arcTail(2 * rail), head = network.arcHead(2 * rail);
+        checker.expect(railFlow == 0 || (mask.isRailActive(rail) && mask.isStationActive(tail) &&
+                                         mask.isStationActive(head)),
+                       "flow_network sends flow through a failed rail or a closed station");
+        outflow[tail] += railFlow;
+        outflow[head] -= railFlow;
+    }
+    long long sourcesOutflow = 0;
+    for (unsigned int station = 0; station < network.getNumStations(); station++) {
+        if (std::find(sources.begin(), sources.end(), station) != sources.end()) sourcesOutflow += outflow[station];
+        else if (station == target)
+            checker.expect(-outflow[station] == value, "flow_network delivers a different flow");
+        else checker.expect(outflow[station] == 0, "flow_network doesn't conserve the flow at " +
+                                                   network.getStationName(station));
+    }
+    checker.expect(sourcesOutflow == value, "flow_network sends a different flow out of the sources");
+}
+
+/**
+ * Computes the cost of the flow left on the edges of a Graph
+ */
+static unsigned int graphFlowCost(const Graph &graph) {
+    unsigned int cost = 0;
+    for (Vertex const *v: graph.getVertexSet())
+        for (Edge const *e: v->getAdj()) cost += e->getCost() * e->getFlow();
+    return cost;
+}
+
+/**
+ * Checks that a widest path of a FlowNetwork is a route from the source to the target, only on rails in service, whose
+ * narrowest rail has the reported capacity. A single route can't take more trains than the max flow, and exists if and
+ * only if some flow does
+ * @param network - FlowNetwork the path belongs to
+ * @param path - Capacity and rails of the path, as returned by FlowNetwork::widestPath
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @param mask - Rails and stations out of service
+ * @param maxFlow - Max flow between the source and the target, with the same mask
+ * @param checker - Checker where the violations are reported
+ * @param engine - Name of the engine that found the path, for the reports
+ */
+static void checkWidestPath(const FlowNetwork &network, const std::pair<unsigned int, std::vector<unsigned int>> &path,
+                            unsigned int source, unsigned int target, const FailureMask &mask, unsigned int maxFlow,
+                            Checker &checker, const std::string &engine) {
+    checker.expect(path.first <= maxFlow, engine + "'s widest path is wider than the max flow");
+    checker.expect((path.first > 0) == (maxFlow > 0), engine + "'s widest path exists only if some flow does");
+    if (path.second.empty()) {
+        checker.expectEqual(0, path.first, engine + "'s widest path capacity without rails");
+        return;
+    }
+    unsigned int station = source, narrowest = UINT_MAX;
+    for (unsigned int rail: path.second) {
+        unsigned int tail = network.arcTail(2 * rail), head = network.arcHead(2 * rail);
+        checker.expect(tail == station || head == station, engine + "'s widest path is not a route");
+        checker.expect(mask.isRailActive(rail), engine + "'s widest path uses a failed rail");
+        station = tail == station ? head : tail;
+        checker.expect(mask.isStationActive(station), engine + "'s widest path goes through a closed station");
+        narrowest = std::min(narrowest, network.getRailCapacity(rail));
+    }
+    checker.expectEqual(target, station, engine + "'s widest path end");
+    checker.expectEqual(narrowest, path.first, engine + "'s widest path capacity");
+}
+
+/**
+ * Checks that a route of a FlowNetwork goes from the source to the target over rails with capacity and has the
+ * reported length
+ * @param network - FlowNetwork the route belongs to
+ * @param path - Length and rails of the route, as returned by FlowNetwork::shortestPath
+ * @param source - Index of the source station
+ * @param target - Index of the target station
+ * @param metric - Whether the route is measured by cost or by number of rails
+ * @param checker - Checker where the violations are reported
+ * @param engine - Name of the engine that found the route, for the reports
+ */
+static void checkRoute(const FlowNetwork &network, const std::pair<unsigned int, std::vector<unsigned int>> &path,
+                       unsigned int source, unsigned int target, RouteMetric metric, Checker &checker,
+                       const std::string &engine) {
+    if (path.first == FlowNetwork::NOT_FOUND) {
+        checker.expect(path.second.empty(), engine + "'s missing route has rails");
+        return;
+    }
+    unsigned int station = source, length = 0;
+    for (unsigned int rail: path.second) {
+        unsigned int tail = network.arcTail(2 * rail), head = network.arcHead(2 * rail);
+        checker.expect(tail == station || head == station, engine + "'s route is not a route");
+        checker.expect(network.getRailCapacity(rail) > 0, engine + "'s route uses a rail without capacity");
+        station = tail == station ? head : tail;
+        length += network.railLength(rail, metric);
+    }
+    checker.expectEqual(target, station, engine + "'s route end");
+    checker.expectEqual(length, path.first, engine + "'s route length");
+}
+
+/**
+ * Runs random queries on a network with every engine and checks that they agree
+ * @param network - Loaded network
+ * @param random - Random number generator
+ * @param numQueries - Number of queries
+ * @param minCost - True to also compare the min cost max flow engines
+ * @param checker - Checker where the disagreements are reported
+ * @param name - Name of the network, used in the reports
+ */
+static void testNetwork(RailwayNetwork &network, std::mt19937 &random, unsigned int numQueries, bool minCost,
+                        Checker &checker, const std::string &name) {
+    Graph &graph = network.getGraph();
+    Graph &residualGraph = network.getResidualGraph();
+    ContractedGraph &contractedGraph = network.getContractedGraph();
+    const BridgeDecomposition &bridgeDecomposition = network.getBridgeDecomposition();
+    const FlowNetwork &flowNetwork = network.getFlowNetwork();
+    const WidestPathTree &widestPathTree = network.getWidestPathTree();
+    std::vector<Vertex *> stations = graph.getVertexSet();
+    std::vector<Edge *> rails;
+    for (Vertex const *v: stations)
+        for (Edge *e: v->getAdj()) rails.push_back(e);
+    if (stations.size() < 2 || rails.empty()) return;
+    auto pick = [&random](size_t size) { return (size_t) std::uniform_int_distribution<size_t>(0, size - 1)(random); };
+
+    for (unsigned int q = 0; q < numQueries; q++) {
+        std::string target = stations[pick(stations.size())]->getId();
+        std::list<std::string> sources;
+        size_t numSources = 1 + pick(std::min<size_t>(3, stations.size() - 1));
+        while (sources.size() < numSources) {
+            std::string source = stations[pick(stations.size())]->getId();
+            if (source != target && std::find(sources.begin(), sources.end(), source) == sources.end())
+                sources.push_back(source);
+        }
+        std::vector<Edge *> failed;
+        for (unsigned int i = (unsigned int) pick(4); i > 0; i--) failed.push_back(rails[pick(rails.size())]);
+        std::vector<std::string> closed;
+        for (unsigned int i = (unsigned int) pick(3); i > 0; i--) {
+            std::string station = stations[pick(stations.size())]->getId();
+            if (station != target && std::find(sources.begin(), sources.end(), station) == sources.end())
+                closed.push_back(station);
+        }
+
+        std::ostringstream query;
+        query << name << ", sources {";
+        for (const std::string &source: sources) query << (source == sources.front() ? "" : ", ") << source;
+        query << "} -> " << target << ", " << failed.size() << " failed rail(s), " << closed.size()
+              << " closed station(s)";
+        checker.query = query.str();
+
+        std::vector<unsigned int> sourceIndexes;
+        for (const std::string &source: sources) sourceIndexes.push_back(flowNetwork.findStation(source));
+        unsigned int targetIndex = flowNetwork.findStation(target);
+        bool singleSource = sources.size() == 1;
+
+        //Max flow of the whole network
+        unsigned int expected = graph.edmondsKarp(sources, target, residualGraph);
+        checkGraphFlow(graph, sources, target, expected, checker, "graph");
+        std::vector<int> flow;
+        checker.expectEqual(expected, flowNetwork.maxFlow(sourceIndexes, targetIndex, flow), "flow_network's max flow");
+        checkArcFlow(flowNetwork, flow, sourceIndexes, targetIndex, {}, expected, checker);
+        checker.expectEqual(expected, contractedGraph.edmondsKarp(sources, target), "contracted_graph's max flow");
+        contractedGraph.expandFlow();
+        checkGraphFlow(graph, sources, target, expected, checker, "contracted_graph");
+        if (singleSource)
+            checker.expectEqual(expected, bridgeDecomposition.maxFlow(sources.front(), target),
+                                "bridge_decomposition's max flow");
+
+        //Widest path from the first source, searched in the network and along the maximum spanning tree
+        unsigned int firstFlow = flowNetwork.maxFlow({sourceIndexes.front()}, targetIndex);
+        std::pair<unsigned int, std::vector<unsigned int>> widest = flowNetwork.widestPath(sourceIndexes.front(),
+                                                                                          targetIndex);
+        checkWidestPath(flowNetwork, widest, sourceIndexes.front(), targetIndex, {}, firstFlow, checker,
+                        "flow_network");
+        checker.expectEqual(widest.first, widestPathTree.widestCapacity(sourceIndexes.front(), targetIndex),
+                            "widest_path_tree's capacity");
+        checkWidestPath(flowNetwork, {widestPathTree.widestCapacity(sourceIndexes.front(), targetIndex),
+                                      widestPathTree.widestPath(sourceIndexes.front(), targetIndex)},
+                        sourceIndexes.front(), targetIndex, {}, firstFlow, checker, "widest_path_tree");
+
+        //Cheapest and shortest routes from the first source, searched in the network and in the hierarchies
+        for (RouteMetric metric: {RouteMetric::COST, RouteMetric::HOPS}) {
+            std::string metricName = metric == RouteMetric::COST ? " (cost)" : " (hops)";
+            std::pair<unsigned int, std::vector<unsigned int>> route = flowNetwork.shortestPath(sourceIndexes.front(),
+                                                                                               targetIndex, metric);
+            checkRoute(flowNetwork, route, sourceIndexes.front(), targetIndex, metric, checker,
+                       "flow_network" + metricName);
+            checker.expect((route.first != FlowNetwork::NOT_FOUND) == (firstFlow > 0),
+                           "flow_network's route exists only if some flow does" + metricName);
+            std::pair<unsigned int, std::vector<unsigned int>> hierarchyRoute =
+                    network.getContractionHierarchy(metric).shortestPath(sourceIndexes.front(), targetIndex);
+            checker.expectEqual(route.first, hierarchyRoute.first, "contraction_hierarchy's route length" + metricName);
+            checkRoute(flowNetwork, hierarchyRoute, sourceIndexes.front(), targetIndex, metric, checker,
+                       "contraction_hierarchy" + metricName);
+        }
+
+        //Max flow without the failed rails
+        std::pair<unsigned int, unsigned int> failure = graph.maxFlowDeactivatedEdges(failed, sources, target,
+                                                                                      residualGraph);
+        checker.expectEqual(expected, failure.first, "graph's max flow before the failures");
+        Graph::deactivateEdges(failed);
+        checkGraphFlow(graph, sources, target, failure.second, checker, "graph with failed rails");
+        Graph::activateEdges(failed);
+        FailureMask railMask = flowNetwork.makeMask(failed);
+        checker.expectEqual(failure.second, flowNetwork.maxFlow(sourceIndexes, targetIndex, flow, railMask),
+                            "flow_network's max flow with failed rails");
+        checkArcFlow(flowNetwork, flow, sourceIndexes, targetIndex, railMask, failure.second, checker);
+        std::pair<unsigned int, unsigned int> contractedFailure =
+                contractedGraph.maxFlowDeactivatedEdges(failed, sources, target);
+        checker.expectEqual(failure.first, contractedFailure.first, "contracted_graph's max flow before the failures");
+        checker.expectEqual(failure.second, contractedFailure.second, "contracted_graph's max flow with failed rails");
+        if (singleSource) {
+            std::pair<unsigned int, unsigned int> bridgeFailure =
+                    bridgeDecomposition.maxFlowDeactivatedEdges(failed, sources.front(), target);
+            checker.expectEqual(failure.first, bridgeFailure.first,
+                                "bridge_decomposition's max flow before the failures");
+            checker.expectEqual(failure.second, bridgeFailure.second,
+                                "bridge_decomposition's max flow with failed rails");
+        }
+
+        //Max flow without the failed rails and the closed stations
+        Graph::deactivateEdges(failed);
+        graph.deactivateVertices(closed, residualGraph);
+        unsigned int masked = graph.edmondsKarp(sources, target, residualGraph);
+        checkGraphFlow(graph, sources, target, masked, checker, "graph with failed rails and closed stations");
+        Graph::activateEdges(failed);
+        graph.activateVertices(closed, residualGraph);
+        FailureMask mask = flowNetwork.makeMask(failed, closed);
+        checker.expectEqual(masked, flowNetwork.maxFlow(sourceIndexes, targetIndex, flow, mask),
+                            "flow_network's max flow with failed rails and closed stations");
+        checkArcFlow(flowNetwork, flow, sourceIndexes, targetIndex, mask, masked, checker);
+        checkWidestPath(flowNetwork, flowNetwork.widestPath(sourceIndexes.front(), targetIndex, mask),
+                        sourceIndexes.front(), targetIndex, mask,
+                        flowNetwork.maxFlow({sourceIndexes.front()}, targetIndex, mask), checker,
+                        "flow_network with failed rails and closed stations");
+        std::pair<unsigned int, unsigned int> closure = graph.maxFlowDeactivatedVertices(closed, sources, target,
+                                                                                         residualGraph);
+        checker.expectEqual(flowNetwork.maxFlow(sourceIndexes, targetIndex, flowNetwork.makeMask({}, closed)),
+                            closure.second, "graph's max flow with closed stations");
+
+        if (!minCost) continue;
+        //Min cost max flow, from the first source only, with and without the failed rails
+        const std::string &source = sources.front();
+        std::pair<unsigned int, unsigned int> cheapest = graph.minCostMaxFlow(source, target, residualGraph);
+        checkGraphFlow(graph, {source}, target, cheapest.first, checker, "graph's min cost flow");
+        checker.expectEqual(graphFlowCost(graph), cheapest.second, "graph's reported min cost");
+        std::pair<unsigned int, long long> arcCheapest = flowNetwork.minCostMaxFlow(sourceIndexes.front(),
+                                                                                       targetIndex);
+        checker.expectEqual(cheapest.first, arcCheapest.first, "flow_network's min cost max flow");
+        checker.expectEqual(cheapest.second, arcCheapest.second, "flow_network's min cost");
+        std::pair<unsigned int, unsigned int> contractedCheapest = contractedGraph.minCostMaxFlow(source, target);
+        checker.expectEqual(cheapest.first, contractedCheapest.first, "contracted_graph's min cost max flow");
+        checker.expectEqual(cheapest.second, contractedCheapest.second, "contracted_graph's min cost");
+
+        Graph::deactivateEdges(failed);
+        cheapest = graph.minCostMaxFlow(source, target, residualGraph);
+        checkGraphFlow(graph, {source}, target, cheapest.first, checker, "graph's min cost flow with failed rails");
+        checker.expectEqual(graphFlowCost(graph), cheapest.second, "graph's reported min cost with failed rails");
+        Graph::activateEdges(failed);
+        arcCheapest = flowNetwork.minCostMaxFlow(sourceIndexes.front(), targetIndex, railMask);
+        checker.expectEqual(cheapest.first, arcCheapest.first, "flow_network's min cost max flow with failed rails");
+        checker.expectEqual(cheapest.second, arcCheapest.second, "flow_network's min cost with failed rails");
+    }
+}
+
+/**
+ * Parses a command line value
+ * @return True if the whole value is a number of the type, false otherwise
+ */
+template<typename T>
+static bool parseNumber(const std::string &value, T &number) {
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    return !value.empty() && error == std::errc() && end == value.data() + value.size();
+}
+
+/**
+ * Usage: RailwayFlowDifferential [--seed S] [--networks N] [--queries Q] [--max-stations M] [--max-min-cost-stations C]
+ * Differential test of the flow engines: generates N random networks of up to M stations and runs Q random queries on
+ * each, with one to three sources, failed rails and closed stations. Every query is answered by Graph, ContractedGraph,
+ * BridgeDecomposition (single source) and FlowNetwork, which must agree on the max flow and on the min cost max flow
+ * (on networks of up to C stations, as Graph cancels cycles), and every flow they leave behind must be valid. The
+ * widest paths of FlowNetwork and WidestPathTree must agree too, and be routes no wider than the max flow, as must the
+ * cheapest and shortest routes of FlowNetwork and ContractionHierarchy. The exit status is 1 if any check failed
+ */
+int main(int argc, char *argv[]) {
+    unsigned int seed = 1;
+    unsigned int numNetworks = 30;
+    unsigned int numQueries = 20;
+    unsigned int maxStations = 400;
+    unsigned int maxMinCostStations = 150;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        bool valid = true;
+        if (option == "--seed") valid = parseNumber(value, seed);
+        else if (option == "--networks") valid = parseNumber(value, numNetworks);
+        else if (option == "--queries") valid = parseNumber(value, numQueries);
+        else if (option == "--max-stations") valid = parseNumber(value, maxStations);
+        else if (option == "--max-min-cost-stations") valid = parseNumber(value, maxMinCostStations);
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value " << value << " of " << option << std::endl;
+            return 2;
+        }
+    }
+    if (argc % 2 == 0 || maxStations < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--seed S] [--networks N] [--queries Q] [--max-stations M]"
+                  << " [--max-min-cost-stations C]" << std::endl;
+        return 2;
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("railway-differential-" + std::to_string(seed));
+    std::filesystem::create_directories(directory);
+    std::mt19937 random(seed);
+    Checker checker;
+    unsigned int queries = 0;
+    for (unsigned int n = 0; n < numNetworks; n++) {
+        GeneratorOptions options;
+        options.seed = seed * 1000 + n;
+        options.numStations = std::uniform_int_distribution<unsigned int>(2, maxStations)(random);
+        options.meanLineLength = std::uniform_int_distribution<unsigned int>(2, 12)(random);
+        options.loopFraction = std::uniform_real_distribution<double>(0, 0.8)(random);
+        options.spurFraction = std::uniform_real_distribution<double>(0, 0.5)(random);
+        options.alfaPendularFraction = std::uniform_real_distribution<double>(0, 0.5)(random);
+        std::string stationsFilePath = (directory / "stations.csv").string();
+        std::string networkFilePath = (directory / "network.csv").string();
+        if (!NetworkGenerator(options).write(stationsFilePath, networkFilePath)) {
+            std::cerr << "Could not write a network to " << directory.string() << std::endl;
+            return 2;
+        }
+
+        RailwayNetwork network(stationsFilePath, networkFilePath);
+        network.setSnapshotFilePath("");
+        std::ostringstream report;
+        network.load(report);
+        std::string name = "network " + std::to_string(n) + " (" + std::to_string(options.numStations) +
+                           " stations, seed " + std::to_string(options.seed) + ")";
+        testNetwork(network, random, numQueries, options.numStations <= maxMinCostStations, checker, name);
+        queries += numQueries;
+    }
+    std::filesystem::remove_all(directory);
+
+    std::cout << checker.failures << " failed check(s) in " << queries << " queries on " << numNetworks
+              << " networks" << std::endl;
+    return checker.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+//
+// Created by tomas on 18-10-2026.
+//
+
+#include "networkGenerator.h"
+
+#include <charconv>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+/**
+ * Parses a command line value
+ * @return True if the whole value is a number of the type, false otherwise
+ */
+template<typename T>
+static bool parseNumber(const std::string &value, T &number) {
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    return !value.empty() && error == std::errc() && end == value.data() + value.size();
+}
+
+/**
+ * Usage: RailwayGenerator --stations N [--output DIRECTORY] [--seed S] [--line-length L] [--spurs F] [--loops F]
+ *                         [--hubs F] [--alfa-pendular F]
+ * Writes stations.csv and network.csv for a synthetic network of N stations to DIRECTORY (the current one by default),
+ * in the format of the shipped dataset
+ */
+int main(int argc, char *argv[]) {
+    GeneratorOptions options;
+    std::filesystem::path output = ".";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        bool valid = true;
+        if (option == "--stations") valid = parseNumber(value, options.numStations);
+        else if (option == "--output") output = value;
+        else if (option == "--seed") valid = parseNumber(value, options.seed);
+        else if (option == "--line-length") valid = parseNumber(value, options.meanLineLength);
+        else if (option == "--spurs") valid = parseNumber(value, options.spurFraction);
+        else if (option == "--loops") valid = parseNumber(value, options.loopFraction);
+        else if (option == "--hubs") valid = parseNumber(value, options.hubAffinity);
+        else if (option == "--alfa-pendular") valid = parseNumber(value, options.alfaPendularFraction);
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value " << value << " of " << option << std::endl;
+            return 2;
+        }
+    }
+    if (argc % 2 == 0 || options.numStations == 0) {
+        std::cerr << "Usage: " << argv[0] << " --stations N [--output DIRECTORY] [--seed S] [--line-length L]"
+                  << " [--spurs F] [--loops F] [--hubs F] [--alfa-pendular F]" << std::endl;
+        return 2;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(output, error);
+    if (!NetworkGenerator(options).write((output / "stations.csv").string(), (output / "network.csv").string())) {
+        std::cerr << "Could not write the network to " << output.string() << std::endl;
+        return 1;
+    }
+    return 0;
+}